@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file agc.c
+/// @brief Block automatic gain control with a soft limiter, as a DSP stage
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "agc.h"
+#include "dsp.h"
+#include "simd.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The soft limiter is the [3/2] Pade approximant of tanh, which reaches exactly 1 with zero slope at 3
+#define AGC_KNEE 3.0F
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Four floats with a single value
+static inline simd_v4f agc_splat(const float x) {
+    return (simd_v4f) {x, x, x, x};
+}
+
+/// \brief The absolute value of each lane
+static inline simd_v4f agc_abs(const simd_v4f v) {
+    return (simd_v4f) ((simd_v4i) v & 0x7fffffff);
+}
+
+/// \brief The larger of each pair of lanes
+static inline simd_v4f agc_max(const simd_v4f a, const simd_v4f b) {
+    const simd_v4i greater = a > b;
+    return (simd_v4f) ((greater & (simd_v4i) a) | (~greater & (simd_v4i) b));
+}
+
+/// \brief The smaller of each pair of lanes
+static inline simd_v4f agc_min(const simd_v4f a, const simd_v4f b) {
+    const simd_v4i less = a < b;
+    return (simd_v4f) ((less & (simd_v4i) a) | (~less & (simd_v4i) b));
+}
+
+/// \brief The soft limiter on four floats: nearly linear at low levels, curving smoothly to AGC_LIMIT
+static inline simd_v4f agc_limit(const simd_v4f y) {
+    simd_v4f u = y * (1.0F / AGC_LIMIT);
+    u = agc_min(agc_max(u, agc_splat(-AGC_KNEE)), agc_splat(AGC_KNEE));
+    const simd_v4f u2 = u * u;
+    return AGC_LIMIT * u * (27.0F + u2) / (27.0F + 9.0F * u2);
+}
+
+/// \brief The soft limiter on one float, for the end of a block that doesn't fill a vector
+static inline float agc_limit_one(const float y) {
+    float u = y * (1.0F / AGC_LIMIT);
+    u = fminf(fmaxf(u, -AGC_KNEE), AGC_KNEE);
+    const float u2 = u * u;
+    return AGC_LIMIT * u * (27.0F + u2) / (27.0F + 9.0F * u2);
+}
+
+/// \brief Run the AGC over a block.
+/// \param agc The AGC
+/// \param in The input samples
+/// \param out Receives the output samples, which may be the same as in
+/// \param len The number of floats in each
+/// \param floats_per_sample 2 for pairs, 1 for a mono graph
+static inline void agc_run(struct agc *agc, const float *in, float *out, const size_t len,
+                           const size_t floats_per_sample) {
+    const size_t samples = len / floats_per_sample;
+    if (samples == 0) {
+        memmove(out, in, len * sizeof(*out));
+        return;
+    }
+
+    // Packets are nearly always the same size, so the exponentials are only worked out once.
+    if (samples != agc->coef_len) {
+        const float block_s = (float) samples / (float) agc->sample_rate;
+        agc->attack_coef = 1.0F - expf(-block_s / agc->attack_s);
+        agc->decay_coef = 1.0F - expf(-block_s / agc->decay_s);
+        agc->coef_len = samples;
+    }
+
+    const float peak = agc_block_peak(in, len);
+    agc->envelope += (peak > agc->envelope ? agc->attack_coef : agc->decay_coef) * (peak - agc->envelope);
+    const float gain = agc->envelope * agc->max_gain > agc->target ? agc->target / agc->envelope : agc->max_gain;
+
+    // Ramp from the last block's gain to this one's, one step per sample.  Both floats of a sample get the same gain,
+    // so a vector holds two samples' worth, or four in a mono graph.
+    const float step = (gain - agc->gain) / (float) samples;
+    const float start = agc->gain;
+    simd_v4f ramp;
+    for (size_t lane = 0; lane < SIMD_LANES; ++lane)
+        ramp[lane] = start + step * (float) (lane / floats_per_sample + 1);
+    const simd_v4f ramp_step = agc_splat(step * (float) (SIMD_LANES / floats_per_sample));
+    const simd_v4f volume = agc_splat(agc->volume);
+
+    size_t i = 0;
+    for (; i + SIMD_LANES <= len; i += SIMD_LANES) {
+        simd_store(out + i, agc_limit(simd_load(in + i) * ramp) * volume);
+        ramp += ramp_step;
+    }
+    for (; i < len; ++i)
+        out[i] = agc_limit_one(in[i] * (start + step * (float) (i / floats_per_sample + 1))) * agc->volume;
+
+    agc->gain = gain;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void agc_init(struct agc *agc, const uint32_t sample_rate) {
+    memset(agc, 0, sizeof(*agc));
+    agc->sample_rate = sample_rate;
+    agc->target = AGC_DEFAULT_TARGET;
+    agc->attack_s = AGC_DEFAULT_ATTACK_S;
+    agc->decay_s = AGC_DEFAULT_DECAY_S;
+    agc->max_gain = AGC_DEFAULT_MAX_GAIN;
+    agc->volume = 1.0F;
+    agc->envelope = AGC_DEFAULT_TARGET;
+    agc->gain = 1.0F;
+}
+
+void agc_process(void *arg, const float *in, float *out, const size_t len) {
+    agc_run(arg, in, out, len, DSP_FLOATS_PER_SAMPLE);
+}
+
+void agc_process_mono(void *arg, const float *in, float *out, const size_t len) {
+    agc_run(arg, in, out, len, 1);
+}
+
+float agc_gain_db(const struct agc *agc) {
+    return 20.0F * log10f(agc->gain);
+}
+
+float agc_block_peak(const float *in, const size_t len) {
+    simd_v4f peak4 = agc_splat(0.0F);
+    size_t i = 0;
+    for (; i + SIMD_LANES <= len; i += SIMD_LANES)
+        peak4 = agc_max(peak4, agc_abs(simd_load(in + i)));
+
+    float peak = fmaxf(fmaxf(peak4[0], peak4[1]), fmaxf(peak4[2], peak4[3]));
+    for (; i < len; ++i)
+        peak = fmaxf(peak, fabsf(in[i]));
+    return peak;
+}
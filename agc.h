@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file agc.h
+/// @brief Block automatic gain control with a soft limiter, as a DSP stage
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_AGC_H
+#define WAVEFORM_EXAMPLE_AGC_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The meter the AGC's gain is published as, in DB
+#define AGC_METER_GAIN "junk-agc-gain"
+
+/// \brief The peak level the AGC aims for, about -12dBFS so that the limiter only has to catch what the AGC hasn't
+/// caught up with yet
+#define AGC_DEFAULT_TARGET 0.25F
+
+/// \brief How quickly the gain comes down when the signal gets louder, in seconds
+#define AGC_DEFAULT_ATTACK_S 0.005F
+
+/// \brief How quickly the gain goes back up when the signal gets quieter, in seconds
+#define AGC_DEFAULT_DECAY_S 0.5F
+
+/// \brief The most gain the AGC will apply, 40dB, so that it doesn't turn the noise between signals into a roar
+#define AGC_DEFAULT_MAX_GAIN 100.0F
+
+/// \brief The level the soft limiter never lets the output exceed
+#define AGC_LIMIT 0.95F
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The AGC's settings and state.  Only ever touched by one data callback, so nothing here is atomic.
+///
+/// The gain is worked out once a block from the block's peak, which the envelope follows quickly on the way up and
+/// slowly on the way down.  Across the block the gain then ramps from where the last block left it to the new value, so
+/// that it never steps, and the output goes through a soft limiter.  The cost is the same for every packet: one pass to
+/// find the peak and one to apply the gain, both four floats at a time.
+struct agc {
+    uint32_t sample_rate;
+    float target;
+    float attack_s;
+    float decay_s;
+    float max_gain;
+    float volume;               ///< Applied after the AGC, like an AF gain control; 0 mutes
+
+    float envelope;             ///< The peak level being tracked
+    float gain;                 ///< The gain at the end of the last block
+
+    // The envelope coefficients for the last block length in samples, so that they are only worked out again if it
+    // changes
+    size_t coef_len;
+    float attack_coef;
+    float decay_coef;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize an AGC with the default settings at unity gain.
+/// \param agc The AGC to initialize
+/// \param sample_rate The sample rate in Hz
+void agc_init(struct agc *agc, uint32_t sample_rate);
+
+/// \brief The AGC as a DSP stage.  See dsp.h.
+/// \param arg The struct agc
+/// \param in The input samples
+/// \param out Receives the output samples, which may be the same as in
+/// \param len The number of floats in each
+void agc_process(void *arg, const float *in, float *out, size_t len);
+
+/// \brief The AGC as a stage of a mono graph, with one float a sample.  See dsp.h.
+/// \param arg The struct agc
+/// \param in The input samples
+/// \param out Receives the output samples, which may be the same as in
+/// \param len The number of floats in each
+void agc_process_mono(void *arg, const float *in, float *out, size_t len);
+
+/// \brief The AGC's current gain, for the meter.
+/// \param agc The AGC
+/// \return The gain in dB, not counting the volume
+float agc_gain_db(const struct agc *agc);
+
+/// \brief Find the largest magnitude in a block, four floats at a time.  This is the level the AGC works from, and it
+/// is here so that anything else that wants the level of a packet measures it the same way.
+/// \param in The samples
+/// \param len The number of floats
+/// \return The peak
+float agc_block_peak(const float *in, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_AGC_H
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file api_queue.c
+/// @brief Pipelined, coalescing queue for radio API commands with round-trip time statistics
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "api_queue.h"
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read the monotonic clock in nanoseconds
+/// \return The current value of CLOCK_MONOTONIC
+static uint64_t api_queue_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+/// \brief Record a round trip time.  Must be called with the lock held.
+/// \param stats The statistics to update
+/// \param rtt_ns The round trip time in nanoseconds
+static void api_queue_record_rtt(struct api_queue_stats *stats, const uint64_t rtt_ns) {
+    if (stats->completed == 0 || rtt_ns < stats->rtt_min_ns)
+        stats->rtt_min_ns = rtt_ns;
+    if (rtt_ns > stats->rtt_max_ns)
+        stats->rtt_max_ns = rtt_ns;
+    stats->rtt_sum_ns += rtt_ns;
+    ++stats->completed;
+
+    const uint64_t us = rtt_ns / 1000;
+    unsigned int bucket = us == 0 ? 0 : 63 - __builtin_clzll(us);
+    if (bucket >= API_QUEUE_RTT_BUCKETS)
+        bucket = API_QUEUE_RTT_BUCKETS - 1;
+    ++stats->rtt_buckets[bucket];
+}
+
+static void api_queue_pump(struct api_queue *queue);
+
+/// \brief Copy the queue's depth to where it can be read without the lock.  Must be called with the lock held.
+/// \param queue The queue
+static void api_queue_update_depth(struct api_queue *queue) {
+    atomic_store_explicit(&queue->depth, (unsigned int) queue->pending_count + queue->in_flight, memory_order_relaxed);
+}
+
+/// \brief The response callback for every command sent through the queue.  Records the round trip, frees the in-flight
+/// slot so that the next waiting command can go out and then hands the response to the submitter's callback.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param code The numeric error code returned from the command.  0 is success, anything else is a failure
+/// \param message The descriptive message returned from the radio
+/// \param arg The struct api_queue_slot the command was sent from
+static void api_queue_response(struct waveform_t *waveform, const unsigned int code, const char *message, void *arg) {
+    struct api_queue_slot *slot = arg;
+    struct api_queue *queue = slot->queue;
+
+    const uint64_t rtt_ns = api_queue_now_ns() - slot->sent_ns;
+    metrics_observe(queue->metrics, METRICS_COMMAND_RTT, (int64_t) rtt_ns);
+
+    pthread_mutex_lock(&queue->lock);
+    api_queue_record_rtt(&queue->stats, rtt_ns);
+    const waveform_response_cb_t cb = slot->cb;
+    void *cb_arg = slot->arg;
+    slot->busy = false;
+    --queue->in_flight;
+    api_queue_update_depth(queue);
+    pthread_mutex_unlock(&queue->lock);
+
+    if (cb != NULL)
+        cb(waveform, code, message, cb_arg);
+
+    api_queue_pump(queue);
+}
+
+/// \brief Send waiting commands until the in-flight window is full or nothing is left to send.
+/// Only one thread pumps at a time so that commands go out in the order they were queued; anybody else arriving while
+/// a pump is running just leaves their command for it.  The lock is dropped around the actual send since the library
+/// may call our response callback, which takes the lock, from its own thread while holding its locks.
+/// \param queue The queue to pump
+static void api_queue_pump(struct api_queue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    if (queue->pumping) {
+        pthread_mutex_unlock(&queue->lock);
+        return;
+    }
+    queue->pumping = true;
+
+    while (queue->pending_count > 0 && queue->in_flight < queue->window) {
+        struct api_queue_slot *slot = NULL;
+        for (unsigned int i = 0; i < queue->window; ++i) {
+            if (!queue->slots[i].busy) {
+                slot = &queue->slots[i];
+                break;
+            }
+        }
+
+        const struct api_queue_pending pending = queue->pending[queue->pending_head];
+        queue->pending_head = (queue->pending_head + 1) % API_QUEUE_DEPTH;
+        --queue->pending_count;
+
+        slot->busy = true;
+        slot->cb = pending.cb;
+        slot->arg = pending.arg;
+        slot->sent_ns = api_queue_now_ns();
+        ++queue->in_flight;
+        ++queue->stats.sent;
+        api_queue_update_depth(queue);
+        pthread_mutex_unlock(&queue->lock);
+
+        const int32_t ret = waveform_send_api_command_cb(queue->waveform, api_queue_response, slot, "%s",
+                                                         pending.command);
+
+        pthread_mutex_lock(&queue->lock);
+        if (ret < 0) {
+            fprintf(stderr, "Failed to send \"%s\"\n", pending.command);
+            slot->busy = false;
+            --queue->in_flight;
+            ++queue->stats.failed;
+
+            // The submitter still gets its response, a failure, just as if the radio had refused the command.  Its
+            // callback may submit again, which only queues the command for this pump to send.
+            if (pending.cb != NULL) {
+                pthread_mutex_unlock(&queue->lock);
+                pending.cb(queue->waveform, API_QUEUE_ERR_NOT_SENT, "Command could not be sent", pending.arg);
+                pthread_mutex_lock(&queue->lock);
+            }
+        }
+    }
+
+    queue->pumping = false;
+    api_queue_update_depth(queue);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void api_queue_init(struct api_queue *queue, struct waveform_t *waveform, unsigned int window) {
+    memset(queue, 0, sizeof(*queue));
+    pthread_mutex_init(&queue->lock, NULL);
+
+    if (window < 1)
+        window = 1;
+    if (window > API_QUEUE_MAX_WINDOW)
+        window = API_QUEUE_MAX_WINDOW;
+
+    queue->waveform = waveform;
+    queue->window = window;
+    for (unsigned int i = 0; i < API_QUEUE_MAX_WINDOW; ++i)
+        queue->slots[i].queue = queue;
+}
+
+void api_queue_destroy(struct api_queue *queue) {
+    pthread_mutex_destroy(&queue->lock);
+}
+
+int api_queue_submit(struct api_queue *queue, const char *key, const waveform_response_cb_t cb, void *arg,
+                     const char *format, ...) {
+    struct api_queue_pending pending = {.cb = cb, .arg = arg};
+
+    va_list ap;
+    va_start(ap, format);
+    const int len = vsnprintf(pending.command, sizeof(pending.command), format, ap);
+    va_end(ap);
+    if (len < 0 || (size_t) len >= sizeof(pending.command))
+        return -1;
+
+    if (key != NULL && snprintf(pending.key, sizeof(pending.key), "%s", key) >= (int) sizeof(pending.key))
+        return -1;
+
+    pthread_mutex_lock(&queue->lock);
+    ++queue->stats.submitted;
+
+    // If an earlier command with the same key hasn't gone out yet, the radio never needs to see it.  Overwrite it in
+    // place so that it keeps its position in the queue but carries the latest value.
+    if (key != NULL) {
+        for (size_t i = 0; i < queue->pending_count; ++i) {
+            struct api_queue_pending *queued = &queue->pending[(queue->pending_head + i) % API_QUEUE_DEPTH];
+            if (queued->key[0] != '\0' && strcmp(queued->key, pending.key) == 0) {
+                *queued = pending;
+                ++queue->stats.coalesced;
+                pthread_mutex_unlock(&queue->lock);
+                return 0;
+            }
+        }
+    }
+
+    if (queue->pending_count == API_QUEUE_DEPTH) {
+        pthread_mutex_unlock(&queue->lock);
+        return -1;
+    }
+
+    queue->pending[(queue->pending_head + queue->pending_count) % API_QUEUE_DEPTH] = pending;
+    ++queue->pending_count;
+    api_queue_update_depth(queue);
+    pthread_mutex_unlock(&queue->lock);
+
+    api_queue_pump(queue);
+    return 0;
+}
+
+void api_queue_get_stats(struct api_queue *queue, struct api_queue_stats *stats) {
+    pthread_mutex_lock(&queue->lock);
+    *stats = queue->stats;
+    pthread_mutex_unlock(&queue->lock);
+}
+
+unsigned int api_queue_depth(const struct api_queue *queue) {
+    return atomic_load_explicit(&queue->depth, memory_order_relaxed);
+}
+
+void api_queue_dump(struct api_queue *queue, FILE *out) {
+    struct api_queue_stats stats;
+    api_queue_get_stats(queue, &stats);
+
+    fprintf(out, "API commands: submitted=%" PRIu64 " coalesced=%" PRIu64 " sent=%" PRIu64 " failed=%" PRIu64
+                 " completed=%" PRIu64 "\n", stats.submitted, stats.coalesced, stats.sent, stats.failed,
+            stats.completed);
+    if (stats.completed == 0)
+        return;
+
+    fprintf(out, "API round trip: min=%" PRIu64 "us avg=%" PRIu64 "us max=%" PRIu64 "us\n", stats.rtt_min_ns / 1000,
+            stats.rtt_sum_ns / stats.completed / 1000, stats.rtt_max_ns / 1000);
+    for (unsigned int i = 0; i < API_QUEUE_RTT_BUCKETS; ++i) {
+        if (stats.rtt_buckets[i] != 0)
+            fprintf(out, "  %8lluus+ %" PRIu64 "\n", i == 0 ? 0ULL : 1ULL << i, stats.rtt_buckets[i]);
+    }
+}
@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file api_queue.h
+/// @brief Pipelined, coalescing queue for radio API commands with round-trip time statistics
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_API_QUEUE_H
+#define WAVEFORM_EXAMPLE_API_QUEUE_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "metrics.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The default number of commands allowed to await a response at once
+#define API_QUEUE_DEFAULT_WINDOW 4
+
+/// \brief The largest in-flight window supported
+#define API_QUEUE_MAX_WINDOW 16
+
+/// \brief The most commands that can wait to be sent
+#define API_QUEUE_DEPTH 32
+
+/// \brief The longest command, including its terminator
+#define API_QUEUE_COMMAND_LEN 256
+
+/// \brief The longest coalescing key, including its terminator
+#define API_QUEUE_KEY_LEN 32
+
+/// \brief The number of round trip histogram buckets.  Bucket i counts round trips of [2^i, 2^(i+1)) microseconds,
+/// with everything below 1us in bucket 0 and everything above in the last bucket.
+#define API_QUEUE_RTT_BUCKETS 24
+
+/// \brief The code a command's callback is given if the command could not be sent to the radio at all
+#define API_QUEUE_ERR_NOT_SENT 0x50000100U
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A command waiting to be sent
+struct api_queue_pending {
+    char key[API_QUEUE_KEY_LEN];
+    char command[API_QUEUE_COMMAND_LEN];
+    waveform_response_cb_t cb;
+    void *arg;
+};
+
+struct api_queue;
+
+/// \brief A command that has been sent and is awaiting its response
+struct api_queue_slot {
+    struct api_queue *queue;
+    bool busy;
+    waveform_response_cb_t cb;
+    void *arg;
+    uint64_t sent_ns;
+};
+
+/// \brief Round trip statistics for the commands sent through a queue
+struct api_queue_stats {
+    uint64_t submitted;
+    uint64_t coalesced;
+    uint64_t sent;
+    uint64_t failed;
+    uint64_t completed;
+    uint64_t rtt_min_ns;
+    uint64_t rtt_max_ns;
+    uint64_t rtt_sum_ns;
+    uint64_t rtt_buckets[API_QUEUE_RTT_BUCKETS];
+};
+
+/// \brief A queue of API commands for one waveform
+struct api_queue {
+    pthread_mutex_t lock;
+    struct waveform_t *waveform;
+    unsigned int window;
+    unsigned int in_flight;
+    bool pumping;
+    struct api_queue_pending pending[API_QUEUE_DEPTH];
+    size_t pending_head;
+    size_t pending_count;
+    struct api_queue_slot slots[API_QUEUE_MAX_WINDOW];
+    struct api_queue_stats stats;
+
+    // pending_count + in_flight, copied out from under the lock so that it can be read without taking it
+    _Atomic unsigned int depth;
+
+    // If not NULL, round trips are also recorded here for the Prometheus exporter.  Set it after api_queue_init.
+    struct metrics *metrics;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a queue.
+/// \param queue The queue to initialize
+/// \param waveform The waveform to send commands through
+/// \param window The number of commands that may await a response at once, 1 to API_QUEUE_MAX_WINDOW
+void api_queue_init(struct api_queue *queue, struct waveform_t *waveform, unsigned int window);
+
+/// \brief Release a queue.  No response callbacks may be outstanding, i.e. the radio's event loops must have stopped.
+/// Commands that were never sent are dropped without calling their callbacks.
+/// \param queue The queue to release
+void api_queue_destroy(struct api_queue *queue);
+
+/// \brief Queue a command to be sent to the radio.
+/// If key is not NULL and a command with the same key is still waiting to be sent, that command is replaced by this
+/// one in its place in the queue and its callback is never called.  Use this for commands where only the latest value
+/// matters, like tuning or setting a filter.
+/// \param queue The queue
+/// \param key The coalescing key, e.g. "filt 0", or NULL to always send
+/// \param cb Called with the response, or NULL.  If the command can't be sent it is called with API_QUEUE_ERR_NOT_SENT.
+/// \param arg Passed to cb
+/// \param format A printf(3) style format for the command
+/// \return 0 for success otherwise a negative value if the queue is full or the command is too long
+int api_queue_submit(struct api_queue *queue, const char *key, waveform_response_cb_t cb, void *arg,
+                     const char *format, ...) __attribute__((format(printf, 5, 6)));
+
+/// \brief Take a copy of the queue's statistics.
+/// \param queue The queue
+/// \param stats Receives the statistics
+void api_queue_get_stats(struct api_queue *queue, struct api_queue_stats *stats);
+
+/// \brief Count the commands waiting to be sent or awaiting a response.  This never takes the lock, so the data
+/// callbacks may call it.
+/// \param queue The queue
+/// \return The number of commands
+unsigned int api_queue_depth(const struct api_queue *queue);
+
+/// \brief Print the queue's counters and round trip time distribution.
+/// \param queue The queue
+/// \param out Where to print
+void api_queue_dump(struct api_queue *queue, FILE *out);
+
+#endif // WAVEFORM_EXAMPLE_API_QUEUE_H
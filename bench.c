@@ -0,0 +1,946 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file bench.c
+/// @brief Microbenchmarks for the data callbacks and DSP kernels
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// Every kernel runs at every waveform_sample_rate and packet size against the mock library in mock/, so that no radio
+/// is needed.  Sizes are in floats, as returned by get_packet_len, and "samples" below means floats too.
+/// Each result is the best of several runs, reported as ns/sample, packets/s and how many times faster than real time
+/// that is at the sample rate.  Use --csv to get numbers to track from build to build.
+///
+/// The FEC codecs work on bytes rather than samples, so they follow in a table of their own: ns/byte, Mbit/s and how
+/// many times faster than the fastest link the modems run that is.
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <getopt.h>
+#include <libgen.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include <waveform/waveform_mock.h>
+#include "agc.h"
+#include "capture.h"
+#include "commands.h"
+#include "dsp.h"
+#include "fec.h"
+#include "fixed.h"
+#include "fsk.h"
+#include "hilbert.h"
+#include "ofdm.h"
+#include "osc.h"
+#include "junk_waveform.h"
+#include "tables.h"
+#include "telemetry.h"
+#include "sigmf.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+#define NS_PER_SEC 1000000000LL
+
+// Each run processes at least this many samples
+#define BENCH_RUN_SAMPLES (1U << 18)
+
+// The number of runs of each case, of which the fastest is reported
+#define BENCH_RUNS 5
+
+// The largest packet we try
+#define BENCH_MAX_PACKET 1024
+
+// The tone the oscillator kernels make, as the JUNK waveform does
+#define BENCH_TONE_HZ 1000
+
+// The size of the lookup table for the phase accumulator oscillator
+#define BENCH_LUT_BITS 10
+
+// The size of the table for the DSP graph kernels, as the JUNK waveform's.  The cost doesn't depend on the tone.
+#define BENCH_DSP_TABLE_LEN 24
+
+// The baud rate for the modem kernels, fitted to each sample rate as the modem does
+#define BENCH_FSK_BAUD 1200
+
+// Each run of a FEC codec processes at least this many bytes
+#define BENCH_CODEC_RUN_BYTES (1U << 16)
+
+// The fastest link the FEC codecs have to keep up with: the FSK modem at the highest "set baud=" allows, in bits/s
+#define BENCH_LINK_BPS 9600
+
+// The bytes the CRC kernel checks at a time
+#define BENCH_CRC_BYTES 1024
+
+// The DSP graph kernels' operations, fused and on their own
+#define BENCH_TONE_GAIN_CHAIN(X) X(tone) X(gain)
+#define BENCH_TONE_CHAIN(X) X(tone)
+#define BENCH_GAIN_CHAIN(X) X(gain)
+#define BENCH_SHIFT_CHAIN(X) X(rotate)
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The state for the DSP graph kernels' stages
+struct bench_tone_gain {
+    struct dsp_tone tone;
+    struct dsp_gain gain;
+};
+
+/// \brief The state for the shift kernel's stage
+struct bench_shift {
+    struct dsp_rotate rotate;
+};
+
+/// \brief Everything a kernel may need, set up fresh for each sample rate and packet size
+struct bench_state {
+    uint32_t sample_rate;
+    size_t packet_len;
+    struct waveform_t *waveform;
+    struct waveform_vita_packet packet;
+    struct junk_context ctx;
+    float in[BENCH_MAX_PACKET];
+    float out[BENCH_MAX_PACKET];
+
+    // Oscillator state for the NCO variants
+    float *table;
+    size_t table_len;
+    size_t table_phase;
+    float phase;
+    float phase_step;
+    float rotator_re;
+    float rotator_im;
+    float rotator_step_re;
+    float rotator_step_im;
+    uint32_t lut_phase;
+    uint32_t lut_step;
+    struct osc osc;
+    uint64_t counter;
+
+    // The DSP graph variants
+    struct dsp_graph graph;
+    struct bench_tone_gain tone_gain;
+    struct fixed_tone fixed_tone;
+    struct fixed_graph fixed_graph;
+    struct osc tone_osc;
+    struct agc agc;
+    struct fsk_modulator fsk_mod;
+    struct fsk_demodulator fsk_demod;
+    struct ofdm ofdm;
+    struct hilbert hilbert;
+    struct fixed_hilbert fixed_hilbert;
+    struct bench_shift shift;
+    struct fixed_rotate fixed_rotate;
+    float *signal;
+    size_t signal_len;
+    size_t signal_pos;
+
+    struct capture capture;
+    struct sigmf_recorder recorder;
+};
+
+/// \brief Everything a FEC codec may need, set up once
+struct bench_codec_state {
+    uint8_t data[BENCH_CRC_BYTES];
+    uint8_t frame[FEC_FRAME];
+    uint8_t noisy_frame[FEC_FRAME];
+    uint8_t codeword[FEC_RS_CODEWORD];
+    uint8_t damaged[FEC_RS_CODEWORD];
+    uint8_t scratch[FEC_RS_CODEWORD];
+    uint8_t coded[FEC_CODED];
+    uint8_t soft[FEC_CONV_BITS * 2];
+    struct fec_viterbi viterbi;
+    struct fec_deframer deframer;
+};
+
+/// \brief A FEC codec to measure.  run processes one block of bytes bytes.
+struct bench_codec {
+    const char *name;
+    size_t bytes;
+    void (*run)(struct bench_codec_state *state);
+};
+
+/// \brief A kernel to measure.  run processes one packet of state->packet_len samples.
+struct bench_kernel {
+    const char *name;
+    int (*setup)(struct bench_state *state);
+    void (*run)(struct bench_state *state);
+    void (*teardown)(struct bench_state *state);
+};
+
+// ****************************************
+// Static Variables
+// ****************************************
+
+// Every sample rate the library knows about
+static const struct {
+    enum waveform_sample_rate rate;
+    uint32_t hz;
+} bench_rates[] = {
+    {SR_3K, 3000}, {SR_4K, 4000}, {SR_6K, 6000}, {SR_8K, 8000}, {SR_12K, 12000}, {SR_16K, 16000},
+    {SR_24K, 24000}, {SR_32K, 32000}, {SR_48K, 48000}, {SR_64K, 64000}, {SR_96K, 96000}, {SR_128K, 128000},
+    {SR_192K, 192000}, {SR_256K, 256000}, {SR_384K, 384000}, {SR_512K, 512000}, {SR_768K, 768000},
+    {SR_1024K, 1024000}, {SR_1568K, 1568000}, {SR_2048K, 2048000}, {SR_3072K, 3072000}, {SR_4096K, 4096000},
+    {SR_6144K, 6144000}, {SR_8192K, 8192000}, {SR_12288K, 12288000}, {SR_16384K, 16384000},
+    {SR_24576K, 24576000}, {SR_32768K, 32768000}, {SR_49152K, 49152000}, {SR_65536K, 65536000},
+    {SR_98304K, 98304000}, {SR_131072K, 131072000},
+};
+
+// The packet sizes to try, in floats
+static const size_t bench_sizes[] = {64, 128, 256, 512, BENCH_MAX_PACKET};
+
+// Results are accumulated here so that the compiler can't throw the work away
+static volatile float bench_sink;
+
+// ****************************************
+// Kernels
+// ****************************************
+
+/// \brief The receive callback, as the library would call it
+static void bench_packet_rx(struct bench_state *state) {
+    packet_rx(state->waveform, &state->packet, sizeof(state->packet), NULL);
+}
+
+/// \brief The transmit callback, as the library would call it while transmitting
+static int bench_packet_tx_setup(struct bench_state *state) {
+    state->ctx.tx = true;
+    return 0;
+}
+
+static void bench_packet_tx(struct bench_state *state) {
+    packet_tx(state->waveform, &state->packet, sizeof(state->packet), NULL);
+}
+
+/// \brief The precomputed table, as packet_rx does it, with a table of one cycle of the tone at this sample rate
+static int bench_sin_table_setup(struct bench_state *state) {
+    state->table_len = state->sample_rate / BENCH_TONE_HZ;
+    state->table = malloc(state->table_len * sizeof(float));
+    if (state->table == NULL)
+        return -1;
+    for (size_t i = 0; i < state->table_len; ++i)
+        state->table[i] = sinf(2.0F * (float) M_PI * (float) i / (float) state->table_len);
+    return 0;
+}
+
+static void bench_sin_table(struct bench_state *state) {
+    for (size_t i = 0; i < state->packet_len; i += 2) {
+        state->out[i] = state->out[i + 1] = state->table[state->table_phase] * 0.5F;
+        state->table_phase = (state->table_phase + 1) % state->table_len;
+    }
+    bench_sink += state->out[0];
+}
+
+/// \brief sinf of a running phase
+static int bench_nco_sinf_setup(struct bench_state *state) {
+    state->phase_step = 2.0F * (float) M_PI * BENCH_TONE_HZ / (float) state->sample_rate;
+    return 0;
+}
+
+static void bench_nco_sinf(struct bench_state *state) {
+    for (size_t i = 0; i < state->packet_len; i += 2) {
+        state->out[i] = state->out[i + 1] = sinf(state->phase) * 0.5F;
+        state->phase += state->phase_step;
+        if (state->phase >= 2.0F * (float) M_PI)
+            state->phase -= 2.0F * (float) M_PI;
+    }
+    bench_sink += state->out[0];
+}
+
+/// \brief A complex rotator, renormalized once a packet so that its amplitude doesn't drift
+static int bench_nco_rotator_setup(struct bench_state *state) {
+    const double step = 2.0 * M_PI * BENCH_TONE_HZ / state->sample_rate;
+    state->rotator_re = 1.0F;
+    state->rotator_im = 0.0F;
+    state->rotator_step_re = (float) cos(step);
+    state->rotator_step_im = (float) sin(step);
+    return 0;
+}
+
+static void bench_nco_rotator(struct bench_state *state) {
+    float re = state->rotator_re;
+    float im = state->rotator_im;
+
+    for (size_t i = 0; i < state->packet_len; i += 2) {
+        state->out[i] = state->out[i + 1] = im * 0.5F;
+        const float next_re = re * state->rotator_step_re - im * state->rotator_step_im;
+        im = re * state->rotator_step_im + im * state->rotator_step_re;
+        re = next_re;
+    }
+
+    const float scale = (3.0F - (re * re + im * im)) * 0.5F;
+    state->rotator_re = re * scale;
+    state->rotator_im = im * scale;
+    bench_sink += state->out[0];
+}
+
+/// \brief The same rotator seeded from a 64 bit phase oscillator at the start of every packet, as the shift stages do
+static int bench_nco_osc_setup(struct bench_state *state) {
+    osc_init(&state->osc, state->sample_rate);
+    osc_set(&state->osc, BENCH_TONE_HZ);
+    return 0;
+}
+
+static void bench_nco_osc(struct bench_state *state) {
+    float re;
+    float im;
+    osc_phasor(&state->osc, &re, &im);
+    const float step_re = state->osc.step_re;
+    const float step_im = state->osc.step_im;
+
+    for (size_t i = 0; i < state->packet_len; i += 2) {
+        state->out[i] = state->out[i + 1] = im * 0.5F;
+        const float next_re = re * step_re - im * step_im;
+        im = re * step_im + im * step_re;
+        re = next_re;
+    }
+
+    osc_advance(&state->osc, state->packet_len / 2);
+    bench_sink += state->out[0];
+}
+
+/// \brief A 32 bit phase accumulator indexing a fixed size table with its top bits
+static int bench_nco_lut_setup(struct bench_state *state) {
+    state->table_len = 1U << BENCH_LUT_BITS;
+    state->table = malloc(state->table_len * sizeof(float));
+    if (state->table == NULL)
+        return -1;
+    for (size_t i = 0; i < state->table_len; ++i)
+        state->table[i] = sinf(2.0F * (float) M_PI * (float) i / (float) state->table_len);
+    state->lut_step = (uint32_t) ((double) BENCH_TONE_HZ / state->sample_rate * 4294967296.0);
+    return 0;
+}
+
+static void bench_nco_lut(struct bench_state *state) {
+    for (size_t i = 0; i < state->packet_len; i += 2) {
+        state->out[i] = state->out[i + 1] = state->table[state->lut_phase >> (32 - BENCH_LUT_BITS)] * 0.5F;
+        state->lut_phase += state->lut_step;
+    }
+    bench_sink += state->out[0];
+}
+
+/// \brief The tone and gain as separate stages, each making its own pass over the packet, and fused into one
+DSP_FUSED_STAGE(bench_tone_stage, struct bench_tone_gain, BENCH_TONE_CHAIN)
+DSP_FUSED_STAGE(bench_gain_stage, struct bench_tone_gain, BENCH_GAIN_CHAIN)
+DSP_FUSED_STAGE(bench_tone_gain_stage, struct bench_tone_gain, BENCH_TONE_GAIN_CHAIN)
+
+/// \brief The fused tone and gain again in a mono graph, which only makes one float of each sample and, since the tone
+/// is its source, never packs the input
+DSP_FUSED_MONO_STAGE(bench_tone_gain_mono_stage, struct bench_tone_gain, BENCH_TONE_GAIN_CHAIN)
+
+/// \brief The shift, as the modems' graphs run it
+DSP_FUSED_STAGE(bench_shift_stage, struct bench_shift, BENCH_SHIFT_CHAIN)
+
+static int bench_dsp_setup(struct bench_state *state) {
+    state->table_len = BENCH_DSP_TABLE_LEN;
+    state->table = malloc(state->table_len * sizeof(float));
+    if (state->table == NULL)
+        return -1;
+    for (size_t i = 0; i < state->table_len; ++i)
+        state->table[i] = sinf(2.0F * (float) M_PI * (float) i / (float) state->table_len);
+    dsp_tone_osc_init(&state->tone_osc, BENCH_DSP_TABLE_LEN, state->sample_rate);
+    state->tone_gain = (struct bench_tone_gain) {
+        .tone = {.table = state->table, .len = BENCH_DSP_TABLE_LEN, .osc = &state->tone_osc},
+        .gain = {.gain = 0.5F},
+    };
+    dsp_graph_init(&state->graph);
+    return 0;
+}
+
+static int bench_dsp_stages_setup(struct bench_state *state) {
+    if (bench_dsp_setup(state) != 0)
+        return -1;
+    dsp_graph_add(&state->graph, "tone", bench_tone_stage, &state->tone_gain);
+    dsp_graph_add(&state->graph, "gain", bench_gain_stage, &state->tone_gain);
+    return 0;
+}
+
+static int bench_dsp_fused_setup(struct bench_state *state) {
+    if (bench_dsp_setup(state) != 0)
+        return -1;
+    dsp_graph_add(&state->graph, "tone+gain", bench_tone_gain_stage, &state->tone_gain);
+    return 0;
+}
+
+static int bench_dsp_mono_setup(struct bench_state *state) {
+    if (bench_dsp_setup(state) != 0)
+        return -1;
+    dsp_graph_init_mono(&state->graph);
+    dsp_graph_add_source(&state->graph, "tone+gain", bench_tone_gain_mono_stage, &state->tone_gain);
+    return 0;
+}
+
+/// \brief The same again from a Q15 table in a fixed point graph, as the tone graphs are built with
+/// WAVEFORM_FIXED_POINT, including the conversion to float on the way out
+static int bench_q15_tone_setup(struct bench_state *state) {
+    if (bench_dsp_setup(state) != 0)
+        return -1;
+    if (fixed_tone_init(&state->fixed_tone, TABLES_TONE_Q15(JUNK_SAMPLE_RATE_HZ), TABLES_TONE_LEN(JUNK_SAMPLE_RATE_HZ),
+                        &state->tone_osc, &state->tone_gain.gain.gain) != 0)
+        return -1;
+    fixed_graph_init(&state->fixed_graph);
+    fixed_graph_add_source(&state->fixed_graph, "tone+gain", fixed_tone_process, &state->fixed_tone);
+    dsp_graph_init_mono(&state->graph);
+    dsp_graph_add_source(&state->graph, "tone+gain-q15", fixed_graph_process, &state->fixed_graph);
+    return 0;
+}
+
+static void bench_dsp(struct bench_state *state) {
+    dsp_graph_run(&state->graph, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The receive AGC and limiter on a ramp
+static int bench_agc_setup(struct bench_state *state) {
+    agc_init(&state->agc, state->sample_rate);
+    return 0;
+}
+
+static void bench_agc(struct bench_state *state) {
+    agc_process(&state->agc, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The same in a mono graph, on half the floats
+static void bench_agc_mono(struct bench_state *state) {
+    agc_process_mono(&state->agc, state->in, state->out, state->packet_len / 2);
+    bench_sink += state->out[0];
+}
+
+/// \brief The Hilbert transform stages, audio to complex baseband and back
+static int bench_hilbert_setup(struct bench_state *state) {
+    hilbert_init(&state->hilbert, HILBERT_USB);
+    return 0;
+}
+
+static void bench_hilbert_analytic(struct bench_state *state) {
+    hilbert_analytic(&state->hilbert, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+static void bench_hilbert_real(struct bench_state *state) {
+    hilbert_real(&state->hilbert, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The shift of complex baseband, in float and in Q15
+static int bench_shift_setup(struct bench_state *state) {
+    dsp_rotate_set(&state->shift.rotate, BENCH_TONE_HZ, state->sample_rate);
+    return 0;
+}
+
+static void bench_shift(struct bench_state *state) {
+    bench_shift_stage(&state->shift, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The Q15 kernels each run a fixed point graph of the one stage, so they include converting the packet to Q15
+/// and back, as the graphs built with WAVEFORM_FIXED_POINT do
+static int bench_q15_analytic_setup(struct bench_state *state) {
+    fixed_hilbert_init(&state->fixed_hilbert, HILBERT_USB);
+    fixed_graph_init(&state->fixed_graph);
+    return fixed_graph_add(&state->fixed_graph, "analytic", fixed_hilbert_analytic, &state->fixed_hilbert);
+}
+
+static int bench_q15_real_setup(struct bench_state *state) {
+    fixed_hilbert_init(&state->fixed_hilbert, HILBERT_USB);
+    fixed_graph_init(&state->fixed_graph);
+    return fixed_graph_add(&state->fixed_graph, "real", fixed_hilbert_real, &state->fixed_hilbert);
+}
+
+static int bench_q15_shift_setup(struct bench_state *state) {
+    bench_shift_setup(state);
+    fixed_rotate_init(&state->fixed_rotate, &state->shift.rotate.osc);
+    fixed_graph_init(&state->fixed_graph);
+    return fixed_graph_add(&state->fixed_graph, "shift", fixed_rotate_process, &state->fixed_rotate);
+}
+
+static void bench_q15(struct bench_state *state) {
+    fixed_graph_process(&state->fixed_graph, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The bytes the modem kernels send
+static const uint8_t bench_message[] = "The quick brown fox jumps over the lazy dog";
+
+/// \brief The FSK modulator, kept busy with bytes to send
+
+static int bench_fsk_mod_setup(struct bench_state *state) {
+    fsk_modulator_init(&state->fsk_mod, state->sample_rate, BENCH_FSK_BAUD);
+    return 0;
+}
+
+static void bench_fsk_mod(struct bench_state *state) {
+    if (atomic_load_explicit(&state->fsk_mod.head, memory_order_relaxed) ==
+        atomic_load_explicit(&state->fsk_mod.tail, memory_order_relaxed))
+        fsk_modulator_queue(&state->fsk_mod, bench_message, sizeof(bench_message));
+    fsk_modulate(&state->fsk_mod, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+/// \brief The FSK demodulator on a packet of the modulator's output
+static int bench_fsk_demod_setup(struct bench_state *state) {
+    fsk_modulator_init(&state->fsk_mod, state->sample_rate, BENCH_FSK_BAUD);
+    fsk_modulator_queue(&state->fsk_mod, bench_message, sizeof(bench_message));
+    fsk_modulate(&state->fsk_mod, NULL, state->in, state->packet_len);
+    fsk_demodulator_init(&state->fsk_demod, state->sample_rate, BENCH_FSK_BAUD);
+    return 0;
+}
+
+static void bench_fsk_demod(struct bench_state *state) {
+    fsk_demodulate(&state->fsk_demod, state->in, state->out, state->packet_len);
+    state->fsk_demod.num_decoded = 0;
+    bench_sink += state->out[0];
+}
+
+/// \brief The OFDM modulator, kept busy with bursts
+static int bench_ofdm_mod_setup(struct bench_state *state) {
+    ofdm_init(&state->ofdm, state->sample_rate);
+    return ofdm_acquire(&state->ofdm);
+}
+
+static void bench_ofdm_mod(struct bench_state *state) {
+    if (atomic_load_explicit(&state->ofdm.tx.head, memory_order_relaxed) ==
+        atomic_load_explicit(&state->ofdm.tx.tail, memory_order_relaxed))
+        ofdm_queue(&state->ofdm, bench_message, sizeof(bench_message));
+    ofdm_modulate(&state->ofdm, state->in, state->out, state->packet_len);
+    bench_sink += state->out[0];
+}
+
+static void bench_ofdm_teardown(struct bench_state *state) {
+    ofdm_release(&state->ofdm);
+    free(state->signal);
+    state->signal = NULL;
+}
+
+/// \brief The OFDM demodulator on a second of back to back bursts, a packet at a time, so that it spends most of its
+/// time decoding data symbols
+static int bench_ofdm_demod_setup(struct bench_state *state) {
+    if (bench_ofdm_mod_setup(state) != 0)
+        return -1;
+
+    state->signal_len = (size_t) state->sample_rate * 2 / state->packet_len * state->packet_len;
+    state->signal_pos = 0;
+    state->signal = malloc(state->signal_len * sizeof(float));
+    if (state->signal == NULL) {
+        ofdm_release(&state->ofdm);
+        return -1;
+    }
+    for (size_t i = 0; i < state->signal_len; i += state->packet_len) {
+        ofdm_queue(&state->ofdm, bench_message, sizeof(bench_message));
+        ofdm_modulate(&state->ofdm, NULL, state->signal + i, state->packet_len);
+    }
+    return 0;
+}
+
+static void bench_ofdm_demod(struct bench_state *state) {
+    ofdm_demodulate(&state->ofdm, state->signal + state->signal_pos, state->out, state->packet_len);
+    state->ofdm.rx.num_decoded = 0;
+    state->signal_pos = (state->signal_pos + state->packet_len) % state->signal_len;
+    bench_sink += state->out[0];
+}
+
+/// \brief The meter update packet_rx makes for every packet.  Against the mock library this only measures our side of
+/// the calls.
+static void bench_meters(struct bench_state *state) {
+    waveform_meter_set_float_value(state->waveform, "junk-snr", (float) state->counter++);
+    waveform_meters_send(state->waveform);
+}
+
+/// \brief The byte data message packet_rx formats every hundredth packet, formatted for every packet here
+static void bench_snprintf(struct bench_state *state) {
+    ++state->counter;
+    size_t len = snprintf(NULL, 0, "Callback Counter: %ld\n", state->counter);
+    uint8_t data_message[len + 1];
+    snprintf((char *) data_message, sizeof(data_message), "Callback Counter: %ld\n", state->counter);
+    waveform_send_byte_data_packet(state->waveform, data_message, sizeof(data_message));
+}
+
+/// \brief Recording a packet to a capture file, which is thrown away
+static int bench_capture_setup(struct bench_state *state) {
+    return capture_create(&state->capture, "/dev/null", state->sample_rate);
+}
+
+static void bench_capture(struct bench_state *state) {
+    capture_write(&state->capture, CAPTURE_RX, 0, &state->packet);
+}
+
+static void bench_capture_teardown(struct bench_state *state) {
+    capture_close(&state->capture);
+}
+
+/// \brief Feeding the SigMF recorder's pre-trigger ring.  The ring is sized for 24ksps whatever the rate, so that
+/// the fastest rates don't need gigabytes for it.
+static int bench_sigmf_setup(struct bench_state *state) {
+    char base[64];
+    snprintf(base, sizeof(base), "%s/waveform-bench-%ld", P_tmpdir, (long) getpid());
+    const struct sigmf_config config = {
+        .base_path = base,
+        .sample_rate = 24000,
+        .pre_seconds = 1,
+        .post_seconds = 1,
+    };
+    return sigmf_recorder_init(&state->recorder, &config);
+}
+
+static void bench_sigmf(struct bench_state *state) {
+    const struct timespec ts = {0};
+    sigmf_recorder_write(&state->recorder, state->in, state->packet_len, &ts);
+}
+
+static void bench_sigmf_teardown(struct bench_state *state) {
+    sigmf_recorder_destroy(&state->recorder);
+}
+
+// Every kernel, in the order they are run
+static const struct bench_kernel bench_kernels[] = {
+    {.name = "packet_rx", .run = bench_packet_rx},
+    {.name = "packet_tx", .setup = bench_packet_tx_setup, .run = bench_packet_tx},
+    {.name = "sin_table", .setup = bench_sin_table_setup, .run = bench_sin_table},
+    {.name = "nco_sinf", .setup = bench_nco_sinf_setup, .run = bench_nco_sinf},
+    {.name = "nco_rotator", .setup = bench_nco_rotator_setup, .run = bench_nco_rotator},
+    {.name = "nco_osc", .setup = bench_nco_osc_setup, .run = bench_nco_osc},
+    {.name = "nco_lut", .setup = bench_nco_lut_setup, .run = bench_nco_lut},
+    {.name = "dsp_stages", .setup = bench_dsp_stages_setup, .run = bench_dsp},
+    {.name = "dsp_fused", .setup = bench_dsp_fused_setup, .run = bench_dsp},
+    {.name = "dsp_mono", .setup = bench_dsp_mono_setup, .run = bench_dsp},
+    {.name = "q15_tone", .setup = bench_q15_tone_setup, .run = bench_dsp},
+    {.name = "agc", .setup = bench_agc_setup, .run = bench_agc},
+    {.name = "agc_mono", .setup = bench_agc_setup, .run = bench_agc_mono},
+    {.name = "analytic", .setup = bench_hilbert_setup, .run = bench_hilbert_analytic},
+    {.name = "analytic_real", .setup = bench_hilbert_setup, .run = bench_hilbert_real},
+    {.name = "q15_analytic", .setup = bench_q15_analytic_setup, .run = bench_q15},
+    {.name = "q15_analytic_real", .setup = bench_q15_real_setup, .run = bench_q15},
+    {.name = "shift", .setup = bench_shift_setup, .run = bench_shift},
+    {.name = "q15_shift", .setup = bench_q15_shift_setup, .run = bench_q15},
+    {.name = "fsk_mod", .setup = bench_fsk_mod_setup, .run = bench_fsk_mod},
+    {.name = "fsk_demod", .setup = bench_fsk_demod_setup, .run = bench_fsk_demod},
+    {.name = "ofdm_mod", .setup = bench_ofdm_mod_setup, .run = bench_ofdm_mod, .teardown = bench_ofdm_teardown},
+    {.name = "ofdm_demod", .setup = bench_ofdm_demod_setup, .run = bench_ofdm_demod, .teardown = bench_ofdm_teardown},
+    {.name = "meters", .run = bench_meters},
+    {.name = "snprintf", .run = bench_snprintf},
+    {.name = "capture_write", .setup = bench_capture_setup, .run = bench_capture, .teardown = bench_capture_teardown},
+    {.name = "sigmf_write", .setup = bench_sigmf_setup, .run = bench_sigmf, .teardown = bench_sigmf_teardown},
+};
+
+/// \brief Set up the FEC codecs' inputs: a frame, and the same with a bit in fifty wrong, which is about as many as
+/// it can take
+static void bench_codec_setup(struct bench_codec_state *state) {
+    for (size_t i = 0; i < sizeof(state->data); ++i)
+        state->data[i] = (uint8_t) (i * 7 + 3);
+
+    fec_frame(bench_message, sizeof(bench_message), state->frame);
+    memcpy(state->noisy_frame, state->frame, sizeof(state->frame));
+    for (size_t bit = FEC_SYNC_BYTES * 8 + 25; bit < sizeof(state->frame) * 8; bit += 50)
+        state->noisy_frame[bit / 8] ^= (uint8_t) (1U << (bit % 8));
+
+    memcpy(state->codeword, state->data, FEC_BLOCK);
+    fec_rs_encode(state->codeword, FEC_BLOCK, state->codeword + FEC_BLOCK);
+    memcpy(state->damaged, state->codeword, sizeof(state->codeword));
+    for (size_t i = 0; i < FEC_RS_PARITY / 2; ++i)
+        state->damaged[i * FEC_RS_CODEWORD / (FEC_RS_PARITY / 2)] ^= 0x5a;
+
+    fec_conv_encode(state->codeword, sizeof(state->codeword), state->coded);
+    for (size_t i = 0; i < sizeof(state->soft); ++i)
+        state->soft[i] = state->noisy_frame[FEC_SYNC_BYTES + i / 8] >> (7 - i % 8) & 1 ? 255 : 0;
+
+    fec_deframer_init(&state->deframer);
+}
+
+static void bench_crc32c(struct bench_codec_state *state) {
+    bench_sink += (float) fec_crc32c(0, state->data, BENCH_CRC_BYTES);
+}
+
+static void bench_rs_encode(struct bench_codec_state *state) {
+    fec_rs_encode(state->data, FEC_BLOCK, state->scratch);
+    bench_sink += state->scratch[0];
+}
+
+/// \brief The Reed-Solomon decoder on a clean block, which stops once the syndromes are all zero
+static void bench_rs_check(struct bench_codec_state *state) {
+    bench_sink += (float) fec_rs_decode(state->codeword, sizeof(state->codeword));
+}
+
+/// \brief The Reed-Solomon decoder on a block with as many bad bytes as it can correct
+static void bench_rs_correct(struct bench_codec_state *state) {
+    memcpy(state->scratch, state->damaged, sizeof(state->scratch));
+    bench_sink += (float) fec_rs_decode(state->scratch, sizeof(state->scratch));
+}
+
+static void bench_conv_encode(struct bench_codec_state *state) {
+    bench_sink += (float) fec_conv_encode(state->codeword, sizeof(state->codeword), state->coded);
+}
+
+static void bench_viterbi(struct bench_codec_state *state) {
+    fec_viterbi_decode(&state->viterbi, state->soft, FEC_CONV_BITS, state->scratch);
+    bench_sink += state->scratch[0];
+}
+
+static void bench_fec_frame(struct bench_codec_state *state) {
+    fec_frame(bench_message, sizeof(bench_message), state->frame);
+    bench_sink += state->frame[FEC_SYNC_BYTES];
+}
+
+/// \brief The whole receive side on a noisy frame: sync, Viterbi, Reed-Solomon and CRC
+static void bench_fec_deframe(struct bench_codec_state *state) {
+    fec_deframe(&state->deframer, state->noisy_frame, sizeof(state->noisy_frame));
+    state->deframer.num_decoded = 0;
+}
+
+// Every FEC codec, in the order they are run.  Each counts the bytes of payload a run gets through.
+static const struct bench_codec bench_codecs[] = {
+    {.name = "crc32c", .bytes = BENCH_CRC_BYTES, .run = bench_crc32c},
+    {.name = "rs_encode", .bytes = FEC_BLOCK, .run = bench_rs_encode},
+    {.name = "rs_check", .bytes = FEC_BLOCK, .run = bench_rs_check},
+    {.name = "rs_correct", .bytes = FEC_BLOCK, .run = bench_rs_correct},
+    {.name = "conv_encode", .bytes = FEC_RS_CODEWORD, .run = bench_conv_encode},
+    {.name = "viterbi", .bytes = FEC_RS_CODEWORD, .run = bench_viterbi},
+    {.name = "fec_frame", .bytes = sizeof(bench_message), .run = bench_fec_frame},
+    {.name = "fec_deframe", .bytes = sizeof(bench_message), .run = bench_fec_deframe},
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read the monotonic clock in nanoseconds
+/// \return The current value of CLOCK_MONOTONIC
+static int64_t bench_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * NS_PER_SEC + now.tv_nsec;
+}
+
+/// \brief Measure one kernel at one sample rate and packet size.
+/// \param kernel The kernel
+/// \param sample_rate The sample rate in Hz
+/// \param packet_len The packet size in floats
+/// \param ns Receives the fastest run's time in nanoseconds
+/// \param packets Receives the number of packets in a run
+/// \return 0 for success otherwise a negative value if the kernel couldn't be set up
+static int bench_run(const struct bench_kernel *kernel, const uint32_t sample_rate, const size_t packet_len,
+                     int64_t *ns, size_t *packets) {
+    static struct bench_state state;
+
+    memset(&state, 0, sizeof(state));
+    state.sample_rate = sample_rate;
+    state.packet_len = packet_len;
+    params_exchange_init(&state.ctx.params, &junk_params_defaults);
+    junk_dsp_init(&state.ctx);
+    telemetry_init(&state.ctx.telemetry, sample_rate);
+    state.waveform = waveform_create(NULL, "JunkMode", "JUNK", JUNK_MODE, "1.0.0", SR_24K);
+    if (state.waveform == NULL)
+        return -1;
+    waveform_set_context(state.waveform, &state.ctx);
+    waveform_register_meter(state.waveform, "junk-snr", -100.0f, 100.0f, DB);
+    waveform_register_meter(state.waveform, TELEMETRY_METER_DUTY, 0.0f, 100.0f, PERCENT);
+    for (size_t i = 0; i < packet_len; ++i)
+        state.in[i] = (float) i / (float) packet_len - 0.5F;
+    state.packet = (struct waveform_vita_packet) {
+        .stream_id = 0x20000000,
+        .num_samples = (uint16_t) packet_len,
+        .sample_rate = sample_rate,
+        .samples = state.in,
+    };
+
+    if (kernel->setup != NULL && kernel->setup(&state) != 0) {
+        waveform_destroy(state.waveform);
+        return -1;
+    }
+
+    *packets = BENCH_RUN_SAMPLES / packet_len;
+    *ns = INT64_MAX;
+
+    // One run untimed to warm the caches and branch predictors, then the timed runs.
+    for (unsigned int run = 0; run <= BENCH_RUNS; ++run) {
+        const int64_t start = bench_now_ns();
+        for (size_t i = 0; i < *packets; ++i)
+            kernel->run(&state);
+        const int64_t elapsed = bench_now_ns() - start;
+        if (run > 0 && elapsed < *ns)
+            *ns = elapsed;
+    }
+
+    if (kernel->teardown != NULL)
+        kernel->teardown(&state);
+    free(state.table);
+    waveform_destroy(state.waveform);
+    return 0;
+}
+
+/// \brief Measure one FEC codec.
+/// \param codec The codec
+/// \param state The codec's inputs, from bench_codec_setup
+/// \param ns Receives the fastest run's time in nanoseconds
+/// \param blocks Receives the number of blocks in a run
+static void bench_codec_run(const struct bench_codec *codec, struct bench_codec_state *state, int64_t *ns,
+                            size_t *blocks) {
+    *blocks = (BENCH_CODEC_RUN_BYTES + codec->bytes - 1) / codec->bytes;
+    *ns = INT64_MAX;
+
+    for (unsigned int run = 0; run <= BENCH_RUNS; ++run) {
+        const int64_t start = bench_now_ns();
+        for (size_t i = 0; i < *blocks; ++i)
+            codec->run(state);
+        const int64_t elapsed = bench_now_ns() - start;
+        if (run > 0 && elapsed < *ns)
+            *ns = elapsed;
+    }
+}
+
+/// \brief Print a usage message to the console
+/// @param progname The name of this program
+static void usage(const char *progname) {
+    fprintf(stderr, "Usage: %s [options]\n\n", progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -k <name>, --kernel=<name>         Only run kernels whose names contain name\n");
+    fprintf(stderr, "  -r <hz>, --rate=<hz>               Only run at this sample rate\n");
+    fprintf(stderr, "  -s <floats>, --size=<floats>       Only run with this packet size\n");
+    fprintf(stderr, "  -c, --csv                          Print comma separated values\n");
+}
+
+/// \brief The command line parameters
+static const struct option bench_options[] = {
+    {.name = "kernel", .has_arg = required_argument, .flag = NULL, .val = 'k'},
+    {.name = "rate", .has_arg = required_argument, .flag = NULL, .val = 'r'},
+    {.name = "size", .has_arg = required_argument, .flag = NULL, .val = 's'},
+    {.name = "csv", .has_arg = no_argument, .flag = NULL, .val = 'c'},
+    {0} // Sentinel
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+int main(const int argc, char **argv) {
+    const char *only_kernel = NULL;
+    unsigned long only_rate = 0;
+    unsigned long only_size = 0;
+    bool csv = false;
+
+    while (1) {
+        int indexptr;
+        const int option = getopt_long(argc, argv, "k:r:s:c", bench_options, &indexptr);
+
+        if (option == -1)
+            break;
+
+        switch (option) { // NOLINT(*-multiway-paths-covered)
+            case 'k':
+                only_kernel = optarg;
+                break;
+            case 'r':
+                only_rate = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                only_size = strtoul(optarg, NULL, 10);
+                if (only_size == 0 || only_size > BENCH_MAX_PACKET || only_size % 2 != 0) {
+                    fprintf(stderr, "Packet size must be even and at most %d\n", BENCH_MAX_PACKET);
+                    exit(1);
+                }
+                break;
+            case 'c':
+                csv = true;
+                break;
+            default:
+                usage(basename(argv[0]));
+                exit(1);
+        }
+    }
+
+    if (csv)
+        printf("kernel,sample_rate,packet_len,ns_per_sample,packets_per_sec,realtime_factor\n");
+    else
+        printf("%-14s %10s %6s %10s %14s %12s\n", "kernel", "rate", "size", "ns/sample", "packets/s", "x realtime");
+
+    for (size_t k = 0; k < ARRAY_SIZE(bench_kernels); ++k) {
+        const struct bench_kernel *kernel = &bench_kernels[k];
+        if (only_kernel != NULL && strstr(kernel->name, only_kernel) == NULL)
+            continue;
+
+        for (size_t r = 0; r < ARRAY_SIZE(bench_rates); ++r) {
+            const uint32_t rate = bench_rates[r].hz;
+            if (only_rate != 0 && rate != only_rate)
+                continue;
+
+            for (size_t s = 0; s < ARRAY_SIZE(bench_sizes); ++s) {
+                const size_t size = bench_sizes[s];
+                if (only_size != 0 && size != only_size)
+                    continue;
+
+                int64_t ns;
+                size_t packets;
+                if (bench_run(kernel, rate, size, &ns, &packets) != 0) {
+                    fprintf(stderr, "Unable to set up %s at %u Hz\n", kernel->name, rate);
+                    continue;
+                }
+
+                // Real time is two floats per sample period, one for each of the pair.
+                const double ns_per_sample = (double) ns / (double) (packets * size);
+                const double packets_per_sec = (double) packets * NS_PER_SEC / (double) ns;
+                const double realtime = (double) NS_PER_SEC / (2.0 * rate) / ns_per_sample;
+
+                if (csv)
+                    printf("%s,%u,%zu,%.3f,%.0f,%.1f\n", kernel->name, rate, size, ns_per_sample, packets_per_sec,
+                           realtime);
+                else
+                    printf("%-14s %10u %6zu %10.3f %14.0f %12.1f\n", kernel->name, rate, size, ns_per_sample,
+                           packets_per_sec, realtime);
+            }
+        }
+    }
+
+    static struct bench_codec_state codec_state;
+    bool codec_header = false;
+    bench_codec_setup(&codec_state);
+
+    for (size_t c = 0; c < ARRAY_SIZE(bench_codecs); ++c) {
+        const struct bench_codec *codec = &bench_codecs[c];
+        if (only_kernel != NULL && strstr(codec->name, only_kernel) == NULL)
+            continue;
+
+        if (!codec_header) {
+            if (csv)
+                printf("\ncodec,block_bytes,ns_per_byte,mbit_per_sec,link_factor\n");
+            else
+                printf("\n%-14s %10s %10s %14s %12s\n", "codec", "bytes", "ns/byte", "Mbit/s", "x link");
+            codec_header = true;
+        }
+
+        int64_t ns;
+        size_t blocks;
+        bench_codec_run(codec, &codec_state, &ns, &blocks);
+
+        const double ns_per_byte = (double) ns / (double) (blocks * codec->bytes);
+        const double mbit_per_sec = 8.0 * 1000.0 / ns_per_byte;
+        const double link = mbit_per_sec * 1e6 / BENCH_LINK_BPS;
+
+        if (csv)
+            printf("%s,%zu,%.3f,%.1f,%.0f\n", codec->name, codec->bytes, ns_per_byte, mbit_per_sec, link);
+        else
+            printf("%-14s %10zu %10.3f %14.1f %12.0f\n", codec->name, codec->bytes, ns_per_byte, mbit_per_sec, link);
+    }
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file capture.c
+/// @brief Compact binary capture files of VITA-49 sample packets for offline replay
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "capture.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The stdio buffer for a capture being written.  At 24ksps a packet is about 1KiB, so this makes one write(2) every
+// few hundred packets rather than one per packet.
+#define CAPTURE_BUFFER_SIZE (256 * 1024)
+
+// ****************************************
+// Global Functions
+// ****************************************
+int capture_create(struct capture *capture, const char *path, const uint32_t sample_rate) {
+    memset(capture, 0, sizeof(*capture));
+    capture->sample_rate = sample_rate;
+
+    capture->file = fopen(path, "wb");
+    if (capture->file == NULL)
+        return -1;
+    setvbuf(capture->file, NULL, _IOFBF, CAPTURE_BUFFER_SIZE);
+
+    const struct capture_file_header header = {
+        .magic = CAPTURE_MAGIC,
+        .version = CAPTURE_VERSION,
+        .sample_rate = sample_rate,
+    };
+    if (fwrite(&header, sizeof(header), 1, capture->file) != 1) {
+        const int saved_errno = errno;
+        fclose(capture->file);
+        capture->file = NULL;
+        errno = saved_errno;
+        return -1;
+    }
+
+    return 0;
+}
+
+void capture_write(struct capture *capture, const enum capture_direction direction, const uint8_t flags,
+                   const struct waveform_vita_packet *packet) {
+    if (capture->file == NULL || capture->failed)
+        return;
+
+    const struct capture_record record = {
+        .direction = (uint8_t) direction,
+        .flags = flags,
+        .packet_count = get_packet_count(packet),
+        .stream_id = get_stream_id(packet),
+        .class_id = get_class_id(packet),
+        .ts_int = get_packet_ts_int(packet),
+        .num_samples = get_packet_len(packet),
+        .ts_frac = get_packet_ts_frac(packet),
+    };
+
+    if (fwrite(&record, sizeof(record), 1, capture->file) != 1 ||
+        fwrite(get_packet_data(packet), sizeof(float), record.num_samples, capture->file) != record.num_samples) {
+        fprintf(stderr, "Capture write failed after %llu packets, no longer recording\n",
+                (unsigned long long) capture->records);
+        capture->failed = true;
+        return;
+    }
+
+    ++capture->records;
+}
+
+void capture_flush(struct capture *capture) {
+    if (capture->file != NULL)
+        fflush(capture->file);
+}
+
+int capture_open(struct capture *capture, const char *path) {
+    memset(capture, 0, sizeof(*capture));
+
+    capture->file = fopen(path, "rb");
+    if (capture->file == NULL)
+        return -1;
+
+    struct capture_file_header header;
+    if (fread(&header, sizeof(header), 1, capture->file) != 1 || header.magic != CAPTURE_MAGIC ||
+        header.version != CAPTURE_VERSION || header.sample_rate == 0) {
+        fclose(capture->file);
+        capture->file = NULL;
+        return -1;
+    }
+
+    capture->sample_rate = header.sample_rate;
+    return 0;
+}
+
+int capture_read(struct capture *capture, struct capture_record *record, float *samples) {
+    if (fread(record, sizeof(*record), 1, capture->file) != 1)
+        return ferror(capture->file) ? -1 : 0;
+
+    if (record->num_samples > CAPTURE_MAX_SAMPLES || record->direction > CAPTURE_TX)
+        return -1;
+
+    if (fread(samples, sizeof(float), record->num_samples, capture->file) != record->num_samples)
+        return -1;
+
+    ++capture->records;
+    return 1;
+}
+
+int capture_rewind(struct capture *capture) {
+    capture->records = 0;
+    return fseek(capture->file, sizeof(struct capture_file_header), SEEK_SET);
+}
+
+int capture_close(struct capture *capture) {
+    if (capture->file == NULL)
+        return 0;
+
+    const int ret = fclose(capture->file);
+    capture->file = NULL;
+    return ret != 0 || capture->failed ? -1 : 0;
+}
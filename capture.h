@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file capture.h
+/// @brief Compact binary capture files of VITA-49 sample packets for offline replay
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_CAPTURE_H
+#define WAVEFORM_EXAMPLE_CAPTURE_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The magic number at the start of every capture file, "WFCAPTUR" in little endian
+#define CAPTURE_MAGIC 0x5255545041434657ULL
+
+/// \brief The capture file format version
+#define CAPTURE_VERSION 1
+
+/// \brief The most samples a single record may hold.  This is well above anything the radio sends in one packet.
+#define CAPTURE_MAX_SAMPLES 4096
+
+/// \brief Set in capture_record.flags if the waveform was transmitting when the packet arrived
+#define CAPTURE_FLAG_TX 0x01
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Which data callback a packet was delivered to
+enum capture_direction {
+    CAPTURE_RX = 0,
+    CAPTURE_TX = 1,
+};
+
+/// \brief The file header.  All fields are in host byte order; a capture is meant to be replayed on the same kind of
+/// machine that recorded it.
+struct capture_file_header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t sample_rate;
+};
+
+/// \brief The header of each record.  It is followed by num_samples floats of sample data.
+struct capture_record {
+    uint8_t direction;
+    uint8_t flags;
+    uint8_t packet_count;
+    uint8_t reserved;
+    uint32_t stream_id;
+    uint64_t class_id;
+    uint32_t ts_int;
+    uint32_t num_samples;
+    uint64_t ts_frac;
+};
+
+/// \brief An open capture file
+struct capture {
+    FILE *file;
+    uint32_t sample_rate;
+    uint64_t records;
+    bool failed;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Create a capture file for writing.
+/// \param capture The capture to initialize
+/// \param path The file to create, truncating it if it exists
+/// \param sample_rate The sample rate of the packets in Hz, recorded in the header for replay
+/// \return 0 for success otherwise a negative value with errno set
+int capture_create(struct capture *capture, const char *path, uint32_t sample_rate);
+
+/// \brief Append a packet to a capture file.  This is called from the data callbacks, which the library runs one at
+/// a time, so a capture must only be written from those.  Output is buffered so that most calls don't make a system
+/// call.  After a write error the capture stops recording and every later call does nothing.
+/// \param capture The capture
+/// \param direction Which callback the packet was delivered to
+/// \param flags CAPTURE_FLAG_* values
+/// \param packet The packet as given to the data callback
+void capture_write(struct capture *capture, enum capture_direction direction, uint8_t flags,
+                   const struct waveform_vita_packet *packet);
+
+/// \brief Push everything written so far out to the file.  This may be called from any thread; stdio serializes it
+/// against capture_write.
+/// \param capture The capture
+void capture_flush(struct capture *capture);
+
+/// \brief Open a capture file for reading.
+/// \param capture The capture to initialize
+/// \param path The file to open
+/// \return 0 for success otherwise a negative value if the file can't be opened or isn't a capture
+int capture_open(struct capture *capture, const char *path);
+
+/// \brief Read the next record from a capture opened with capture_open.
+/// \param capture The capture
+/// \param record Receives the record header
+/// \param samples Receives the samples, which must have room for CAPTURE_MAX_SAMPLES
+/// \return 1 if a record was read, 0 at the end of the file or a negative value if the file is corrupt
+int capture_read(struct capture *capture, struct capture_record *record, float *samples);
+
+/// \brief Go back to the first record of a capture opened with capture_open.
+/// \param capture The capture
+/// \return 0 for success otherwise a negative value
+int capture_rewind(struct capture *capture);
+
+/// \brief Flush and close a capture.
+/// \param capture The capture
+/// \return 0 for success otherwise a negative value if any data could not be written
+int capture_close(struct capture *capture);
+
+#endif // WAVEFORM_EXAMPLE_CAPTURE_H
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file commands.c
+/// @brief Table driven waveform commands and lock-free parameter hand-off to the DSP callbacks
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "commands.h"
+#include "kwargs.h"
+#include "params_hash.h"
+#include "perfect_hash.h"
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+// Describes a single parameter: where it lives in struct junk_params, what type it is and what values it may take.
+struct param_descriptor {
+    const char *name;
+    enum param_type type;
+    size_t offset;
+    double min;
+    double max;
+    const char *const *names;
+};
+
+// ****************************************
+// Static Variables
+// ****************************************
+
+// The names accepted for "set submode=...", indexed by enum junk_submode
+static const char *const junk_submode_names[JUNK_SUBMODE_COUNT] = {
+    [JUNK_SUBMODE_TONE] = "tone",
+    [JUNK_SUBMODE_MUTE] = "mute",
+    [JUNK_SUBMODE_FSK] = "fsk",
+    [JUNK_SUBMODE_OFDM] = "ofdm",
+};
+
+// The names accepted for "set fec=...", indexed by enum junk_fec
+static const char *const junk_fec_names[JUNK_FEC_COUNT] = {
+    [JUNK_FEC_OFF] = "off",
+    [JUNK_FEC_ON] = "on",
+};
+
+// The parameter table, in the same order as commands.def so that the indices in the generated hash line up.
+static const struct param_descriptor params_table[] = {
+#define PARAM(name, type, min, max, names) {#name, type, offsetof(struct junk_params, name), (min), (max), (names)},
+#include "commands.def"
+#undef PARAM
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Publish the staging parameters to the reader.  Only called from the command callbacks.
+/// \param exchange The exchange to publish to
+static void params_exchange_publish(struct params_exchange *exchange) {
+    exchange->slots[exchange->back] = exchange->staging;
+    exchange->back = atomic_exchange_explicit(&exchange->middle, exchange->back | PARAMS_FRESH,
+                                              memory_order_acq_rel) & ~PARAMS_FRESH;
+}
+
+/// \brief Parse a single value into a parameter field.
+/// \param param The descriptor of the parameter
+/// \param value The NUL terminated value text
+/// \param params The parameter structure to store into
+/// \return COMMAND_OK for success otherwise one of enum command_error
+static int param_parse_value(const struct param_descriptor *param, const char *value, struct junk_params *params) {
+    char *field = (char *) params + param->offset;
+    char *end;
+
+    if (*value == '\0')
+        return COMMAND_ERR_BAD_VALUE;
+
+    switch (param->type) {
+        case PARAM_ENUM:
+            for (uint32_t i = 0; i <= (uint32_t) param->max; ++i) {
+                if (strcmp(value, param->names[i]) == 0) {
+                    memcpy(field, &i, sizeof(i));
+                    return COMMAND_OK;
+                }
+            }
+            return COMMAND_ERR_BAD_VALUE;
+        case PARAM_UINT: {
+            errno = 0;
+            const unsigned long parsed = strtoul(value, &end, 10);
+            if (errno != 0 || *end != '\0' || value[0] == '-')
+                return COMMAND_ERR_BAD_VALUE;
+            if (parsed < param->min || parsed > param->max)
+                return COMMAND_ERR_OUT_OF_RANGE;
+            const uint32_t stored = (uint32_t) parsed;
+            memcpy(field, &stored, sizeof(stored));
+            return COMMAND_OK;
+        }
+        case PARAM_FLOAT: {
+            errno = 0;
+            const float parsed = strtof(value, &end);
+            if (errno != 0 || *end != '\0' || isnan(parsed))
+                return COMMAND_ERR_BAD_VALUE;
+            if (parsed < param->min || parsed > param->max)
+                return COMMAND_ERR_OUT_OF_RANGE;
+            memcpy(field, &parsed, sizeof(parsed));
+            return COMMAND_OK;
+        }
+        default:
+            return COMMAND_ERR_BAD_VALUE;
+    }
+}
+
+/// \brief Print a single parameter value
+/// \param param The descriptor of the parameter
+/// \param params The parameter structure to read from
+static void param_print(const struct param_descriptor *param, const struct junk_params *params) {
+    const char *field = (const char *) params + param->offset;
+
+    switch (param->type) {
+        case PARAM_ENUM: {
+            uint32_t value;
+            memcpy(&value, field, sizeof(value));
+            fprintf(stderr, "%s=%s\n", param->name, param->names[value]);
+            break;
+        }
+        case PARAM_UINT: {
+            uint32_t value;
+            memcpy(&value, field, sizeof(value));
+            fprintf(stderr, "%s=%u\n", param->name, value);
+            break;
+        }
+        case PARAM_FLOAT: {
+            float value;
+            memcpy(&value, field, sizeof(value));
+            fprintf(stderr, "%s=%g\n", param->name, value);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/// \brief The "set" command callback.  For example "slice 1 waveform_cmd set submode=tone gain=0.25".
+/// All of the arguments are parsed and validated before any of them take effect, and they then reach the data
+/// callbacks together as a single update.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the waveform command
+/// \param argv An array of the arguments in the waveform command
+/// \param arg The waveform's struct params_exchange
+/// \return 0 for success otherwise one of enum command_error
+static int set_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc, char *argv[],
+                       void *arg) {
+    struct params_exchange *exchange = arg;
+
+    if (argc < 2)
+        return COMMAND_ERR_SYNTAX;
+
+    struct junk_params params = exchange->staging;
+    const int ret = params_parse(&params, argc - 1, argv + 1);
+    if (ret != COMMAND_OK)
+        return ret;
+
+    exchange->staging = params;
+    params_exchange_publish(exchange);
+    return COMMAND_OK;
+}
+
+/// \brief The "get" command callback.  Prints the named parameters, or all of them if none are named.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the waveform command
+/// \param argv An array of the arguments in the waveform command
+/// \param arg The waveform's struct params_exchange
+/// \return 0 for success otherwise one of enum command_error
+static int get_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc, char *argv[],
+                       void *arg) {
+    const struct params_exchange *exchange = arg;
+
+    if (argc < 2) {
+        for (size_t i = 0; i < sizeof(params_table) / sizeof(params_table[0]); ++i)
+            param_print(&params_table[i], &exchange->staging);
+        return COMMAND_OK;
+    }
+
+    for (unsigned int i = 1; i < argc; ++i) {
+        const int index = params_lookup(argv[i], strlen(argv[i]));
+        if (index < 0)
+            return COMMAND_ERR_UNKNOWN_PARAM;
+        param_print(&params_table[index], &exchange->staging);
+    }
+
+    return COMMAND_OK;
+}
+
+// ****************************************
+// Global Variables
+// ****************************************
+const struct junk_command junk_commands[] = {
+    {.name = "set", .handler = set_command},
+    {.name = "get", .handler = get_command},
+};
+const size_t junk_commands_count = sizeof(junk_commands) / sizeof(junk_commands[0]);
+
+const struct junk_params junk_params_defaults = {
+    .submode = JUNK_SUBMODE_TONE,
+    .baud = 300,
+    .gain = 0.5F,
+    .fec = JUNK_FEC_OFF,
+    .shift = 0.0F,
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+void params_exchange_init(struct params_exchange *exchange, const struct junk_params *params) {
+    exchange->staging = *params;
+    for (int i = 0; i < 3; ++i)
+        exchange->slots[i] = *params;
+    exchange->back = 0;
+    exchange->front = 1;
+    atomic_init(&exchange->middle, 2U);
+}
+
+const struct junk_params *params_exchange_current(const struct params_exchange *exchange) {
+    return &exchange->staging;
+}
+
+int params_lookup(const char *name, const size_t len) {
+    // Every known name hashes to its own slot, so a single comparison confirms a hit.
+    const int index = params_hash_slots[perfect_hash_slot(PARAMS_HASH_SEED, PARAMS_HASH_BITS, name, len)];
+    if (index < 0 || strncmp(params_table[index].name, name, len) != 0 || params_table[index].name[len] != '\0')
+        return -1;
+
+    return index;
+}
+
+int params_parse(struct junk_params *params, const unsigned int argc, char *argv[]) {
+    struct junk_params parsed = *params;
+
+    for (unsigned int i = 0; i < argc; ++i) {
+        struct kwarg kwarg;
+        if (!kwarg_split(argv[i], &kwarg))
+            return COMMAND_ERR_SYNTAX;
+
+        const int index = params_lookup(kwarg.key, kwarg.key_len);
+        if (index < 0)
+            return COMMAND_ERR_UNKNOWN_PARAM;
+
+        const int ret = param_parse_value(&params_table[index], kwarg.value, &parsed);
+        if (ret != COMMAND_OK)
+            return ret;
+    }
+
+    *params = parsed;
+    return COMMAND_OK;
+}
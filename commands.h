@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file commands.h
+/// @brief Table driven waveform commands and lock-free parameter hand-off to the DSP callbacks
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_COMMANDS_H
+#define WAVEFORM_EXAMPLE_COMMANDS_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The submodes selectable with "set submode=..."
+enum junk_submode {
+    JUNK_SUBMODE_TONE,
+    JUNK_SUBMODE_MUTE,
+    JUNK_SUBMODE_FSK,           ///< The FSK modem, at the "baud" parameter's rate.  See fsk.h.
+    JUNK_SUBMODE_OFDM,          ///< The OFDM modem.  See ofdm.h.
+    JUNK_SUBMODE_COUNT
+};
+
+/// \brief Whether the modems' bytes go through forward error correction, selectable with "set fec=..."
+enum junk_fec {
+    JUNK_FEC_OFF,
+    JUNK_FEC_ON,                ///< Frames with a CRC, Reed-Solomon and a convolutional code.  See fec.h.
+    JUNK_FEC_COUNT
+};
+
+/// \brief The value types a parameter may have
+enum param_type {
+    PARAM_ENUM,
+    PARAM_UINT,
+    PARAM_FLOAT
+};
+
+// The "fresh" flag in params_exchange.middle, set when the writer has published a slot the reader hasn't picked up.
+#define PARAMS_FRESH 4U
+
+// The C type used to store each parameter type in struct junk_params
+#define PARAM_CTYPE_PARAM_ENUM uint32_t
+#define PARAM_CTYPE_PARAM_UINT uint32_t
+#define PARAM_CTYPE_PARAM_FLOAT float
+
+/// \brief The waveform parameters.  One field per entry in commands.def.
+struct junk_params {
+#define PARAM(name, type, min, max, names) PARAM_CTYPE_##type name;
+#include "commands.def"
+#undef PARAM
+};
+
+/// \brief A triple buffer handing parameters from the command callbacks to the data callbacks.
+/// The command callbacks are the only writer and the data callbacks, which the library runs one at a time on its high
+/// priority workqueue, are the only reader.  The writer never waits on the reader and vice versa; a reader always sees
+/// a complete set of parameters from a single "set" command.
+struct params_exchange {
+    struct junk_params slots[3];
+    struct junk_params staging;
+    unsigned int back;
+    unsigned int front;
+    _Atomic unsigned int middle;
+};
+
+/// \brief An entry in the table of commands we register with the library
+struct junk_command {
+    const char *name;
+    waveform_cmd_cb_t handler;
+};
+
+/// \brief Error codes returned to the client from the command callbacks
+enum command_error {
+    COMMAND_OK = 0,
+    COMMAND_ERR_SYNTAX = 0x50000001,
+    COMMAND_ERR_UNKNOWN_PARAM = 0x50000002,
+    COMMAND_ERR_BAD_VALUE = 0x50000003,
+    COMMAND_ERR_OUT_OF_RANGE = 0x50000004,
+    COMMAND_ERR_NOT_READY = 0x50000005
+};
+
+// ****************************************
+// Global Variables
+// ****************************************
+
+/// \brief The commands to register with waveform_register_command_cb.  The per-callback argument for each must be the
+/// waveform's struct params_exchange.
+extern const struct junk_command junk_commands[];
+extern const size_t junk_commands_count;
+
+/// \brief The parameters a freshly started waveform uses
+extern const struct junk_params junk_params_defaults;
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a parameter exchange so that both sides see the given parameters.
+/// \param exchange The exchange to initialize
+/// \param params The initial parameters
+void params_exchange_init(struct params_exchange *exchange, const struct junk_params *params);
+
+/// \brief Get the most recently published parameters.  Only to be called from the data callbacks.
+/// The returned pointer stays valid and unchanged until the next call.
+/// \param exchange The exchange to read from
+/// \return The current parameters
+static inline const struct junk_params *params_exchange_read(struct params_exchange *exchange) {
+    if (atomic_load_explicit(&exchange->middle, memory_order_relaxed) & PARAMS_FRESH)
+        exchange->front = atomic_exchange_explicit(&exchange->middle, exchange->front,
+                                                   memory_order_acq_rel) & ~PARAMS_FRESH;
+    return &exchange->slots[exchange->front];
+}
+
+/// \brief Get the parameters as last set by the command callbacks.  Only to be called from the command callbacks or
+/// when no callbacks can run.
+/// \param exchange The exchange to read from
+/// \return The current parameters
+const struct junk_params *params_exchange_current(const struct params_exchange *exchange);
+
+/// \brief Look up a parameter by name.
+/// \param name The start of the name; it need not be NUL terminated
+/// \param len The length of the name
+/// \return The index of the parameter in commands.def or -1 if there is no such parameter
+int params_lookup(const char *name, size_t len);
+
+/// \brief Apply a set of key=value arguments to a parameter structure.  Either every argument is applied or, on error,
+/// none are.
+/// \param params The parameters to update
+/// \param argc The number of arguments
+/// \param argv The arguments, each of the form key=value
+/// \return COMMAND_OK for success otherwise one of enum command_error
+int params_parse(struct junk_params *params, unsigned int argc, char *argv[]);
+
+#endif // WAVEFORM_EXAMPLE_COMMANDS_H
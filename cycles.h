@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file cycles.h
+/// @brief A cheap cycle counter for benchmarking
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_CYCLES_H
+#define WAVEFORM_EXAMPLE_CYCLES_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief What cycles_now counts on this machine, for printing alongside the numbers
+#if defined(__x86_64__) || defined(__i386__)
+#define CYCLES_UNIT "TSC cycles"
+#elif defined(__aarch64__)
+#define CYCLES_UNIT "CNTVCT ticks"
+#else
+#define CYCLES_UNIT "ns"
+#endif
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Read the cheapest fine-grained counter available.
+/// On x86 this is the time stamp counter.  On ARM64 the core cycle counter isn't readable from user space, so this is
+/// the generic timer instead, which ticks at a fixed rate (typically tens of MHz) independent of the core clock.
+/// Elsewhere it falls back to the monotonic clock in nanoseconds.  Only differences between two readings on the same
+/// thread are meaningful.
+/// \return The current counter value
+static inline uint64_t cycles_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t value;
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(value));
+    return value;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+#endif
+}
+
+#endif // WAVEFORM_EXAMPLE_CYCLES_H
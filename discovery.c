@@ -0,0 +1,318 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file discovery.c
+/// @brief Fast radio discovery using a cached address and parallel probing
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <arpa/inet.h>
+#include <errno.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "discovery.h"
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+// State shared between the caller of discovery_find_radio and all of the threads racing to find the radio.  The
+// waveform_discover_radio call cannot be interrupted, so the caller may well return long before every thread has
+// finished.  The structure is therefore reference counted and freed by whoever drops the last reference.
+struct discovery_race {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct sockaddr_in winner;
+    bool found;
+    unsigned int pending;
+    unsigned int refs;
+    struct timespec deadline;
+};
+
+// Arguments for a single probe thread.
+struct discovery_probe {
+    struct discovery_race *race;
+    struct sockaddr_in addr;
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Drop a reference to the race, freeing it if this was the last one.  Must be called with the lock held; the
+/// lock is released on return.
+/// \param race The race to release
+static void discovery_race_put(struct discovery_race *race) {
+    const bool last = --race->refs == 0;
+    pthread_mutex_unlock(&race->lock);
+
+    if (last) {
+        pthread_cond_destroy(&race->cond);
+        pthread_mutex_destroy(&race->lock);
+        free(race);
+    }
+}
+
+/// \brief Report the outcome of one of the racing threads and drop its reference.
+/// \param race The race to report to
+/// \param addr The address that answered or NULL if this racer gave up
+static void discovery_race_finish(struct discovery_race *race, const struct sockaddr_in *addr) {
+    pthread_mutex_lock(&race->lock);
+    if (addr != NULL && !race->found) {
+        race->winner = *addr;
+        race->found = true;
+    }
+    --race->pending;
+    pthread_cond_signal(&race->cond);
+    discovery_race_put(race);
+}
+
+/// \brief Milliseconds left until the race deadline, clamped to zero.
+/// \param race The race whose deadline to check
+/// \return The number of milliseconds remaining
+static int discovery_remaining_ms(const struct discovery_race *race) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    const long long ms = (race->deadline.tv_sec - now.tv_sec) * 1000LL +
+                         (race->deadline.tv_nsec - now.tv_nsec) / 1000000LL;
+    if (ms <= 0)
+        return 0;
+    return ms > INT_MAX ? INT_MAX : (int) ms;
+}
+
+/// \brief Thread body probing a single candidate address.  A non-blocking connect is started and we wait until either
+/// it completes or the race deadline passes.  A radio that is up will accept the connection on its API port almost
+/// immediately.
+/// \param arg The discovery_probe describing the candidate
+/// \return Always NULL
+static void *discovery_probe_thread(void *arg) {
+    struct discovery_probe *probe = arg;
+    const struct sockaddr_in *answered = NULL;
+
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd != -1) {
+        int ret = connect(fd, (const struct sockaddr *) &probe->addr, sizeof(probe->addr));
+        if (ret == -1 && errno == EINPROGRESS) {
+            struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+            if (poll(&pfd, 1, discovery_remaining_ms(probe->race)) == 1) {
+                int error = 0;
+                socklen_t error_len = sizeof(error);
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &error_len);
+                ret = error == 0 ? 0 : -1;
+            }
+        }
+
+        if (ret == 0)
+            answered = &probe->addr;
+        close(fd);
+    }
+
+    discovery_race_finish(probe->race, answered);
+    free(probe);
+    return NULL;
+}
+
+/// \brief Thread body running the library's broadcast discovery.
+/// \param arg The discovery_race to report to
+/// \return Always NULL
+static void *discovery_broadcast_thread(void *arg) {
+    struct discovery_race *race = arg;
+
+    const int remaining = discovery_remaining_ms(race);
+    const struct timeval timeout = {
+        .tv_sec = remaining / 1000,
+        .tv_usec = (remaining % 1000) * 1000
+    };
+
+    struct sockaddr_in *addr = waveform_discover_radio(&timeout);
+    discovery_race_finish(race, addr);
+    free(addr);
+    return NULL;
+}
+
+/// \brief Start a detached racer thread, accounting for it in the race.
+/// \param race The race the thread takes part in
+/// \param body The thread body
+/// \param arg The argument to the thread body
+/// \return 0 for success otherwise a negative value if the thread could not be created
+static int discovery_race_spawn(struct discovery_race *race, void *(*body)(void *), void *arg) {
+    pthread_mutex_lock(&race->lock);
+    ++race->pending;
+    ++race->refs;
+    pthread_mutex_unlock(&race->lock);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    pthread_t thread;
+    const int ret = pthread_create(&thread, &attr, body, arg);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        pthread_mutex_lock(&race->lock);
+        --race->pending;
+        --race->refs;
+        pthread_mutex_unlock(&race->lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+struct sockaddr_in *discovery_find_radio(const struct sockaddr_in *candidates, const size_t num_candidates,
+                                         const bool discover, const struct timeval *timeout) {
+    struct discovery_race *race = calloc(1, sizeof(*race));
+    if (race == NULL)
+        return NULL;
+
+    // The deadline is kept on the monotonic clock so that a clock step during startup (e.g. NTP syncing on the radio)
+    // cannot stretch or cut short the wait.
+    pthread_condattr_t cond_attr;
+    pthread_condattr_init(&cond_attr);
+    pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&race->cond, &cond_attr);
+    pthread_condattr_destroy(&cond_attr);
+    pthread_mutex_init(&race->lock, NULL);
+    race->refs = 1;
+
+    clock_gettime(CLOCK_MONOTONIC, &race->deadline);
+    race->deadline.tv_sec += timeout->tv_sec;
+    race->deadline.tv_nsec += timeout->tv_usec * 1000L;
+    if (race->deadline.tv_nsec >= 1000000000L) {
+        race->deadline.tv_sec += 1;
+        race->deadline.tv_nsec -= 1000000000L;
+    }
+
+    for (size_t i = 0; i < num_candidates; ++i) {
+        struct discovery_probe *probe = malloc(sizeof(*probe));
+        if (probe == NULL)
+            continue;
+
+        probe->race = race;
+        probe->addr = candidates[i];
+        if (discovery_race_spawn(race, discovery_probe_thread, probe) != 0)
+            free(probe);
+    }
+
+    if (discover)
+        discovery_race_spawn(race, discovery_broadcast_thread, race);
+
+    struct sockaddr_in *result = NULL;
+
+    pthread_mutex_lock(&race->lock);
+    while (!race->found && race->pending > 0) {
+        if (pthread_cond_timedwait(&race->cond, &race->lock, &race->deadline) == ETIMEDOUT)
+            break;
+    }
+
+    if (race->found) {
+        result = malloc(sizeof(*result));
+        if (result != NULL)
+            *result = race->winner;
+    }
+    discovery_race_put(race);
+
+    return result;
+}
+
+int discovery_cache_default_path(char *path, const size_t len) {
+    const char *xdg = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    int ret;
+
+    if (xdg != NULL && xdg[0] != '\0')
+        ret = snprintf(path, len, "%s/waveform-example/last-radio", xdg);
+    else if (home != NULL && home[0] != '\0')
+        ret = snprintf(path, len, "%s/.cache/waveform-example/last-radio", home);
+    else
+        ret = snprintf(path, len, "/tmp/waveform-example-last-radio");
+
+    return ret < 0 || (size_t) ret >= len ? -1 : 0;
+}
+
+int discovery_cache_load(const char *path, struct sockaddr_in *addr) {
+    FILE *cache = fopen(path, "r");
+    if (cache == NULL)
+        return -1;
+
+    char host[INET_ADDRSTRLEN];
+    unsigned int port;
+    const int fields = fscanf(cache, "%15s %u", host, &port);
+    fclose(cache);
+
+    if (fields != 2 || port == 0 || port > 65535)
+        return -1;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons((uint16_t) port);
+    if (inet_pton(AF_INET, host, &addr->sin_addr) != 1)
+        return -1;
+
+    return 0;
+}
+
+int discovery_cache_save(const char *path, const struct sockaddr_in *addr) {
+    // Make sure the directory holding the cache exists, creating each missing component along the way like mkdir -p.
+    char dir[PATH_MAX];
+    if (snprintf(dir, sizeof(dir), "%s", path) >= (int) sizeof(dir))
+        return -1;
+    for (char *slash = strchr(dir + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(dir, 0755);
+        *slash = '/';
+    }
+
+    char tmp_path[PATH_MAX];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%d", path, (int) getpid()) >= (int) sizeof(tmp_path))
+        return -1;
+
+    FILE *cache = fopen(tmp_path, "w");
+    if (cache == NULL)
+        return -1;
+
+    char host[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr->sin_addr, host, sizeof(host));
+    fprintf(cache, "%s %u\n", host, ntohs(addr->sin_port));
+
+    if (fclose(cache) != 0 || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
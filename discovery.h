@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file discovery.h
+/// @brief Fast radio discovery using a cached address and parallel probing
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_DISCOVERY_H
+#define WAVEFORM_EXAMPLE_DISCOVERY_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <netinet/in.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Find a radio by racing a set of candidate addresses against each other and, optionally, against discovery.
+/// Every candidate is probed with a TCP connect to its API port in its own thread while waveform_discover_radio runs in
+/// another.  The first one to answer wins and the rest are abandoned; they clean up after themselves in the
+/// background.
+/// \param candidates An array of addresses to probe, including their port.  May be NULL if num_candidates is 0.
+/// \param num_candidates The number of entries in candidates
+/// \param discover Whether to also listen for discovery broadcasts
+/// \param timeout The longest to wait for any answer
+/// \return A newly allocated address of the radio that must be released with free(), or NULL if nothing answered
+struct sockaddr_in *discovery_find_radio(const struct sockaddr_in *candidates, size_t num_candidates, bool discover,
+                                         const struct timeval *timeout);
+
+/// \brief Determine where the last-known radio address is kept.
+/// This is $XDG_CACHE_HOME/waveform-example/last-radio, falling back to ~/.cache and finally to /tmp when no home
+/// directory is available, as is the case on the radio itself.
+/// \param path A buffer to receive the path
+/// \param len The size of the buffer
+/// \return 0 for success otherwise a negative value if the path does not fit
+int discovery_cache_default_path(char *path, size_t len);
+
+/// \brief Load the last-known radio address from the cache.
+/// \param path The path of the cache file
+/// \param addr The address to fill in
+/// \return 0 for success otherwise a negative value if there is no usable cached address
+int discovery_cache_load(const char *path, struct sockaddr_in *addr);
+
+/// \brief Save the radio address to the cache so that the next start can try it first.
+/// The file is replaced atomically so a crash mid-write never leaves a corrupt cache behind.
+/// \param path The path of the cache file
+/// \param addr The address to save
+/// \return 0 for success otherwise a negative value on error
+int discovery_cache_save(const char *path, const struct sockaddr_in *addr);
+
+#endif // WAVEFORM_EXAMPLE_DISCOVERY_H
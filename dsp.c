@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file dsp.c
+/// @brief Chains of DSP stages, with elementwise stages fused into a single pass at compile time
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "simd.h"
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Keep the first float of each sample, packed together at the start of out.  Working forwards, each vector
+/// stored is at or before the two it was loaded from, so out may be the same as in.
+/// \param in The samples
+/// \param out Receives one float for each sample
+/// \param samples The number of samples
+static void dsp_mono_pack(const float *in, float *out, const size_t samples) {
+    size_t i = 0;
+    for (; i + SIMD_LANES <= samples; i += SIMD_LANES) {
+        const simd_v4f a = simd_load(in + DSP_FLOATS_PER_SAMPLE * i);
+        const simd_v4f b = simd_load(in + DSP_FLOATS_PER_SAMPLE * i + SIMD_LANES);
+        simd_store(out + i, __builtin_shuffle(a, b, (simd_v4i) {0, 2, 4, 6}));
+    }
+    for (; i < samples; ++i)
+        out[i] = in[DSP_FLOATS_PER_SAMPLE * i];
+}
+
+/// \brief Spread one float a sample back out to both floats of each sample, in place.  Working backwards, each pair of
+/// vectors stored is at or after the one it was loaded from, so nothing is overwritten before it is read.
+/// \param buf One float for each sample at the start, and receives the samples
+/// \param samples The number of samples
+static void dsp_mono_spread(float *buf, const size_t samples) {
+    size_t i = samples;
+    for (; i % SIMD_LANES != 0; --i)
+        buf[DSP_FLOATS_PER_SAMPLE * (i - 1)] = buf[DSP_FLOATS_PER_SAMPLE * (i - 1) + 1] = buf[i - 1];
+    for (; i > 0; i -= SIMD_LANES) {
+        const simd_v4f mono = simd_load(buf + i - SIMD_LANES);
+        simd_store(buf + DSP_FLOATS_PER_SAMPLE * (i - SIMD_LANES), __builtin_shuffle(mono, (simd_v4i) {0, 0, 1, 1}));
+        simd_store(buf + DSP_FLOATS_PER_SAMPLE * (i - SIMD_LANES) + SIMD_LANES,
+                   __builtin_shuffle(mono, (simd_v4i) {2, 2, 3, 3}));
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void dsp_graph_init(struct dsp_graph *graph) {
+    memset(graph, 0, sizeof(*graph));
+}
+
+void dsp_graph_init_mono(struct dsp_graph *graph) {
+    dsp_graph_init(graph);
+    graph->mono = true;
+}
+
+int dsp_graph_add(struct dsp_graph *graph, const char *name, const dsp_process_t process, void *state) {
+    if (graph->num_stages == DSP_MAX_STAGES)
+        return -1;
+
+    graph->stages[graph->num_stages++] = (struct dsp_stage) {
+        .name = name,
+        .process = process,
+        .state = state,
+    };
+    return 0;
+}
+
+int dsp_graph_add_source(struct dsp_graph *graph, const char *name, const dsp_process_t process, void *state) {
+    if (dsp_graph_add(graph, name, process, state) != 0)
+        return -1;
+
+    graph->stages[graph->num_stages - 1].source = true;
+    return 0;
+}
+
+void dsp_graph_run(const struct dsp_graph *graph, const float *in, float *out, const size_t len) {
+    if (graph->num_stages == 0) {
+        if (in != out)
+            memcpy(out, in, len * sizeof(*out));
+        return;
+    }
+
+    if (!graph->mono) {
+        graph->stages[0].process(graph->stages[0].state, in, out, len);
+        for (size_t i = 1; i < graph->num_stages; ++i)
+            graph->stages[i].process(graph->stages[i].state, out, out, len);
+        return;
+    }
+
+    // A float left over at the end, which can only be half a sample, goes through untouched.
+    const size_t samples = len / DSP_FLOATS_PER_SAMPLE;
+    if (len % DSP_FLOATS_PER_SAMPLE != 0)
+        out[len - 1] = in[len - 1];
+
+    if (!graph->stages[0].source)
+        dsp_mono_pack(in, out, samples);
+    for (size_t i = 0; i < graph->num_stages; ++i)
+        graph->stages[i].process(graph->stages[i].state, out, out, samples);
+    dsp_mono_spread(out, samples);
+}
+
+void dsp_tone_osc_init(struct osc *osc, const unsigned int len, const uint32_t sample_rate) {
+    osc_init(osc, sample_rate);
+    osc_set(osc, (double) sample_rate / len);
+}
+
+void dsp_rotate_set(struct dsp_rotate *rotate, const float hz, const uint32_t sample_rate) {
+    if (rotate->osc.sample_rate != sample_rate)
+        osc_init(&rotate->osc, sample_rate);
+
+    rotate->hz = hz;
+    osc_set(&rotate->osc, hz);
+}
+
+void dsp_graph_dump(const struct dsp_graph *graph, const char *name, FILE *file) {
+    fprintf(file, "DSP %s%s:", name, graph->mono ? " (mono)" : "");
+    for (size_t i = 0; i < graph->num_stages; ++i)
+        fprintf(file, "%s %s", i == 0 ? "" : " ->", graph->stages[i].name);
+    fprintf(file, "%s\n", graph->num_stages == 0 ? " passthrough" : "");
+}
@@ -0,0 +1,264 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file dsp.h
+/// @brief Chains of DSP stages, with elementwise stages fused into a single pass at compile time
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// A waveform's receive and transmit processing is a graph: a list of stages, each of which takes a packet's worth of
+/// samples and produces the same number.  Stages that need a whole block at once, such as a filter or an AGC, are
+/// plain functions.  Stages that only look at one sample at a time, such as a gain or an oscillator, are written as
+/// operations instead, and a run of them is fused into one stage by DSP_FUSED_STAGE so that the packet goes through the
+/// cache once rather than once per operation:
+///
+///     #define MY_CHAIN(X) X(tone) X(gain)
+///     struct my_chain { struct dsp_tone tone; struct dsp_gain gain; };
+///     DSP_FUSED_STAGE(my_chain_run, struct my_chain, MY_CHAIN)
+///     ...
+///     dsp_graph_add(&graph, "tone+gain", my_chain_run, &my_chain);
+///
+/// Each operation in a chain takes its state from the member of the same name, so an operation can only appear once
+/// in a chain.
+
+#ifndef WAVEFORM_EXAMPLE_DSP_H
+#define WAVEFORM_EXAMPLE_DSP_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "osc.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most stages in a graph
+#define DSP_MAX_STAGES 8
+
+/// \brief Samples are always pairs of floats, either I/Q or left/right
+#define DSP_FLOATS_PER_SAMPLE 2
+
+/// \brief Define a stage function that applies a chain of operations to every sample in one pass.  Each operation
+/// supplies three macros: DSP_<op>_BEGIN(state) to load its state into locals before the loop, DSP_<op>_STEP(state,
+/// l, r) to update the sample pair l and r, and DSP_<op>_END(state) to store its state back afterwards.
+/// \param name The name of the stage function to define
+/// \param state_type The type of the stage's state, with one member named after each operation
+/// \param chain An X-macro list of the operations, in the order they are applied
+#define DSP_FUSED_STAGE(name, state_type, chain)                                        \
+    static void name(void *arg, const float *in, float *out, const size_t len) {       \
+        state_type *state = arg;                                                         \
+        chain(DSP_OP_BEGIN)                                                              \
+        for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {                   \
+            float l = in[i];                                                             \
+            float r = in[i + 1];                                                         \
+            chain(DSP_OP_STEP)                                                           \
+            out[i] = l;                                                                  \
+            out[i + 1] = r;                                                              \
+        }                                                                                \
+        chain(DSP_OP_END)                                                                \
+    }
+
+/// \brief Define a stage function for a mono graph, which applies a chain of operations as DSP_FUSED_STAGE does but to
+/// one float a sample.  The operations are the same ones: each sees the sample as both l and r, and since only l is
+/// kept the compiler drops whatever they do to r.
+/// \param name The name of the stage function to define
+/// \param state_type The type of the stage's state, with one member named after each operation
+/// \param chain An X-macro list of the operations, in the order they are applied
+#define DSP_FUSED_MONO_STAGE(name, state_type, chain)                                   \
+    static void name(void *arg, const float *in, float *out, const size_t len) {       \
+        state_type *state = arg;                                                         \
+        chain(DSP_OP_BEGIN)                                                              \
+        for (size_t i = 0; i < len; ++i) {                                               \
+            float l = in[i];                                                             \
+            float r = l;                                                                 \
+            chain(DSP_OP_STEP)                                                           \
+            (void) r;                                                                    \
+            out[i] = l;                                                                  \
+        }                                                                                \
+        chain(DSP_OP_END)                                                                \
+    }
+
+#define DSP_OP_BEGIN(op) DSP_##op##_BEGIN(state->op)
+#define DSP_OP_STEP(op) DSP_##op##_STEP(state->op, l, r)
+#define DSP_OP_END(op) DSP_##op##_END(state->op)
+
+// tone: replace both halves of the sample with the next value from a table holding whole cycles of a tone.  Where
+// the tone is comes from an oscillator that turns once a cycle of the table, which lives outside the stage so that it
+// can be carried from one connection to the next.  See osc.h.
+#define DSP_tone_BEGIN(s)                                                                \
+    const float *tone_table = (s).table;                                                 \
+    const unsigned int tone_len = (s).len;                                               \
+    unsigned int tone_phase = osc_index((s).osc, tone_len);                              \
+    size_t tone_count = 0;
+#define DSP_tone_STEP(s, l, r)                                                           \
+    (l) = (r) = tone_table[tone_phase];                                                  \
+    if (++tone_phase == tone_len)                                                        \
+        tone_phase = 0;                                                                  \
+    ++tone_count;
+#define DSP_tone_END(s) osc_advance((s).osc, tone_count);
+
+// gain: scale both halves of the sample
+#define DSP_gain_BEGIN(s) const float gain_value = (s).gain;
+#define DSP_gain_STEP(s, l, r)                                                           \
+    (l) *= gain_value;                                                                   \
+    (r) *= gain_value;
+#define DSP_gain_END(s)
+
+// mix: multiply both halves of the sample by a tone from a table, as for tone
+#define DSP_mix_BEGIN(s)                                                                 \
+    const float *mix_table = (s).table;                                                  \
+    const unsigned int mix_len = (s).len;                                                \
+    unsigned int mix_phase = osc_index((s).osc, mix_len);                                \
+    size_t mix_count = 0;
+#define DSP_mix_STEP(s, l, r)                                                            \
+    (l) *= mix_table[mix_phase];                                                         \
+    (r) *= mix_table[mix_phase];                                                         \
+    if (++mix_phase == mix_len)                                                          \
+        mix_phase = 0;                                                                   \
+    ++mix_count;
+#define DSP_mix_END(s) osc_advance((s).osc, mix_count);
+
+// rotate: shift complex I/Q samples in frequency by multiplying by a complex oscillator.  A float rotator is seeded
+// from the oscillator's exact phase at the start of each packet and stepped once a sample across it, so whatever error
+// it gathers is gone by the next packet and the shift never drifts however long it runs.  See osc.h.
+#define DSP_rotate_BEGIN(s)                                                              \
+    float rotate_re;                                                                     \
+    float rotate_im;                                                                     \
+    osc_phasor(&(s).osc, &rotate_re, &rotate_im);                                        \
+    const float rotate_step_re = (s).osc.step_re;                                        \
+    const float rotate_step_im = (s).osc.step_im;                                        \
+    size_t rotate_count = 0;
+#define DSP_rotate_STEP(s, l, r)                                                         \
+    {                                                                                    \
+        const float rotated = (l) * rotate_re - (r) * rotate_im;                         \
+        (r) = (l) * rotate_im + (r) * rotate_re;                                         \
+        (l) = rotated;                                                                   \
+        const float next_re = rotate_re * rotate_step_re - rotate_im * rotate_step_im;   \
+        rotate_im = rotate_re * rotate_step_im + rotate_im * rotate_step_re;             \
+        rotate_re = next_re;                                                             \
+        ++rotate_count;                                                                  \
+    }
+#define DSP_rotate_END(s) osc_advance(&(s).osc, rotate_count);
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A stage.  It reads len floats from in and writes len floats to out, which may be the same buffer.
+typedef void (*dsp_process_t)(void *state, const float *in, float *out, size_t len);
+
+/// \brief The state of a tone or mix operation
+struct dsp_tone {
+    const float *table;         ///< Whole cycles of the tone, one value per sample
+    unsigned int len;           ///< The number of values in table
+    struct osc *osc;            ///< Turns once every len samples; see dsp_tone_osc_init
+};
+
+/// \brief The state of a gain operation
+struct dsp_gain {
+    float gain;
+};
+
+/// \brief The state of a rotate operation
+struct dsp_rotate {
+    float hz;                   ///< The shift, positive upwards
+    struct osc osc;             ///< The oscillator, at the shift
+};
+
+/// \brief A stage in a graph
+struct dsp_stage {
+    const char *name;
+    dsp_process_t process;
+    void *state;
+    bool source;                ///< It makes its own signal and never reads its input; see dsp_graph_add_source
+};
+
+/// \brief The stages a packet goes through, in order
+struct dsp_graph {
+    struct dsp_stage stages[DSP_MAX_STAGES];
+    size_t num_stages;
+    bool mono;                  ///< The stages see one float a sample; see dsp_graph_init_mono
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a graph with no stages, which copies its input to its output.
+/// \param graph The graph to initialize
+void dsp_graph_init(struct dsp_graph *graph);
+
+/// \brief Initialize a mono graph with no stages.  The radio sends and expects the same value on both halves of
+/// every sample in the audio modes, and stages such as the tone that only make real audio have nothing to do with the
+/// second half but copy the first.  A mono graph keeps just the first float of each sample on the way in and writes
+/// it to both on the way out, so that its stages see a packet of half the length, one float a sample, and do half the
+/// work in half the cache.
+/// \param graph The graph to initialize
+void dsp_graph_init_mono(struct dsp_graph *graph);
+
+/// \brief Add a stage to the end of a graph.
+/// \param graph The graph
+/// \param name The name to report it by, which must outlive the graph
+/// \param process The stage function
+/// \param state Passed to process, which must outlive the graph
+/// \return 0 for success otherwise a negative value if the graph is full
+int dsp_graph_add(struct dsp_graph *graph, const char *name, dsp_process_t process, void *state);
+
+/// \brief Add a stage that makes its own signal, such as a tone or a modulator, and never reads its input.  As the
+/// first stage of a mono graph it spares the graph packing the input, which nothing would read.
+/// \param graph The graph
+/// \param name The name to report it by, which must outlive the graph
+/// \param process The stage function
+/// \param state Passed to process, which must outlive the graph
+/// \return 0 for success otherwise a negative value if the graph is full
+int dsp_graph_add_source(struct dsp_graph *graph, const char *name, dsp_process_t process, void *state);
+
+/// \brief Run a packet through every stage of a graph.  The first stage reads from in and every stage after that works
+/// in place in out, so a graph never needs a buffer of its own.  A mono graph packs the first float of each sample
+/// into the first half of out before its first stage, unless that is a source, and spreads them back out after its
+/// last.
+/// \param graph The graph
+/// \param in The input samples
+/// \param out Receives the output samples.  It may be the same as in.
+/// \param len The number of floats in each
+void dsp_graph_run(const struct dsp_graph *graph, const float *in, float *out, size_t len);
+
+/// \brief Initialize the oscillator for a tone or mix operation, at zero phase, so that it turns once a cycle of the
+/// table.
+/// \param osc The oscillator to initialize
+/// \param len The number of values in the table
+/// \param sample_rate The sample rate in Hz
+void dsp_tone_osc_init(struct osc *osc, unsigned int len, uint32_t sample_rate);
+
+/// \brief Set the shift of a rotate operation, carrying on from the oscillator's present phase.
+/// \param rotate The operation's state, which starts at zero phase if it was all zeros
+/// \param hz The shift in Hz, positive upwards
+/// \param sample_rate The sample rate in Hz
+void dsp_rotate_set(struct dsp_rotate *rotate, float hz, uint32_t sample_rate);
+
+/// \brief Print the stages of a graph.
+/// \param graph The graph
+/// \param name What the graph is for
+/// \param file Where to print
+void dsp_graph_dump(const struct dsp_graph *graph, const char *name, FILE *file);
+
+#endif // WAVEFORM_EXAMPLE_DSP_H
@@ -0,0 +1,379 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fec.c
+/// @brief Forward error correction for the modems: CRC-32C, Reed-Solomon and a convolutional code with Viterbi decoding
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "fec.h"
+#include "simd.h"
+#include "tables.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The states of the convolutional encoder, and the vectors of FEC_VITERBI_LANES path metrics they take
+#define FEC_CONV_STATES (1U << (FEC_CONV_K - 1))
+#define FEC_VITERBI_VECTORS (FEC_CONV_STATES / FEC_VITERBI_LANES)
+
+// The most a branch can cost: both soft bits as wrong as they can be
+#define FEC_VITERBI_MAX_BRANCH 510
+
+// Every state but zero starts out this far behind, since the encoder always starts at zero
+#define FEC_VITERBI_UNLIKELY 8192
+
+// The metrics only grow, so every this many bits the smallest is taken off all of them to keep them in 16 bits
+#define FEC_VITERBI_RENORMALIZE 32
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief The parity of the bits of a word
+static inline unsigned int fec_parity(const unsigned int x) {
+    return (unsigned int) __builtin_parity(x);
+}
+
+/// \brief Multiply two elements of the Galois field
+static inline uint8_t fec_gf_mul(const uint8_t a, const uint8_t b) {
+    if (a == 0 || b == 0)
+        return 0;
+    return tables_gf_exp[tables_gf_log[a] + tables_gf_log[b]];
+}
+
+/// \brief Divide one element of the Galois field by another, which mustn't be zero
+static inline uint8_t fec_gf_div(const uint8_t a, const uint8_t b) {
+    if (a == 0)
+        return 0;
+    return tables_gf_exp[tables_gf_log[a] + FEC_GF_SIZE - 1 - tables_gf_log[b]];
+}
+
+/// \brief Load four bytes little endian, aligned or not
+static inline uint32_t fec_load32(const uint8_t *p) {
+    return (uint32_t) p[0] | (uint32_t) p[1] << 8 | (uint32_t) p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/// \brief Eight path metrics with a single value
+static inline simd_v8u16 fec_splat(const uint16_t x) {
+    return (simd_v8u16) {x, x, x, x, x, x, x, x};
+}
+
+/// \brief The smaller of each pair of lanes
+static inline simd_v8u16 fec_min(const simd_v8u16 a, const simd_v8u16 b) {
+    const simd_v8i16 less = a < b;
+    return (simd_v8u16) ((less & (simd_v8i16) a) | (~less & (simd_v8i16) b));
+}
+
+/// \brief Decode a whole frame and pass on its payload if it checks out.
+/// \param deframer The deframer, with the frame in coded
+static void fec_deframe_frame(struct fec_deframer *deframer) {
+    for (size_t i = 0; i < sizeof(deframer->soft); ++i)
+        deframer->soft[i] = deframer->coded[i / 8] >> (7 - i % 8) & 1 ? 255 : 0;
+
+    uint8_t codeword[FEC_RS_CODEWORD];
+    fec_viterbi_decode(&deframer->viterbi, deframer->soft, FEC_CONV_BITS, codeword);
+
+    const int corrected = fec_rs_decode(codeword, sizeof(codeword));
+    if (corrected < 0) {
+        ++deframer->rs_failures;
+        return;
+    }
+    deframer->corrected += (uint64_t) corrected;
+
+    const size_t len = codeword[0];
+    if (len > FEC_PAYLOAD ||
+        fec_crc32c(0, codeword, FEC_BLOCK - FEC_CRC_BYTES) != fec_load32(codeword + FEC_BLOCK - FEC_CRC_BYTES)) {
+        ++deframer->crc_errors;
+        return;
+    }
+
+    ++deframer->frames;
+    if (deframer->num_decoded + len > FEC_RX_BUFFER) {
+        ++deframer->overruns;
+        return;
+    }
+    memcpy(deframer->decoded + deframer->num_decoded, codeword + 1, len);
+    deframer->num_decoded += len;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+uint32_t fec_crc32c(uint32_t crc, const void *data, size_t len) {
+    const uint8_t *p = data;
+    crc = ~crc;
+
+    for (; len >= FEC_CRC_SLICES; len -= FEC_CRC_SLICES, p += FEC_CRC_SLICES) {
+        const uint32_t lo = crc ^ fec_load32(p);
+        const uint32_t hi = fec_load32(p + 4);
+        crc = tables_crc32c[7][lo & 0xff] ^ tables_crc32c[6][lo >> 8 & 0xff] ^ tables_crc32c[5][lo >> 16 & 0xff] ^
+              tables_crc32c[4][lo >> 24] ^ tables_crc32c[3][hi & 0xff] ^ tables_crc32c[2][hi >> 8 & 0xff] ^
+              tables_crc32c[1][hi >> 16 & 0xff] ^ tables_crc32c[0][hi >> 24];
+    }
+    for (; len > 0; --len, ++p)
+        crc = crc >> 8 ^ tables_crc32c[0][(crc ^ *p) & 0xff];
+
+    return ~crc;
+}
+
+void fec_rs_encode(const uint8_t *data, const size_t len, uint8_t *parity) {
+    // Divide by the generator polynomial a byte at a time, parity[0] being the highest power of the remainder.
+    memset(parity, 0, FEC_RS_PARITY);
+    for (size_t i = 0; i < len; ++i) {
+        const uint8_t feedback = data[i] ^ parity[0];
+        memmove(parity, parity + 1, FEC_RS_PARITY - 1);
+        parity[FEC_RS_PARITY - 1] = 0;
+        if (feedback == 0)
+            continue;
+        const unsigned int log_feedback = tables_gf_log[feedback];
+        for (unsigned int j = 0; j < FEC_RS_PARITY; ++j) {
+            const uint8_t g = tables_rs_generator[FEC_RS_PARITY - 1 - j];
+            if (g != 0)
+                parity[j] ^= tables_gf_exp[log_feedback + tables_gf_log[g]];
+        }
+    }
+}
+
+int fec_rs_decode(uint8_t *codeword, const size_t len) {
+    // The syndromes: the codeword evaluated at each root of the generator, all zero if nothing is wrong.  Byte i is
+    // the coefficient of x^(len - 1 - i).
+    uint8_t syndrome[FEC_RS_PARITY] = {0};
+    for (size_t i = 0; i < len; ++i)
+        for (unsigned int j = 0; j < FEC_RS_PARITY; ++j)
+            syndrome[j] = tables_rs_root_mul[j][syndrome[j]] ^ codeword[i];
+
+    uint8_t any = 0;
+    for (unsigned int j = 0; j < FEC_RS_PARITY; ++j)
+        any |= syndrome[j];
+    if (any == 0)
+        return 0;
+
+    // Berlekamp-Massey finds the error locator polynomial, whose roots are the inverses of the error locations.
+    uint8_t lambda[FEC_RS_PARITY + 1] = {1};
+    uint8_t previous[FEC_RS_PARITY + 1] = {1};
+    unsigned int errors = 0;
+    unsigned int shift = 1;
+    uint8_t previous_discrepancy = 1;
+    for (unsigned int r = 0; r < FEC_RS_PARITY; ++r) {
+        uint8_t discrepancy = syndrome[r];
+        for (unsigned int i = 1; i <= errors; ++i)
+            discrepancy ^= fec_gf_mul(lambda[i], syndrome[r - i]);
+        if (discrepancy == 0) {
+            ++shift;
+            continue;
+        }
+
+        const uint8_t scale = fec_gf_div(discrepancy, previous_discrepancy);
+        uint8_t saved[FEC_RS_PARITY + 1];
+        memcpy(saved, lambda, sizeof(saved));
+        for (unsigned int i = 0; i + shift <= FEC_RS_PARITY; ++i)
+            lambda[i + shift] ^= fec_gf_mul(scale, previous[i]);
+
+        if (2 * errors <= r) {
+            errors = r + 1 - errors;
+            memcpy(previous, saved, sizeof(previous));
+            previous_discrepancy = discrepancy;
+            shift = 1;
+        } else {
+            ++shift;
+        }
+    }
+    if (errors > FEC_RS_PARITY / 2)
+        return -1;
+
+    // The error evaluator polynomial, the syndromes times the locator, for Forney's formula below
+    uint8_t omega[FEC_RS_PARITY];
+    for (unsigned int k = 0; k < FEC_RS_PARITY; ++k) {
+        uint8_t o = 0;
+        for (unsigned int i = 0; i <= k && i <= errors; ++i)
+            o ^= fec_gf_mul(lambda[i], syndrome[k - i]);
+        omega[k] = o;
+    }
+
+    // The Chien search tries every location in the codeword, and Forney's formula gives the error at each one found.
+    unsigned int found = 0;
+    for (size_t i = 0; i < len && found < errors; ++i) {
+        const unsigned int power = (unsigned int) (len - 1 - i);
+        const unsigned int inverse = (FEC_GF_SIZE - 1 - power) % (FEC_GF_SIZE - 1);
+
+        uint8_t value = 0;
+        for (unsigned int j = 0; j <= errors; ++j)
+            if (lambda[j] != 0)
+                value ^= tables_gf_exp[(tables_gf_log[lambda[j]] + inverse * j) % (FEC_GF_SIZE - 1)];
+        if (value != 0)
+            continue;
+
+        uint8_t numerator = 0;
+        for (unsigned int k = 0; k < FEC_RS_PARITY; ++k)
+            if (omega[k] != 0)
+                numerator ^= tables_gf_exp[(tables_gf_log[omega[k]] + inverse * k) % (FEC_GF_SIZE - 1)];
+
+        // The formal derivative of the locator only keeps its odd powers.
+        uint8_t denominator = 0;
+        for (unsigned int j = 1; j <= errors; j += 2)
+            if (lambda[j] != 0)
+                denominator ^= tables_gf_exp[(tables_gf_log[lambda[j]] + inverse * (j - 1)) % (FEC_GF_SIZE - 1)];
+        if (denominator == 0)
+            return -1;
+
+        codeword[i] ^= fec_gf_div(numerator, denominator);
+        ++found;
+    }
+
+    // Fewer roots than the degree of the locator means the errors were at locations the shortened code doesn't have,
+    // so there were more than it can correct.
+    return found == errors ? (int) errors : -1;
+}
+
+size_t fec_conv_encode(const uint8_t *data, const size_t len, uint8_t *out) {
+    const size_t bits = len * 8 + FEC_CONV_K - 1;
+    const size_t out_len = (bits * 2 + 7) / 8;
+    memset(out, 0, out_len);
+
+    unsigned int reg = 0;
+    for (size_t i = 0; i < bits; ++i) {
+        const unsigned int bit = i < len * 8 ? data[i / 8] >> (7 - i % 8) & 1 : 0;
+        reg = (reg << 1 | bit) & ((1U << FEC_CONV_K) - 1);
+        const size_t pos = i * 2;
+        out[pos / 8] |= (uint8_t) (fec_parity(reg & FEC_CONV_POLY_A) << (7 - pos % 8));
+        out[(pos + 1) / 8] |= (uint8_t) (fec_parity(reg & FEC_CONV_POLY_B) << (7 - (pos + 1) % 8));
+    }
+    return out_len;
+}
+
+void fec_viterbi_decode(struct fec_viterbi *viterbi, const uint8_t *soft, const size_t bits, uint8_t *out) {
+    // State s of the encoder is its last six bits in, so the states before 2i and 2i+1 are always i and i + 32.
+    // Metric vector v holds states 8v to 8v + 7, so butterflies 8v to 8v + 7 read vectors v and v + 4 and write
+    // vectors 2v and 2v + 1.
+    simd_v8u16 metric[FEC_VITERBI_VECTORS];
+    metric[0] = fec_splat(FEC_VITERBI_UNLIKELY);
+    metric[0][0] = 0;
+    for (unsigned int v = 1; v < FEC_VITERBI_VECTORS; ++v)
+        metric[v] = fec_splat(FEC_VITERBI_UNLIKELY);
+
+    const simd_v8u16 max_branch = fec_splat(FEC_VITERBI_MAX_BRANCH);
+    for (size_t t = 0; t < bits; ++t) {
+        const simd_v8u16 a = fec_splat(soft[2 * t]);
+        const simd_v8u16 b = fec_splat(soft[2 * t + 1]);
+        simd_v8u16 next[FEC_VITERBI_VECTORS];
+        simd_v8i16 decisions = {0};
+
+        for (unsigned int v = 0; v < FEC_VITERBI_VECTORS / 2; ++v) {
+            // Taking in a 1 or starting from the upper state each flip both bits sent, so one branch cost and its
+            // complement cover all four branches.
+            const simd_v8u16 cost = (a ^ tables_viterbi_expect[0][v]) + (b ^ tables_viterbi_expect[1][v]);
+            const simd_v8u16 anti = max_branch - cost;
+            const simd_v8u16 lower = metric[v];
+            const simd_v8u16 upper = metric[v + FEC_VITERBI_VECTORS / 2];
+
+            const simd_v8u16 lower0 = lower + cost;
+            const simd_v8u16 upper0 = upper + anti;
+            const simd_v8u16 lower1 = lower + anti;
+            const simd_v8u16 upper1 = upper + cost;
+            const simd_v8i16 from_upper0 = upper0 < lower0;
+            const simd_v8i16 from_upper1 = upper1 < lower1;
+            const simd_v8u16 even = fec_min(lower0, upper0);
+            const simd_v8u16 odd = fec_min(lower1, upper1);
+
+            next[2 * v] = __builtin_shuffle(even, odd, (simd_v8i16) {0, 8, 1, 9, 2, 10, 3, 11});
+            next[2 * v + 1] = __builtin_shuffle(even, odd, (simd_v8i16) {4, 12, 5, 13, 6, 14, 7, 15});
+            // Lane l of the decisions gets a bit for each of states 16v + 2l and 16v + 2l + 1.
+            decisions |= (from_upper0 & (int16_t) (1 << 2 * v)) | (from_upper1 & (int16_t) (2 << 2 * v));
+        }
+        memcpy(viterbi->decisions[t], &decisions, sizeof(decisions));
+        memcpy(metric, next, sizeof(metric));
+
+        if (t % FEC_VITERBI_RENORMALIZE == FEC_VITERBI_RENORMALIZE - 1) {
+            simd_v8u16 least = metric[0];
+            for (unsigned int v = 1; v < FEC_VITERBI_VECTORS; ++v)
+                least = fec_min(least, metric[v]);
+            uint16_t floor = least[0];
+            for (unsigned int lane = 1; lane < FEC_VITERBI_LANES; ++lane)
+                floor = least[lane] < floor ? least[lane] : floor;
+            for (unsigned int v = 0; v < FEC_VITERBI_VECTORS; ++v)
+                metric[v] -= fec_splat(floor);
+        }
+    }
+
+    // The flush leaves the encoder at state zero, so trace back from there.  The bit taken in to reach a state is its
+    // lowest bit.
+    const size_t data_bits = bits - (FEC_CONV_K - 1);
+    memset(out, 0, (data_bits + 7) / 8);
+    unsigned int state = 0;
+    for (size_t t = bits; t-- > 0;) {
+        const unsigned int bit = state & 1;
+        const unsigned int butterfly = state >> 1;
+        const unsigned int v = butterfly / FEC_VITERBI_LANES;
+        const unsigned int lane = butterfly % FEC_VITERBI_LANES;
+        const unsigned int from_upper = viterbi->decisions[t][lane] >> (2 * v + bit) & 1;
+        if (t < data_bits)
+            out[t / 8] |= (uint8_t) (bit << (7 - t % 8));
+        state = butterfly + from_upper * (FEC_CONV_STATES / 2);
+    }
+}
+
+void fec_frame(const uint8_t *payload, const size_t len, uint8_t *frame) {
+    uint8_t codeword[FEC_RS_CODEWORD] = {(uint8_t) len};
+    memcpy(codeword + 1, payload, len);
+
+    const uint32_t crc = fec_crc32c(0, codeword, FEC_BLOCK - FEC_CRC_BYTES);
+    for (unsigned int i = 0; i < FEC_CRC_BYTES; ++i)
+        codeword[FEC_BLOCK - FEC_CRC_BYTES + i] = (uint8_t) (crc >> (8 * i));
+    fec_rs_encode(codeword, FEC_BLOCK, codeword + FEC_BLOCK);
+
+    for (unsigned int i = 0; i < FEC_SYNC_BYTES; ++i)
+        frame[i] = (uint8_t) (FEC_SYNC >> (8 * (FEC_SYNC_BYTES - 1 - i)));
+    fec_conv_encode(codeword, sizeof(codeword), frame + FEC_SYNC_BYTES);
+}
+
+void fec_deframer_init(struct fec_deframer *deframer) {
+    memset(deframer, 0, sizeof(*deframer));
+}
+
+void fec_deframe(struct fec_deframer *deframer, const uint8_t *data, size_t len) {
+    while (len > 0) {
+        if (deframer->in_frame) {
+            size_t take = FEC_CODED - deframer->have;
+            take = take < len ? take : len;
+            memcpy(deframer->coded + deframer->have, data, take);
+            deframer->have += take;
+            data += take;
+            len -= take;
+
+            if (deframer->have == FEC_CODED) {
+                fec_deframe_frame(deframer);
+                deframer->in_frame = false;
+                deframer->shift = 0;
+            }
+            continue;
+        }
+
+        deframer->shift = deframer->shift << 8 | *data++;
+        --len;
+        if (__builtin_popcount(deframer->shift ^ FEC_SYNC) <= FEC_SYNC_MAX_ERRORS) {
+            deframer->in_frame = true;
+            deframer->have = 0;
+        }
+    }
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fec.h
+/// @brief Forward error correction for the modems: CRC-32C, Reed-Solomon and a convolutional code with Viterbi decoding
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// With "set fec=on" the client's bytes are cut into frames on their way from the byte data callback to the modem,
+/// and put back together on their way from the modem to the client.  Each frame is built up in layers:
+///
+///  - A block of FEC_BLOCK bytes: the length of the payload, the payload padded with zeros, and a CRC-32C of both.
+///    The CRC catches whatever the layers below couldn't put right, so a bad frame is dropped rather than passed on.
+///  - FEC_RS_PARITY bytes of Reed-Solomon parity over the block, which corrects up to half that many bad bytes.  This
+///    mops up the bursts of errors the Viterbi decoder leaves behind when it goes wrong.
+///  - The lot through a rate 1/2, constraint length 7 convolutional code (the NASA standard polynomials) with the
+///    encoder flushed back to zero at the end, which the Viterbi decoder uses to correct scattered bit errors.
+///  - A 32 bit sync word in front, which the receiver looks for in the byte stream allowing for a few bad bits.
+///
+/// The tables for the CRC, the Galois field arithmetic and the Viterbi decoder's branches are generated at build time
+/// by tools/gen_tables.py from the constants below.  The Viterbi decoder keeps all 64 path metrics in vectors of eight
+/// (see simd.h).
+
+#ifndef WAVEFORM_EXAMPLE_FEC_H
+#define WAVEFORM_EXAMPLE_FEC_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The bytes of a block before the Reed-Solomon parity: length, payload and CRC
+#define FEC_BLOCK 64
+
+/// \brief The bytes of CRC-32C at the end of a block
+#define FEC_CRC_BYTES 4
+
+/// \brief The most payload bytes in one frame
+#define FEC_PAYLOAD (FEC_BLOCK - 1 - FEC_CRC_BYTES)
+
+/// \brief The Reed-Solomon parity bytes, which correct up to half as many bad bytes
+#define FEC_RS_PARITY 16
+
+/// \brief The block and its parity
+#define FEC_RS_CODEWORD (FEC_BLOCK + FEC_RS_PARITY)
+
+/// \brief The constraint length of the convolutional code
+#define FEC_CONV_K 7
+
+/// \brief The bits the convolutional decoder decides, including the zeros that flush the encoder
+#define FEC_CONV_BITS (FEC_RS_CODEWORD * 8 + FEC_CONV_K - 1)
+
+/// \brief The bytes the convolutional code makes of a codeword, at two bits for every bit in
+#define FEC_CODED ((FEC_CONV_BITS * 2 + 7) / 8)
+
+/// \brief The sync word in front of every frame
+#define FEC_SYNC 0x1ACFFC1DU
+
+/// \brief The bytes of the sync word
+#define FEC_SYNC_BYTES 4
+
+/// \brief The most bits of the sync word that may be wrong for it still to count
+#define FEC_SYNC_MAX_ERRORS 3
+
+/// \brief The bytes of a whole frame as it goes to the modem
+#define FEC_FRAME (FEC_SYNC_BYTES + FEC_CODED)
+
+/// \brief The decoded bytes held until the receive callback hands them on
+#define FEC_RX_BUFFER 256
+
+/// \brief The CRC-32C polynomial, bit reversed
+#define FEC_CRC_POLY 0x82F63B78U
+
+/// \brief The bytes the CRC takes at a time
+#define FEC_CRC_SLICES 8
+
+/// \brief The Galois field GF(2^8) and its primitive polynomial x^8 + x^4 + x^3 + x^2 + 1, whose root alpha is 2
+#define FEC_GF_SIZE 256
+#define FEC_GF_POLY 0x11DU
+
+/// \brief The convolutional code's polynomials, 171 and 133 octal.  Both have their first and last taps, which is what
+/// lets the decoder work out every branch of a butterfly from one of them.
+#define FEC_CONV_POLY_A 0x79U
+#define FEC_CONV_POLY_B 0x5BU
+
+/// \brief The Viterbi decoder's 16 bit path metrics in a vector
+#define FEC_VITERBI_LANES 8
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The Viterbi decoder's survivor decisions: for each bit decided, one bit for each of the 64 states saying
+/// which of its two predecessors it came from, laid out as the decoder's vectors make them.  Too big for the stack of
+/// a data callback.
+struct fec_viterbi {
+    uint16_t decisions[FEC_CONV_BITS][8];
+};
+
+/// \brief The receive side: finds frames in the bytes from a modem and decodes them.  Only ever touched by the receive
+/// data callback.
+struct fec_deframer {
+    uint32_t shift;             ///< The last four bytes, while looking for the sync word
+    bool in_frame;
+    size_t have;                ///< The bytes of the frame collected so far
+    uint8_t coded[FEC_CODED];
+    uint8_t soft[FEC_CONV_BITS * 2];
+    struct fec_viterbi viterbi;
+
+    uint8_t decoded[FEC_RX_BUFFER];
+    size_t num_decoded;
+
+    uint64_t frames;
+    uint64_t corrected;         ///< Bytes the Reed-Solomon decoder put right
+    uint64_t rs_failures;       ///< Frames with more bad bytes than Reed-Solomon could put right
+    uint64_t crc_errors;        ///< Frames that decoded but failed the CRC anyway
+    uint64_t overruns;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Update a CRC-32C (Castagnoli), eight bytes at a time.
+/// \param crc The CRC of whatever came before, or 0 to start
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return The CRC of everything so far
+uint32_t fec_crc32c(uint32_t crc, const void *data, size_t len);
+
+/// \brief Work out the Reed-Solomon parity of a block, shortened from the full 255 byte code.
+/// \param data The block
+/// \param len The number of bytes in the block, at most 255 - FEC_RS_PARITY
+/// \param parity Receives FEC_RS_PARITY bytes of parity
+void fec_rs_encode(const uint8_t *data, size_t len, uint8_t *parity);
+
+/// \brief Correct a block and its parity in place.
+/// \param codeword The block followed by its parity
+/// \param len The number of bytes in both, at most 255
+/// \return The number of bytes corrected otherwise a negative value if there were too many to correct
+int fec_rs_decode(uint8_t *codeword, size_t len);
+
+/// \brief Convolutionally encode bytes, most significant bit first, followed by the bits that flush the encoder.
+/// \param data The bytes
+/// \param len The number of bytes
+/// \param out Receives (len * 8 + FEC_CONV_K - 1) * 2 bits, most significant first, with the last byte padded with
+///            zeros
+/// \return The number of bytes written
+size_t fec_conv_encode(const uint8_t *data, size_t len, uint8_t *out);
+
+/// \brief Viterbi decode a convolutionally encoded block whose encoder was flushed back to zero at the end.
+/// \param viterbi The decisions, which are overwritten
+/// \param soft Two soft bits for each bit to decide, each 0 for a certain 0 up to 255 for a certain 1
+/// \param bits The number of bits to decide, including the flush, at most FEC_CONV_BITS
+/// \param out Receives the decided bits but the flush, most significant first
+void fec_viterbi_decode(struct fec_viterbi *viterbi, const uint8_t *soft, size_t bits, uint8_t *out);
+
+/// \brief Make a frame out of up to FEC_PAYLOAD bytes.
+/// \param payload The bytes
+/// \param len The number of bytes, at most FEC_PAYLOAD
+/// \param frame Receives FEC_FRAME bytes
+void fec_frame(const uint8_t *payload, size_t len, uint8_t *frame);
+
+/// \brief Initialize a deframer looking for the first frame.
+/// \param deframer The deframer to initialize
+void fec_deframer_init(struct fec_deframer *deframer);
+
+/// \brief Look for frames in bytes from a modem and decode them.  Payloads collect in deframer->decoded.
+/// \param deframer The deframer
+/// \param data The bytes
+/// \param len The number of bytes
+void fec_deframe(struct fec_deframer *deframer, const uint8_t *data, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_FEC_H
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fixed.c
+/// @brief Q15 fixed point DSP stages, and a graph that runs them as one stage of a float graph
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "fixed.h"
+#include "simd.h"
+#include "tables.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The largest Q15 value, just under 1
+#define FIXED_Q15_MAX 32767
+
+// The smallest Q15 value, -1
+#define FIXED_Q15_MIN (-32768)
+
+// The number of fraction bits
+#define FIXED_Q15_SHIFT 15
+
+// The values in the shift's sine table, and how far into it the cosine starts
+#define FIXED_SINE_LEN (1U << FIXED_SINE_BITS)
+#define FIXED_COSINE_OFFSET (FIXED_SINE_LEN / 4)
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief A float as Q15, rounded to nearest and saturated
+static int16_t fixed_q15(const float x) {
+    const long value = lrintf(x * (float) (1 << FIXED_Q15_SHIFT));
+    if (value > FIXED_Q15_MAX)
+        return FIXED_Q15_MAX;
+    if (value < FIXED_Q15_MIN)
+        return FIXED_Q15_MIN;
+    return (int16_t) value;
+}
+
+/// \brief A Q30 value as Q15, rounded to nearest and saturated
+static inline int16_t fixed_round(const int64_t x) {
+    const int64_t value = (x + (1 << (FIXED_Q15_SHIFT - 1))) >> FIXED_Q15_SHIFT;
+    if (value > FIXED_Q15_MAX)
+        return FIXED_Q15_MAX;
+    if (value < FIXED_Q15_MIN)
+        return FIXED_Q15_MIN;
+    return (int16_t) value;
+}
+
+/// \brief Multiply Q15 values, rounded to nearest and saturated.  The products are worked out at twice the width, in a
+/// full vector.  Only -1 times -1 needs the saturation.
+static inline simd_v4i16 fixed_mul(const simd_v4i16 a, const simd_v4i16 b) {
+    simd_v4i product = __builtin_convertvector(a, simd_v4i) * __builtin_convertvector(b, simd_v4i);
+    product = (product + (1 << (FIXED_Q15_SHIFT - 1))) >> FIXED_Q15_SHIFT;
+    const simd_v4i over = product > FIXED_Q15_MAX;
+    product = (over & FIXED_Q15_MAX) | (~over & product);
+    return __builtin_convertvector(product, simd_v4i16);
+}
+
+/// \brief Multiply one pair of Q15 values, as fixed_mul
+static inline int16_t fixed_mul_one(const int16_t a, const int16_t b) {
+    const int32_t product = ((int32_t) a * b + (1 << (FIXED_Q15_SHIFT - 1))) >> FIXED_Q15_SHIFT;
+    return (int16_t) (product > FIXED_Q15_MAX ? FIXED_Q15_MAX : product);
+}
+
+/// \brief Q15 values as floats
+static inline simd_v4f fixed_to_float(const simd_v4i16 v) {
+    return __builtin_convertvector(v, simd_v4f) * (1.0F / (float) (1 << FIXED_Q15_SHIFT));
+}
+
+/// \brief Floats as Q15, rounded to nearest and saturated.  The conversion to integers truncates, so half is added
+/// away from zero first, with the sign of each float copied onto it; saturating first keeps the conversion in range.
+static inline simd_v4i16 fixed_from_float(const simd_v4f v) {
+    const simd_v4f x = v * (float) (1 << FIXED_Q15_SHIFT);
+    const simd_v4f half = {0.5F, 0.5F, 0.5F, 0.5F};
+    const simd_v4f rounded = x + (simd_v4f) (((simd_v4i) x & (int32_t) 0x80000000) | (simd_v4i) half);
+    const simd_v4i over = rounded > (float) FIXED_Q15_MAX;
+    const simd_v4i under = rounded < (float) FIXED_Q15_MIN;
+    const simd_v4i value = __builtin_convertvector((simd_v4f) ((simd_v4i) rounded & ~(over | under)), simd_v4i);
+    return __builtin_convertvector((over & FIXED_Q15_MAX) | (under & FIXED_Q15_MIN) | value, simd_v4i16);
+}
+
+/// \brief The Hilbert transform at one sample, as hilbert_transform.  The taps are Q14, so the products are Q29, and
+/// tools/gen_tables.py checks that their sum can't overflow whatever the signal.  A single sum of 16 bit products is
+/// the loop compilers vectorize best, into multiply-adds such as pmaddwd or smlal.
+/// \param window The last HILBERT_PHASE_TAPS samples of the half the sample went in, oldest first
+/// \return The transform in Q29, HILBERT_DELAY samples late
+static inline int32_t fixed_hilbert_transform(const int16_t *window) {
+    const int16_t *taps = tables_hilbert_taps_q14;
+    int32_t sum = 0;
+    for (unsigned int i = 0; i < HILBERT_PHASE_TAPS; ++i)
+        sum += window[i] * taps[i];
+    return sum;
+}
+
+/// \brief Take in a packet of one real signal, and work out its Hilbert transform and the signal delayed to line up
+/// with it at every sample, as hilbert_push, hilbert_transform and hilbert_delayed would one sample at a time.  Each
+/// half is laid out in a line, its history followed by the packet's samples, before any of the sums are done, so that
+/// no sum has to wait on the sample it reads having just been stored.
+/// \param fir The signal's history
+/// \param in The signal, every DSP_FLOATS_PER_SAMPLE values
+/// \param samples The number of samples
+/// \param delayed Receives the delayed signal, or NULL if not wanted
+/// \param transform Receives the transform in Q29, or NULL if not wanted
+static void fixed_hilbert_run(struct fixed_hilbert_fir *fir, const int16_t *in, const size_t samples, int16_t *delayed,
+                              int32_t *transform) {
+    int16_t line[2][HILBERT_PHASE_TAPS + samples / 2 + 1];
+    size_t count[2] = {0, 0};
+    memcpy(line[0], fir->history[0], sizeof(fir->history[0]));
+    memcpy(line[1], fir->history[1], sizeof(fir->history[1]));
+
+    unsigned int phase = fir->phase;
+    for (size_t n = 0; n < samples; ++n) {
+        line[phase][HILBERT_PHASE_TAPS + count[phase]++] = in[n * DSP_FLOATS_PER_SAMPLE];
+        phase ^= 1;
+    }
+
+    // Only the half a sample went in has taps that aren't zero, and the sample HILBERT_DELAY back is in the middle of
+    // the other half's window.
+    count[0] = count[1] = 0;
+    phase = fir->phase;
+    for (size_t n = 0; n < samples; ++n) {
+        ++count[phase];
+        if (transform != NULL)
+            transform[n] = fixed_hilbert_transform(line[phase] + count[phase]);
+        if (delayed != NULL)
+            delayed[n] = line[phase ^ 1][count[phase ^ 1] + HILBERT_PHASE_TAPS / 2];
+        phase ^= 1;
+    }
+
+    memcpy(fir->history[0], line[0] + count[0], sizeof(fir->history[0]));
+    memcpy(fir->history[1], line[1] + count[1], sizeof(fir->history[1]));
+    fir->phase = phase;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void fixed_graph_init(struct fixed_graph *graph) {
+    memset(graph, 0, sizeof(*graph));
+}
+
+int fixed_graph_add(struct fixed_graph *graph, const char *name, const fixed_process_t process, void *state) {
+    if (graph->num_stages == FIXED_MAX_STAGES)
+        return -1;
+
+    graph->stages[graph->num_stages++] = (struct fixed_stage) {
+        .name = name,
+        .process = process,
+        .state = state,
+    };
+    return 0;
+}
+
+int fixed_graph_add_source(struct fixed_graph *graph, const char *name, const fixed_process_t process, void *state) {
+    if (fixed_graph_add(graph, name, process, state) != 0)
+        return -1;
+
+    graph->stages[graph->num_stages - 1].source = true;
+    return 0;
+}
+
+void fixed_graph_process(void *arg, const float *in, float *out, const size_t len) {
+    const struct fixed_graph *graph = arg;
+    if (len == 0)
+        return;
+
+    int16_t buffer[len];
+    size_t i = 0;
+    if (graph->num_stages == 0 || !graph->stages[0].source) {
+        for (; i + FIXED_LANES <= len; i += FIXED_LANES)
+            simd_store_i16(buffer + i, fixed_from_float(simd_load(in + i)));
+        for (; i < len; ++i)
+            buffer[i] = fixed_q15(in[i]);
+    }
+
+    for (size_t stage = 0; stage < graph->num_stages; ++stage)
+        graph->stages[stage].process(graph->stages[stage].state, buffer, buffer, len);
+
+    for (i = 0; i + FIXED_LANES <= len; i += FIXED_LANES)
+        simd_store(out + i, fixed_to_float(simd_load_i16(buffer + i)));
+    for (; i < len; ++i)
+        out[i] = (float) buffer[i] / (float) (1 << FIXED_Q15_SHIFT);
+}
+
+int fixed_tone_init(struct fixed_tone *tone, const int16_t *table, const unsigned int len, struct osc *osc,
+                    const float *gain) {
+    if (len == 0 || len > FIXED_TONE_MAX) {
+        fprintf(stderr, "Fixed point tone of %u values is not between 1 and %d\n", len, FIXED_TONE_MAX);
+        return -1;
+    }
+
+    memset(tone, 0, sizeof(*tone));
+    memcpy(tone->scaled, table, (len + FIXED_LANES) * sizeof(*table));
+    tone->table = table;
+    tone->len = len;
+    tone->osc = osc;
+    tone->gain = gain;
+    tone->scaled_gain = FIXED_Q15_MAX;
+    return 0;
+}
+
+void fixed_tone_process(void *arg, const int16_t *in, int16_t *out, const size_t len) {
+    (void) in;
+    struct fixed_tone *tone = arg;
+    const unsigned int tone_len = tone->len;
+
+    // The gain only changes between packets, so it goes into the table rather than into every sample.
+    if (tone->gain != NULL) {
+        const int16_t gain = fixed_q15(*tone->gain);
+        if (gain != tone->scaled_gain) {
+            const simd_v4i16 gain4 = {gain, gain, gain, gain};
+            const unsigned int total = tone_len + FIXED_LANES;
+            unsigned int i = 0;
+            for (; i + FIXED_LANES <= total; i += FIXED_LANES)
+                simd_store_i16(tone->scaled + i, fixed_mul(simd_load_i16(tone->table + i), gain4));
+            for (; i < total; ++i)
+                tone->scaled[i] = fixed_mul_one(tone->table[i], gain);
+            tone->scaled_gain = gain;
+        }
+    }
+
+    const int16_t *scaled = tone->scaled;
+    unsigned int phase = osc_index(tone->osc, tone_len);
+    size_t i = 0;
+    for (; i + FIXED_LANES <= len; i += FIXED_LANES) {
+        simd_store_i16(out + i, simd_load_i16(scaled + phase));
+        phase += FIXED_LANES;
+        while (phase >= tone_len)
+            phase -= tone_len;
+    }
+    for (; i < len; ++i) {
+        out[i] = scaled[phase];
+        if (++phase == tone_len)
+            phase = 0;
+    }
+
+    osc_advance(tone->osc, len);
+}
+
+void fixed_rotate_init(struct fixed_rotate *rotate, struct osc *osc) {
+    rotate->osc = osc;
+}
+
+void fixed_rotate_process(void *arg, const int16_t *in, int16_t *out, const size_t len) {
+    struct fixed_rotate *rotate = arg;
+    const int16_t *sine = tables_sine_q15;
+
+    // The accumulator starts from the oscillator's exact phase every packet, so the rounding of its step never builds
+    // up.  The products are Q30 and, since the sine and cosine are never both at full scale, can't overflow.
+    uint32_t phase;
+    uint32_t step;
+    osc_phase32(rotate->osc, &phase, &step);
+    phase += 1U << (31 - FIXED_SINE_BITS);  // So that taking the top bits rounds to the nearest value in the table
+    for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {
+        const unsigned int index = phase >> (32 - FIXED_SINE_BITS);
+        const int32_t s = sine[index];
+        const int32_t c = sine[(index + FIXED_COSINE_OFFSET) & (FIXED_SINE_LEN - 1)];
+        const int32_t re = in[i];
+        const int32_t im = in[i + 1];
+        out[i] = fixed_round(re * c - im * s);
+        out[i + 1] = fixed_round(re * s + im * c);
+        phase += step;
+    }
+
+    osc_advance(rotate->osc, len / DSP_FLOATS_PER_SAMPLE);
+}
+
+void fixed_hilbert_init(struct fixed_hilbert *hilbert, const enum hilbert_sideband sideband) {
+    memset(hilbert, 0, sizeof(*hilbert));
+    hilbert->sign = sideband;
+}
+
+void fixed_hilbert_analytic(void *arg, const int16_t *in, int16_t *out, const size_t len) {
+    struct fixed_hilbert *hilbert = arg;
+    const size_t samples = len / DSP_FLOATS_PER_SAMPLE;
+    if (samples == 0)
+        return;
+
+    int16_t delayed[samples];
+    int32_t transform[samples];
+    fixed_hilbert_run(&hilbert->fir[0], in, samples, delayed, transform);
+    for (size_t n = 0; n < samples; ++n) {
+        out[n * DSP_FLOATS_PER_SAMPLE] = delayed[n];
+        out[n * DSP_FLOATS_PER_SAMPLE + 1] = fixed_round((int64_t) hilbert->sign * transform[n] * 2);
+    }
+}
+
+void fixed_hilbert_real(void *arg, const int16_t *in, int16_t *out, const size_t len) {
+    struct fixed_hilbert *hilbert = arg;
+    const size_t samples = len / DSP_FLOATS_PER_SAMPLE;
+    if (samples == 0)
+        return;
+
+    int16_t delayed[samples];
+    int32_t transform[samples];
+    fixed_hilbert_run(&hilbert->fir[0], in, samples, delayed, NULL);
+    fixed_hilbert_run(&hilbert->fir[1], in + 1, samples, NULL, transform);
+
+    // Half of the delayed I less the transform of Q, as hilbert_real.  The transform is Q29, so with the delayed I at
+    // the same scale their difference is already halved as Q30.
+    for (size_t n = 0; n < samples; ++n) {
+        const int64_t half = ((int64_t) delayed[n] << (FIXED_Q15_SHIFT - 1)) - (int64_t) hilbert->sign * transform[n];
+        out[n * DSP_FLOATS_PER_SAMPLE] = out[n * DSP_FLOATS_PER_SAMPLE + 1] = fixed_round(half);
+    }
+}
@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fixed.h
+/// @brief Q15 fixed point DSP stages, and a graph that runs them as one stage of a float graph
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// Q15 holds a value from -1 up to just under 1 in an int16_t, as value * 32768, so a packet of it is half the size
+/// of one of floats.  A product of two is worked out at twice the width, as Q30 in 32 bits, and rounded back to Q15,
+/// saturating rather than wrapping; a filter keeps its sum at twice the width and only rounds once, at the end.
+///
+/// A fixed point graph is a list of Q15 stages that is itself a stage of a DSP graph (see dsp.h).  It turns its input
+/// into Q15 once, runs each of its stages in place on that, and turns the result back into floats once.  As the last
+/// stage of a graph that last conversion is the one the samples go through on their way to waveform_send_data_packet.
+/// The stages are:
+///
+///  - The tone, from a Q15 table with the gain multiplied into it whenever the gain changes.
+///  - The shift, a complex mixer.  Its oscillator is a 32 bit phase accumulator indexing a Q15 sine table, seeded each
+///    packet from the same struct osc as the float shift's, so that it never drifts.
+///  - The two Hilbert transformers, the same polyphase FIR as hilbert.h, run over a whole packet at once.  Its taps
+///    are Q14, which loses little since none reaches 1, so that the whole dot product fits one 32 bit sum and compiles
+///    to 16 bit multiply-adds.
+///
+/// Each follows the same oscillator or takes the same parameters as its float counterpart, so that one can be swapped
+/// for the other.  The tone and the conversions work four values at a time (see simd.h), which on the radio are NEON;
+/// the Hilbert transformers' dot product is a plain loop, which the compiler turns into its own multiply-adds.
+///
+/// Building with -DWAVEFORM_FIXED_POINT=ON runs the tone graphs, and the Hilbert transformers and shift of the modem
+/// graphs, as fixed point graphs.  The modems and the AGC have no Q15 versions, so on receive the signal goes back to
+/// float for the demodulator and the AGC and into Q15 again for the last Hilbert transformer.  The waveform-bench
+/// q15_ kernels run the stages in any build, for comparison with the float ones.
+
+#ifndef WAVEFORM_EXAMPLE_FIXED_H
+#define WAVEFORM_EXAMPLE_FIXED_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "hilbert.h"
+#include "osc.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most stages in a fixed point graph
+#define FIXED_MAX_STAGES 4
+
+/// \brief The most values in a tone's table
+#define FIXED_TONE_MAX 256
+
+/// \brief The Q15 values in a vector, SIMD_LANES, written out so that tools/gen_tables.py can size the tables with it
+#define FIXED_LANES 4
+
+/// \brief The shift's sine table holds 1 << FIXED_SINE_BITS values.  Its phase is rounded to that, which puts it
+/// within 0.09 degrees.
+#define FIXED_SINE_BITS 11
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A Q15 stage.  It reads len values from in and writes len values to out, which may be the same buffer.
+typedef void (*fixed_process_t)(void *state, const int16_t *in, int16_t *out, size_t len);
+
+/// \brief A stage in a fixed point graph
+struct fixed_stage {
+    const char *name;
+    fixed_process_t process;
+    void *state;
+    bool source;                ///< It makes its own signal and never reads its input
+};
+
+/// \brief The Q15 stages a packet goes through, in order
+struct fixed_graph {
+    struct fixed_stage stages[FIXED_MAX_STAGES];
+    size_t num_stages;
+};
+
+/// \brief A tone, and optionally its gain, as a stage of a mono graph.  It follows the same oscillator as struct
+/// dsp_tone, so the two can be swapped without the tone jumping.
+struct fixed_tone {
+    /// Whole cycles of the tone in Q15, followed by its first FIXED_LANES values again so that any FIXED_LANES values
+    /// in a row can be loaded at once
+    const int16_t *table;
+    int16_t scaled[FIXED_TONE_MAX + FIXED_LANES]; ///< The same at the gain
+    int16_t scaled_gain;        ///< The gain scaled is at, in Q15
+    unsigned int len;           ///< The number of values in a cycle
+    struct osc *osc;            ///< Turns once every len samples; see dsp_tone_osc_init
+    const float *gain;          ///< The gain to follow, from 0 to 1, or NULL for none
+};
+
+/// \brief A shift of complex I/Q samples in frequency
+struct fixed_rotate {
+    struct osc *osc;            ///< The oscillator, at the shift, such as a struct dsp_rotate's
+};
+
+/// \brief The history of one real signal, in two polyphase halves, as struct hilbert_fir.  Each half is its last
+/// HILBERT_PHASE_TAPS samples, oldest first, since the stage works a packet at a time rather than a sample at a time.
+struct fixed_hilbert_fir {
+    int16_t history[2][HILBERT_PHASE_TAPS];
+    unsigned int phase;         ///< Which half the next sample goes in
+};
+
+/// \brief A Hilbert transform stage, as struct hilbert
+struct fixed_hilbert {
+    int sign;                   ///< 1 for USB, -1 for LSB
+    struct fixed_hilbert_fir fir[2];
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a fixed point graph with no stages, which only converts to Q15 and back.
+/// \param graph The graph to initialize
+void fixed_graph_init(struct fixed_graph *graph);
+
+/// \brief Add a stage to the end of a fixed point graph.
+/// \param graph The graph
+/// \param name The name to report it by, which must outlive the graph
+/// \param process The stage function
+/// \param state Passed to process, which must outlive the graph
+/// \return 0 for success otherwise a negative value if the graph is full
+int fixed_graph_add(struct fixed_graph *graph, const char *name, fixed_process_t process, void *state);
+
+/// \brief Add a stage that makes its own signal and never reads its input.  As the first stage it spares the graph
+/// converting its input.  Add the graph to a DSP graph with dsp_graph_add_source then.
+/// \param graph The graph
+/// \param name The name to report it by, which must outlive the graph
+/// \param process The stage function
+/// \param state Passed to process, which must outlive the graph
+/// \return 0 for success otherwise a negative value if the graph is full
+int fixed_graph_add_source(struct fixed_graph *graph, const char *name, fixed_process_t process, void *state);
+
+/// \brief Run a fixed point graph, as a stage of a DSP graph.  See dsp.h.  The Q15 buffer is on the stack.
+/// \param arg The struct fixed_graph
+/// \param in The input samples, which are saturated to Q15
+/// \param out Receives the output samples, which may be the same as in
+/// \param len The number of floats in each
+void fixed_graph_process(void *arg, const float *in, float *out, size_t len);
+
+/// \brief Initialize a tone stage.
+/// \param tone The stage to initialize
+/// \param table Whole cycles of the tone in Q15, one value per sample, followed by the first FIXED_LANES values again,
+///              as made by tools/gen_tables.py.  It must outlive the stage.
+/// \param len The number of values in a cycle, at most FIXED_TONE_MAX
+/// \param osc The oscillator, turning once every len samples, which must outlive the stage
+/// \param gain The gain, which must outlive the stage and is read once a packet, or NULL for none
+/// \return 0 for success otherwise a negative value if the table is too long
+int fixed_tone_init(struct fixed_tone *tone, const int16_t *table, unsigned int len, struct osc *osc,
+                    const float *gain);
+
+/// \brief The tone at its gain, as the source of a mono graph.
+/// \param arg The struct fixed_tone
+/// \param in Not used
+/// \param out Receives the tone
+/// \param len The number of values
+void fixed_tone_process(void *arg, const int16_t *in, int16_t *out, size_t len);
+
+/// \brief Initialize a shift stage.
+/// \param rotate The stage to initialize
+/// \param osc The oscillator, which must outlive the stage.  The stage moves it on.
+void fixed_rotate_init(struct fixed_rotate *rotate, struct osc *osc);
+
+/// \brief Shift I/Q pairs in frequency, as DSP_rotate does.
+/// \param arg The struct fixed_rotate
+/// \param in The I/Q pairs
+/// \param out Receives the shifted pairs, which may be the same buffer
+/// \param len The number of values
+void fixed_rotate_process(void *arg, const int16_t *in, int16_t *out, size_t len);
+
+/// \brief Initialize a Hilbert transform stage with empty histories.
+/// \param hilbert The stage to initialize
+/// \param sideband Which side of the carrier the audio is
+void fixed_hilbert_init(struct fixed_hilbert *hilbert, enum hilbert_sideband sideband);
+
+/// \brief Real audio to complex baseband, as hilbert_analytic.
+/// \param arg The struct fixed_hilbert
+/// \param in The audio
+/// \param out Receives the I/Q pairs, which may be the same buffer
+/// \param len The number of values
+void fixed_hilbert_analytic(void *arg, const int16_t *in, int16_t *out, size_t len);
+
+/// \brief Complex baseband to real audio, as hilbert_real.
+/// \param arg The struct fixed_hilbert
+/// \param in The I/Q pairs
+/// \param out Receives the audio, which may be the same buffer
+/// \param len The number of values
+void fixed_hilbert_real(void *arg, const int16_t *in, int16_t *out, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_FIXED_H
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fsk.c
+/// @brief Binary FSK modem for audio modes: a continuous phase modulator and a sliding Goertzel demodulator
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "fsk.h"
+#include "tables.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// A full turn of a 32 bit phase
+#define FSK_PHASE_TURN 4294967296.0
+
+// Half a turn: the middle of a bit
+#define FSK_PHASE_HALF 0x80000000U
+
+// The share of a timing error taken out at each transition.  Small enough that a noisy transition can't throw the
+// clock far off, large enough to follow a sender whose clock differs from ours by a percent or two.
+#define FSK_CLOCK_GAIN_SHIFT 2
+
+// How many windows it takes for the damping in the sliding filters to lose a factor of e.  Without it rounding errors
+// would build up in them forever.
+#define FSK_DAMPING_WINDOWS 64
+
+// The share of the window's energy the two tones must make up for us to decode.  A clean tone is 0.5.
+#define FSK_SQUELCH 0.2F
+
+// The bits in a byte on the air: start, eight data and stop
+#define FSK_FRAME_BITS 10
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Fit a baud rate to what the sample rate allows.
+/// \param sample_rate The sample rate in Hz
+/// \param baud The baud rate asked for
+/// \return The nearest baud rate we can do
+static unsigned int fsk_fit_baud(const uint32_t sample_rate, const unsigned int baud) {
+    const unsigned int min = (sample_rate + FSK_MAX_WINDOW - 1) / FSK_MAX_WINDOW;
+    const unsigned int max = sample_rate / FSK_MIN_SAMPLES_PER_BIT;
+    if (baud < min)
+        return min;
+    if (baud > max)
+        return max;
+    return baud;
+}
+
+/// \brief Work out the tones for a baud rate.
+/// \param baud The baud rate
+/// \param space Receives the space frequency in Hz
+/// \param mark Receives the mark frequency in Hz
+static void fsk_tones(const unsigned int baud, double *space, double *mark) {
+    const double center = baud > FSK_CENTER_HZ ? (double) baud : FSK_CENTER_HZ;
+    *space = center - baud / 2.0;
+    *mark = center + baud / 2.0;
+}
+
+/// \brief Turn a frequency into a step for a 32 bit phase.
+/// \param hz The frequency in Hz
+/// \param sample_rate The sample rate in Hz
+/// \return The step per sample
+static uint32_t fsk_phase_step(const double hz, const uint32_t sample_rate) {
+    return (uint32_t) llround(hz / sample_rate * FSK_PHASE_TURN);
+}
+
+/// \brief Take the next byte from the queue, if there is one.
+/// \param mod The modulator
+/// \param byte Receives the byte
+/// \return true if there was a byte
+static bool fsk_dequeue(struct fsk_modulator *mod, uint8_t *byte) {
+    const size_t head = atomic_load_explicit(&mod->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&mod->tail, memory_order_acquire))
+        return false;
+
+    *byte = mod->queue[head % FSK_TX_QUEUE];
+    atomic_store_explicit(&mod->head, head + 1, memory_order_release);
+    return true;
+}
+
+/// \brief Move on to the next bit at the end of one.
+/// \param mod The modulator
+static void fsk_next_bit(struct fsk_modulator *mod) {
+    if (mod->frame_bits > 1) {
+        mod->frame >>= 1;
+        --mod->frame_bits;
+        return;
+    }
+
+    uint8_t byte;
+    if (fsk_dequeue(mod, &byte)) {
+        mod->frame = (uint16_t) (1U << (FSK_FRAME_BITS - 1) | (unsigned int) byte << 1);
+        mod->frame_bits = FSK_FRAME_BITS;
+    } else {
+        mod->frame_bits = 0;
+    }
+}
+
+/// \brief Feed a bit sampled by the bit clock to the framing.
+/// \param demod The demodulator
+/// \param mark The bit
+/// \param carrier Whether the tones were there to decode
+static void fsk_uart_bit(struct fsk_demodulator *demod, const bool mark, const bool carrier) {
+    if (!carrier) {
+        demod->state = FSK_UART_IDLE;
+        return;
+    }
+
+    switch (demod->state) {
+        case FSK_UART_IDLE:
+            if (!mark) {
+                demod->state = FSK_UART_DATA;
+                demod->bits = 0;
+                demod->byte = 0;
+            }
+            break;
+        case FSK_UART_DATA:
+            demod->byte |= (uint8_t) ((unsigned int) mark << demod->bits);
+            if (++demod->bits == 8)
+                demod->state = FSK_UART_STOP;
+            break;
+        case FSK_UART_STOP:
+            if (!mark) {
+                ++demod->framing_errors;
+            } else if (demod->num_decoded == FSK_RX_BUFFER) {
+                ++demod->overruns;
+            } else {
+                demod->decoded[demod->num_decoded++] = demod->byte;
+                ++demod->bytes;
+            }
+            demod->state = FSK_UART_IDLE;
+            break;
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void fsk_modulator_init(struct fsk_modulator *mod, const uint32_t sample_rate, const unsigned int baud) {
+    memset(mod, 0, sizeof(*mod));
+    mod->sample_rate = sample_rate;
+    mod->amplitude = 1.0F;
+    fsk_modulator_set_baud(mod, baud);
+}
+
+void fsk_modulator_set_baud(struct fsk_modulator *mod, const unsigned int baud) {
+    mod->requested = baud;
+    mod->baud = fsk_fit_baud(mod->sample_rate, baud);
+
+    double space;
+    double mark;
+    fsk_tones(mod->baud, &space, &mark);
+    mod->space_step = fsk_phase_step(space, mod->sample_rate);
+    mod->mark_step = fsk_phase_step(mark, mod->sample_rate);
+    mod->bit_step = fsk_phase_step(mod->baud, mod->sample_rate);
+}
+
+size_t fsk_modulator_queue(struct fsk_modulator *mod, const uint8_t *data, const size_t len) {
+    const size_t tail = atomic_load_explicit(&mod->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&mod->head, memory_order_acquire);
+    const size_t space = FSK_TX_QUEUE - (tail - head);
+    const size_t n = len < space ? len : space;
+
+    for (size_t i = 0; i < n; ++i)
+        mod->queue[(tail + i) % FSK_TX_QUEUE] = data[i];
+    atomic_store_explicit(&mod->tail, tail + n, memory_order_release);
+
+    if (n < len)
+        atomic_fetch_add_explicit(&mod->dropped, len - n, memory_order_relaxed);
+    return n;
+}
+
+bool fsk_modulator_queue_whole(struct fsk_modulator *mod, const uint8_t *data, const size_t len) {
+    const size_t tail = atomic_load_explicit(&mod->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&mod->head, memory_order_acquire);
+    if (FSK_TX_QUEUE - (tail - head) < len) {
+        atomic_fetch_add_explicit(&mod->dropped, len, memory_order_relaxed);
+        return false;
+    }
+    return fsk_modulator_queue(mod, data, len) == len;
+}
+
+void fsk_modulate(void *arg, const float *in __attribute__((unused)), float *out, const size_t len) {
+    struct fsk_modulator *mod = arg;
+    uint32_t phase = mod->phase;
+    uint32_t bit_phase = mod->bit_phase;
+    bool mark = mod->frame_bits == 0 || (mod->frame & 1U) != 0;
+
+    for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {
+        const uint32_t last = bit_phase;
+        bit_phase += mod->bit_step;
+        if (bit_phase < last) {
+            fsk_next_bit(mod);
+            mark = mod->frame_bits == 0 || (mod->frame & 1U) != 0;
+        }
+
+        out[i] = out[i + 1] = mod->amplitude * tables_sine[phase >> (32 - FSK_SINE_BITS)];
+        phase += mark ? mod->mark_step : mod->space_step;
+    }
+
+    mod->phase = phase;
+    mod->bit_phase = bit_phase;
+}
+
+void fsk_demodulator_init(struct fsk_demodulator *demod, const uint32_t sample_rate, const unsigned int baud) {
+    memset(demod, 0, sizeof(*demod));
+    demod->sample_rate = sample_rate;
+    fsk_demodulator_set_baud(demod, baud);
+}
+
+void fsk_demodulator_set_baud(struct fsk_demodulator *demod, const unsigned int baud) {
+    demod->requested = baud;
+    demod->baud = fsk_fit_baud(demod->sample_rate, baud);
+
+    unsigned int window_len = (unsigned int) lround((double) demod->sample_rate / demod->baud);
+    if (window_len > FSK_MAX_WINDOW)
+        window_len = FSK_MAX_WINDOW;
+    demod->window_len = window_len;
+    demod->window_pos = 0;
+    memset(demod->window, 0, sizeof(demod->window));
+
+    // Each bin is the sum over the window of the samples turned by the tone's frequency, so every sample it is turned
+    // one step further, the new sample is added and the one leaving the window, turned all the way round, is taken
+    // away.  The damping applies to the turning too so that whatever error builds up decays.
+    const double damping = exp(-1.0 / (FSK_DAMPING_WINDOWS * (double) window_len));
+    const double leave_damping = pow(damping, window_len);
+    double tones[2];
+    fsk_tones(demod->baud, &tones[0], &tones[1]);
+    for (int t = 0; t < 2; ++t) {
+        const double w = 2.0 * M_PI * tones[t] / demod->sample_rate;
+        demod->rotate_re[t] = (float) (damping * cos(w));
+        demod->rotate_im[t] = (float) (damping * sin(w));
+        demod->leave_re[t] = (float) (leave_damping * cos(w * window_len));
+        demod->leave_im[t] = (float) (leave_damping * sin(w * window_len));
+        demod->bin_re[t] = 0.0F;
+        demod->bin_im[t] = 0.0F;
+    }
+    demod->damping = (float) damping;
+    demod->leave_damping = (float) leave_damping;
+    demod->energy = 0.0F;
+
+    demod->bit_phase = 0;
+    demod->bit_step = fsk_phase_step(demod->baud, demod->sample_rate);
+    demod->last_mark = true;
+    demod->state = FSK_UART_IDLE;
+}
+
+void fsk_demodulate(void *arg, const float *in, float *out, const size_t len) {
+    struct fsk_demodulator *demod = arg;
+    const unsigned int window_len = demod->window_len;
+    unsigned int pos = demod->window_pos;
+    float space_re = demod->bin_re[0];
+    float space_im = demod->bin_im[0];
+    float mark_re = demod->bin_re[1];
+    float mark_im = demod->bin_im[1];
+    float energy = demod->energy;
+    const float squelch = FSK_SQUELCH * (float) window_len;
+
+    for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {
+        const float x = in[i];
+        const float old = demod->window[pos];
+        demod->window[pos] = x;
+        if (++pos == window_len)
+            pos = 0;
+
+        float re = x + demod->rotate_re[0] * space_re - demod->rotate_im[0] * space_im - demod->leave_re[0] * old;
+        space_im = demod->rotate_re[0] * space_im + demod->rotate_im[0] * space_re - demod->leave_im[0] * old;
+        space_re = re;
+        re = x + demod->rotate_re[1] * mark_re - demod->rotate_im[1] * mark_im - demod->leave_re[1] * old;
+        mark_im = demod->rotate_re[1] * mark_im + demod->rotate_im[1] * mark_re - demod->leave_im[1] * old;
+        mark_re = re;
+        energy = x * x + demod->damping * energy - demod->leave_damping * old * old;
+
+        const float space_power = space_re * space_re + space_im * space_im;
+        const float mark_power = mark_re * mark_re + mark_im * mark_im;
+        const bool mark = mark_power > space_power;
+
+        // The decision flips when the window is half way across a change of tone, half a bit after it really
+        // happened, so that is where the middle of the bit clock belongs.  The leading edge of a start bit sets the
+        // clock outright since nothing before it says anything about when this byte was sent.
+        if (mark != demod->last_mark) {
+            if (demod->state == FSK_UART_IDLE && !mark) {
+                demod->bit_phase = FSK_PHASE_HALF;
+            } else {
+                demod->bit_phase -= (uint32_t) ((int32_t) (demod->bit_phase - FSK_PHASE_HALF) >> FSK_CLOCK_GAIN_SHIFT);
+            }
+            demod->last_mark = mark;
+        }
+
+        // At the end of the bit clock's cycle the window holds exactly one bit.
+        const uint32_t last = demod->bit_phase;
+        demod->bit_phase += demod->bit_step;
+        if (demod->bit_phase < last)
+            fsk_uart_bit(demod, mark, space_power + mark_power > squelch * energy);
+    }
+
+    demod->window_pos = pos;
+    demod->bin_re[0] = space_re;
+    demod->bin_im[0] = space_im;
+    demod->bin_re[1] = mark_re;
+    demod->bin_im[1] = mark_im;
+    demod->energy = energy;
+
+    if (in != out)
+        memcpy(out, in, len * sizeof(*out));
+}
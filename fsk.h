@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file fsk.h
+/// @brief Binary FSK modem for audio modes: a continuous phase modulator and a sliding Goertzel demodulator
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// Bytes are sent asynchronously, as a serial port would: a space start bit, eight data bits least significant first
+/// and a mark stop bit, with mark between bytes.  The tones are centered on FSK_CENTER_HZ and one baud apart, which
+/// keeps them orthogonal over a bit for the non-coherent demodulator.  At high baud rates the center moves up to make
+/// room.
+///
+/// The demodulator runs a sliding single-bin DFT, a Goertzel filter updated every sample, for each tone over the
+/// last bit's worth of samples and decides on whichever is stronger.  A bit clock recovers the timing from the
+/// transitions between tones and is set outright at the leading edge of each start bit.  It only decodes while the
+/// two tones make up most of the energy in the window, so noise doesn't come out as bytes.
+
+#ifndef WAVEFORM_EXAMPLE_FSK_H
+#define WAVEFORM_EXAMPLE_FSK_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The audio frequency the tones are centered on, in Hz
+#define FSK_CENTER_HZ 1500
+
+/// \brief The longest bit the demodulator handles, in samples.  Slower baud rates are raised to fit.
+#define FSK_MAX_WINDOW 1024
+
+/// \brief The shortest bit either side handles, in samples.  Faster baud rates are lowered to fit.
+#define FSK_MIN_SAMPLES_PER_BIT 8
+
+/// \brief The bytes that can wait to be transmitted
+#define FSK_TX_QUEUE 4096
+
+/// \brief The decoded bytes held until the receive callback hands them on
+#define FSK_RX_BUFFER 256
+
+/// \brief log2 of the size of the modulator's sine table, tables_sine
+#define FSK_SINE_BITS 10
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The modulator.  The queue is written by the byte data callback and read by the transmit data callback.
+struct fsk_modulator {
+    uint32_t sample_rate;
+    unsigned int baud;          ///< The baud rate in use, after fitting it to the sample rate
+    unsigned int requested;     ///< The baud rate last asked for
+    float amplitude;
+
+    uint32_t phase;             ///< The tone's phase, carried across bits and packets so that it never jumps
+    uint32_t mark_step;
+    uint32_t space_step;
+    uint32_t bit_phase;         ///< Where we are in the current bit, wrapping at the end of it
+    uint32_t bit_step;
+    uint16_t frame;             ///< The bits of the current byte still to send, least significant first
+    unsigned int frame_bits;
+
+    uint8_t queue[FSK_TX_QUEUE];
+    _Atomic size_t head;        ///< Written by the consumer
+    _Atomic size_t tail;        ///< Written by the producer
+    _Atomic uint64_t dropped;   ///< Bytes that didn't fit in the queue
+};
+
+/// \brief Where the demodulator is in a byte
+enum fsk_uart_state {
+    FSK_UART_IDLE,
+    FSK_UART_DATA,
+    FSK_UART_STOP,
+};
+
+/// \brief The demodulator.  Only ever touched by the receive data callback.
+struct fsk_demodulator {
+    uint32_t sample_rate;
+    unsigned int baud;
+    unsigned int requested;
+
+    // The sliding window: the last bit's worth of samples
+    float window[FSK_MAX_WINDOW];
+    unsigned int window_len;
+    unsigned int window_pos;
+
+    // The Goertzel bins for space (0) and mark (1), updated every sample.  Each is a complex sum over the window.
+    float bin_re[2];
+    float bin_im[2];
+    float rotate_re[2];         ///< The per-sample rotation, damped slightly so that rounding errors die away
+    float rotate_im[2];
+    float leave_re[2];          ///< What the sample leaving the window was multiplied by on its way through
+    float leave_im[2];
+    float energy;               ///< The sum of the squares of the window, damped the same way
+    float damping;
+    float leave_damping;
+
+    // Clock recovery
+    uint32_t bit_phase;         ///< Where we are in the current bit; the bit is sampled as this wraps
+    uint32_t bit_step;
+    bool last_mark;
+
+    // Framing
+    enum fsk_uart_state state;
+    unsigned int bits;
+    uint8_t byte;
+
+    uint8_t decoded[FSK_RX_BUFFER];
+    size_t num_decoded;
+
+    uint64_t bytes;
+    uint64_t framing_errors;
+    uint64_t overruns;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a modulator with an empty queue.
+/// \param mod The modulator to initialize
+/// \param sample_rate The sample rate in Hz
+/// \param baud The baud rate, which is fitted to what the sample rate allows
+void fsk_modulator_init(struct fsk_modulator *mod, uint32_t sample_rate, unsigned int baud);
+
+/// \brief Change the modulator's baud rate.  Anything still queued is sent at the new rate.
+/// \param mod The modulator
+/// \param baud The baud rate, which is fitted to what the sample rate allows
+void fsk_modulator_set_baud(struct fsk_modulator *mod, unsigned int baud);
+
+/// \brief Queue bytes to be sent.  Only one thread may call this.
+/// \param mod The modulator
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return The number queued, which is less than len if the queue filled up
+size_t fsk_modulator_queue(struct fsk_modulator *mod, const uint8_t *data, size_t len);
+
+/// \brief Queue bytes to be sent only if they all fit, for data such as a FEC frame that is no use in part.  Only the
+/// thread that calls fsk_modulator_queue may call this.
+/// \param mod The modulator
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return true if they were queued, otherwise false, and none of them were
+bool fsk_modulator_queue_whole(struct fsk_modulator *mod, const uint8_t *data, size_t len);
+
+/// \brief The modulator as a DSP stage.  It ignores its input and writes the same signal to both floats of each
+/// sample.  See dsp.h.
+/// \param arg The struct fsk_modulator
+/// \param in Unused
+/// \param out Receives the modulated signal
+/// \param len The number of floats
+void fsk_modulate(void *arg, const float *in, float *out, size_t len);
+
+/// \brief Initialize a demodulator.
+/// \param demod The demodulator to initialize
+/// \param sample_rate The sample rate in Hz
+/// \param baud The baud rate, which is fitted to what the sample rate allows
+void fsk_demodulator_init(struct fsk_demodulator *demod, uint32_t sample_rate, unsigned int baud);
+
+/// \brief Change the demodulator's baud rate.  This starts it afresh.
+/// \param demod The demodulator
+/// \param baud The baud rate, which is fitted to what the sample rate allows
+void fsk_demodulator_set_baud(struct fsk_demodulator *demod, unsigned int baud);
+
+/// \brief The demodulator as a DSP stage.  It decodes the first float of each sample and passes its input through
+/// unchanged so that the operator can listen.  Decoded bytes collect in demod->decoded.  See dsp.h.
+/// \param arg The struct fsk_demodulator
+/// \param in The received signal
+/// \param out Receives a copy of in, which may be the same buffer
+/// \param len The number of floats
+void fsk_demodulate(void *arg, const float *in, float *out, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_FSK_H
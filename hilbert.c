@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file hilbert.c
+/// @brief Hilbert transform stages between the radio's real audio and complex baseband
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "hilbert.h"
+#include "simd.h"
+#include "tables.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The partial sums of the dot product kept at once, which HILBERT_PHASE_TAPS must be a multiple of in vectors
+#define HILBERT_SUMS 4
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Take in the next sample of a signal.
+/// \param fir The signal's history
+/// \param x The sample
+static inline void hilbert_push(struct hilbert_fir *fir, const float x) {
+    const unsigned int phase = fir->phase;
+    const unsigned int pos = fir->pos[phase];
+    fir->history[phase][pos] = fir->history[phase][pos + HILBERT_PHASE_TAPS] = x;
+    fir->pos[phase] = (pos + 1) % HILBERT_PHASE_TAPS;
+    fir->phase = phase ^ 1;
+}
+
+/// \brief The Hilbert transform of a signal, as of the sample last taken in.  Only the half that sample went in has
+/// taps that aren't zero.
+/// \param fir The signal's history
+/// \param taps The taps that aren't zero
+/// \return The transform, HILBERT_DELAY samples late
+static inline float hilbert_transform(const struct hilbert_fir *fir, const float *taps) {
+    const unsigned int phase = fir->phase ^ 1;
+    const float *window = fir->history[phase] + fir->pos[phase];
+
+    // Four sums side by side, so that each add doesn't have to wait for the one before
+    simd_v4f sum[HILBERT_SUMS] = {{0.0F}};
+    for (unsigned int i = 0; i < HILBERT_PHASE_TAPS; i += SIMD_LANES * HILBERT_SUMS)
+        for (unsigned int j = 0; j < HILBERT_SUMS; ++j)
+            sum[j] += simd_load(window + i + j * SIMD_LANES) * simd_load(taps + i + j * SIMD_LANES);
+
+    const simd_v4f total = (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    return (total[0] + total[1]) + (total[2] + total[3]);
+}
+
+/// \brief A signal, delayed to line up with its Hilbert transform.  The sample HILBERT_DELAY back is in the other
+/// half, in the middle of its window.
+/// \param fir The signal's history
+/// \return The sample HILBERT_DELAY before the one last taken in
+static inline float hilbert_delayed(const struct hilbert_fir *fir) {
+    const unsigned int phase = fir->phase;
+    return fir->history[phase][fir->pos[phase] + HILBERT_PHASE_TAPS / 2];
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void hilbert_init(struct hilbert *hilbert, const enum hilbert_sideband sideband) {
+    memset(hilbert, 0, sizeof(*hilbert));
+    hilbert->sign = (float) sideband;
+}
+
+void hilbert_analytic(void *arg, const float *in, float *out, const size_t len) {
+    struct hilbert *hilbert = arg;
+    struct hilbert_fir *fir = &hilbert->fir[0];
+
+    for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {
+        hilbert_push(fir, in[i]);
+        out[i + 1] = hilbert->sign * hilbert_transform(fir, tables_hilbert_taps);
+        out[i] = hilbert_delayed(fir);
+    }
+}
+
+void hilbert_real(void *arg, const float *in, float *out, const size_t len) {
+    struct hilbert *hilbert = arg;
+    struct hilbert_fir *fir_i = &hilbert->fir[0];
+    struct hilbert_fir *fir_q = &hilbert->fir[1];
+
+    // For the analytic signal of x, the transform of the imaginary part is -x, so this gives back x.  Any negative
+    // frequencies cancel.
+    for (size_t i = 0; i + 1 < len; i += DSP_FLOATS_PER_SAMPLE) {
+        hilbert_push(fir_i, in[i]);
+        hilbert_push(fir_q, in[i + 1]);
+        out[i] = out[i + 1] =
+            0.5F * (hilbert_delayed(fir_i) - hilbert->sign * hilbert_transform(fir_q, tables_hilbert_taps));
+    }
+}
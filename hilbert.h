@@ -0,0 +1,104 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file hilbert.h
+/// @brief Hilbert transform stages between the radio's real audio and complex baseband
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// In RAW mode the radio's sample pairs are I/Q; in the audio modes such as DIGU and DIGL they are the same real audio
+/// on left and right.  hilbert_analytic turns the audio into the analytic signal, the audio plus j times its Hilbert
+/// transform, whose negative frequencies are gone.  That is complex baseband as RAW mode would have it, with the
+/// carrier at 0 Hz, so the same complex stages serve both.  hilbert_real goes back the other way, keeping only the
+/// positive frequencies of whatever the complex stages made, as the radio's SSB modulator would.  For DIGL the sign
+/// of the imaginary part is flipped, so that positive frequencies are always above the carrier.
+///
+/// The Hilbert transformer is a windowed FIR of HILBERT_TAPS taps.  Every other tap of a Hilbert transformer is zero,
+/// so the history is kept as two polyphase halves, the even and the odd samples, and each output only needs the
+/// half whose taps aren't zero: a dot product of HILBERT_PHASE_TAPS consecutive floats, done four at a time (see
+/// simd.h).  The other half gives the real part, delayed to line up.  The taps, a Blackman windowed ideal Hilbert
+/// transformer, are generated at build time by tools/gen_tables.py as tables_hilbert_taps.
+
+#ifndef WAVEFORM_EXAMPLE_HILBERT_H
+#define WAVEFORM_EXAMPLE_HILBERT_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stddef.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The taps of the Hilbert transformer that aren't zero, which is also the length of each polyphase half.  At
+/// 24kHz this is flat to better than 0.1% from 300Hz up to 11.7kHz.
+#define HILBERT_PHASE_TAPS 128
+
+/// \brief The length of the Hilbert transformer.  Its delay, half of one less than this, is odd.
+#define HILBERT_TAPS (2 * HILBERT_PHASE_TAPS - 1)
+
+/// \brief The delay through the Hilbert transformer, in samples
+#define HILBERT_DELAY (HILBERT_TAPS / 2)
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Which side of the carrier the audio is
+enum hilbert_sideband {
+    HILBERT_USB = 1,
+    HILBERT_LSB = -1,
+};
+
+/// \brief The history of one real signal, in two polyphase halves.  Each half is a ring stored twice over, so that
+/// the last HILBERT_PHASE_TAPS samples are always contiguous.
+struct hilbert_fir {
+    float history[2][2 * HILBERT_PHASE_TAPS];
+    unsigned int pos[2];
+    unsigned int phase;         ///< Which half the next sample goes in
+};
+
+/// \brief A Hilbert transform stage.  The receive side uses one history, for the audio; the transmit side uses one
+/// for each of I and Q.
+struct hilbert {
+    float sign;                 ///< 1 for USB, -1 for LSB
+    struct hilbert_fir fir[2];
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a stage with empty histories.
+/// \param hilbert The stage to initialize
+/// \param sideband Which side of the carrier the audio is
+void hilbert_init(struct hilbert *hilbert, enum hilbert_sideband sideband);
+
+/// \brief Real audio to complex baseband, as a DSP stage.  It takes the first float of each sample as the audio and
+/// writes I and Q, HILBERT_DELAY samples late.  See dsp.h.
+/// \param arg The struct hilbert
+/// \param in The audio
+/// \param out Receives the I/Q pairs, which may be the same buffer
+/// \param len The number of floats
+void hilbert_analytic(void *arg, const float *in, float *out, size_t len);
+
+/// \brief Complex baseband to real audio, as a DSP stage.  It writes the audio to both floats of each sample,
+/// HILBERT_DELAY samples late.  See dsp.h.
+/// \param arg The struct hilbert
+/// \param in The I/Q pairs
+/// \param out Receives the audio, which may be the same buffer
+/// \param len The number of floats
+void hilbert_real(void *arg, const float *in, float *out, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_HILBERT_H
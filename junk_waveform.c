@@ -0,0 +1,529 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file junk_waveform.c
+/// @brief The JUNK waveform's sample data path
+///
+/// @copyright Copyright (c) 2020 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// The data callbacks live here rather than in main.c so that the replay driver can run them against captured
+/// packets without a radio.
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "agc.h"
+#include "capture.h"
+#include "commands.h"
+#include "dsp.h"
+#include "fixed.h"
+#include "fsk.h"
+#include "hilbert.h"
+#include "junk_waveform.h"
+#include "metrics.h"
+#include "ofdm.h"
+#include "realtime.h"
+#include "sigmf.h"
+#include "tables.h"
+#include "telemetry.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// A drop in the received level of more than this many dB from the highest it has been since the last drop triggers a
+// SigMF recording
+#define JUNK_LEVEL_DROP_TRIGGER_DB 20.0F
+
+// Levels below this, in dBFS, count as no signal at all, so that a drop is always from a signal worth recording
+#define JUNK_LEVEL_FLOOR_DB (-60.0F)
+
+// How quickly the received level falls away once the signal stops, in seconds, so that the gaps in speech or between
+// bursts don't count as drops
+#define JUNK_LEVEL_DECAY_S 0.5F
+
+// The operations fused into the tone stages, in order.  See dsp.h.
+#define JUNK_TONE_CHAIN(X) X(tone) X(gain)
+
+// The shift stages' operation
+#define JUNK_SHIFT_CHAIN(X) X(rotate)
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+#ifndef JUNK_FIXED_POINT
+/// \brief The tone stage: the sine wave at the "set" gain, made in a single pass over the packet.  The tone is real
+/// audio, so it runs in mono graphs.  The fixed point build uses the ones in fixed.h instead, here and for the shift.
+DSP_FUSED_MONO_STAGE(junk_tone_run, struct junk_tone_stage, JUNK_TONE_CHAIN)
+
+/// \brief The shift stage: complex baseband moved up or down in frequency.
+DSP_FUSED_STAGE(junk_shift_run, struct junk_shift_stage, JUNK_SHIFT_CHAIN)
+#else
+/// \brief Build the fixed point graphs that the DSP graphs run instead of the float tone, shift and Hilbert stages.
+/// Call it once the float stages are set up, since the Q15 ones follow their oscillators and gains.
+/// \param ctx The waveform context
+/// \param audio Whether the modems' graphs go between real audio and complex baseband
+/// \param sideband Which side of the carrier the audio is
+static void junk_q15_init(struct junk_context *ctx, const bool audio, const enum hilbert_sideband sideband) {
+    struct junk_q15_stages *q15 = &ctx->q15;
+    const int16_t *tone = TABLES_TONE_Q15(JUNK_SAMPLE_RATE_HZ);
+    const unsigned int tone_len = TABLES_TONE_LEN(JUNK_SAMPLE_RATE_HZ);
+    fixed_tone_init(&q15->rx_tone, tone, tone_len, &ctx->rx_nco, &ctx->rx_tone.gain.gain);
+    fixed_tone_init(&q15->tx_tone, tone, tone_len, &ctx->tx_nco, &ctx->tx_tone.gain.gain);
+    fixed_hilbert_init(&q15->rx_analytic, sideband);
+    fixed_hilbert_init(&q15->rx_real, sideband);
+    fixed_hilbert_init(&q15->tx_analytic, sideband);
+    fixed_hilbert_init(&q15->tx_real, sideband);
+    fixed_rotate_init(&q15->rx_shift, &ctx->rx_shift.rotate.osc);
+    fixed_rotate_init(&q15->tx_shift, &ctx->tx_shift.rotate.osc);
+
+    fixed_graph_init(&q15->rx_tone_graph);
+    fixed_graph_add_source(&q15->rx_tone_graph, "tone+gain", fixed_tone_process, &q15->rx_tone);
+    fixed_graph_init(&q15->tx_tone_graph);
+    fixed_graph_add_source(&q15->tx_tone_graph, "tone+gain", fixed_tone_process, &q15->tx_tone);
+
+    fixed_graph_init(&q15->rx_baseband);
+    fixed_graph_init(&q15->rx_audio);
+    fixed_graph_init(&q15->tx_modem);
+    if (audio) {
+        fixed_graph_add(&q15->rx_baseband, "analytic", fixed_hilbert_analytic, &q15->rx_analytic);
+        fixed_graph_add(&q15->tx_modem, "analytic", fixed_hilbert_analytic, &q15->tx_analytic);
+    }
+    fixed_graph_add(&q15->rx_baseband, "shift", fixed_rotate_process, &q15->rx_shift);
+    fixed_graph_add(&q15->tx_modem, "shift", fixed_rotate_process, &q15->tx_shift);
+    if (audio) {
+        fixed_graph_add(&q15->rx_audio, "real", fixed_hilbert_real, &q15->rx_real);
+        fixed_graph_add(&q15->tx_modem, "real", fixed_hilbert_real, &q15->tx_real);
+    }
+}
+#endif
+
+/// \brief Whether a submode runs one of the modems, whose byte data is the client's own.
+/// \param submode The submode
+/// \return true for the modems
+static inline bool junk_submode_is_modem(const uint32_t submode) {
+    return submode == JUNK_SUBMODE_FSK || submode == JUNK_SUBMODE_OFDM;
+}
+
+/// \brief Send samples to the radio and count them.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param samples The samples
+/// \param num_samples The number of floats in samples
+/// \param type SPEAKER_DATA or TRANSMITTER_DATA
+static void junk_send(struct waveform_t *waveform, struct junk_context *ctx, float *samples, const size_t num_samples,
+                      const enum waveform_packet_type type) {
+    waveform_send_data_packet(waveform, samples, num_samples, type);
+
+    const bool speaker = type == SPEAKER_DATA;
+    metrics_add(ctx->metrics, speaker ? METRICS_PACKETS_OUT_SPEAKER : METRICS_PACKETS_OUT_TRANSMITTER, 1);
+    metrics_add(ctx->metrics, speaker ? METRICS_SAMPLES_OUT_SPEAKER : METRICS_SAMPLES_OUT_TRANSMITTER, num_samples);
+}
+
+/// \brief Send byte data to the client and count it.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param data The bytes
+/// \param len The number of bytes
+static void junk_send_bytes(struct waveform_t *waveform, struct junk_context *ctx, uint8_t *data, const size_t len) {
+    waveform_send_byte_data_packet(waveform, data, len);
+    metrics_add(ctx->metrics, METRICS_BYTE_PACKETS_OUT, 1);
+    metrics_add(ctx->metrics, METRICS_BYTES_OUT, len);
+}
+
+/// \brief Send what a modem decoded to the client, through the FEC deframer if "set fec=on".
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param params The parameters in use for this packet
+/// \param data The decoded bytes
+/// \param len The number of bytes
+static void junk_send_decoded(struct waveform_t *waveform, struct junk_context *ctx,
+                              const struct junk_params *params, uint8_t *data, const size_t len) {
+    if (params->fec != JUNK_FEC_ON) {
+        junk_send_bytes(waveform, ctx, data, len);
+        return;
+    }
+
+    fec_deframe(&ctx->fec_rx, data, len);
+    if (ctx->fec_rx.num_decoded > 0) {
+        junk_send_bytes(waveform, ctx, ctx->fec_rx.decoded, ctx->fec_rx.num_decoded);
+        ctx->fec_rx.num_decoded = 0;
+    }
+}
+
+/// \brief Follow the level of the received signal and trigger a SigMF recording when it drops away.
+/// A signal dropping away is exactly the kind of thing we want to be able to look at afterwards, along with the seconds
+/// leading up to it.  The level is each packet's peak as it arrives from the radio, whatever the graph then does with
+/// it.  It rises at once and falls away over JUNK_LEVEL_DECAY_S, and a drop is measured from the highest peak heard
+/// rather than from the last packet.  Once a drop has triggered, the highest starts again from this packet's peak
+/// rather than the level still falling away, so that a signal that stays gone triggers once.
+/// \param ctx The waveform context
+/// \param samples The received samples
+/// \param len The number of floats
+/// \param recording Whether the SigMF recorder is there to trigger
+static void junk_rx_level(struct junk_context *ctx, const float *samples, const size_t len, const bool recording) {
+    const size_t num_samples = len / DSP_FLOATS_PER_SAMPLE;
+    if (num_samples == 0) {
+        return;
+    }
+
+    // Packets are nearly always the same size, so the exponential is only worked out once.
+    if (num_samples != ctx->rx_level_len) {
+        ctx->rx_level_decay = expf(-(float) num_samples / (JUNK_SAMPLE_RATE_HZ * JUNK_LEVEL_DECAY_S));
+        ctx->rx_level_len = num_samples;
+    }
+
+    const float floor = powf(10.0F, JUNK_LEVEL_FLOOR_DB / 20.0F);
+    const float peak = agc_block_peak(samples, len);
+    ctx->rx_level = fmaxf(peak, ctx->rx_level * ctx->rx_level_decay);
+
+    const float heard = fmaxf(peak, floor);
+    if (heard > ctx->rx_level_hold) {
+        ctx->rx_level_hold = heard;
+    } else if (fmaxf(ctx->rx_level, floor) < ctx->rx_level_hold * powf(10.0F, -JUNK_LEVEL_DROP_TRIGGER_DB / 20.0F)) {
+        if (recording) {
+            sigmf_recorder_trigger(ctx->sigmf, "level drop");
+        }
+        ctx->rx_level_hold = heard;
+    }
+}
+
+/// \brief Send the meters to the radio and time it.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+static void junk_meters_send(struct waveform_t *waveform, struct junk_context *ctx) {
+    if (ctx->metrics == NULL) {
+        waveform_meters_send(waveform);
+        return;
+    }
+
+    const int64_t start_ns = telemetry_now_ns();
+    waveform_meters_send(waveform);
+    metrics_observe(ctx->metrics, METRICS_METER_SEND, telemetry_now_ns() - start_ns);
+    metrics_add(ctx->metrics, METRICS_METER_SENDS, 1);
+}
+
+/// \brief Process an incoming receiver packet.
+/// This is called once for every packet we receive from the
+/// radio.  In this case we just clear out the samples we receive, replace them with the proper sine wave values, and
+/// send it to the radio for the speaker data using waveform_send_data_packet.  We use the context passed to us that
+/// we set in the registration command to keep track of our current phase and meter data.  After sending a packet we
+/// update the meter data and send that to the radio as well.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
+///               The various accessor functions should be used to access the data such as get_packet_len() used here.
+static void junk_rx(struct waveform_t *waveform, struct junk_context *ctx, struct waveform_vita_packet *packet) {
+    // Record the packet exactly as the radio sent it, whether or not we are going to use it, so that a replay sees
+    // the same stream we did.
+    if (ctx->capture != NULL) {
+        capture_write(ctx->capture, CAPTURE_RX, ctx->tx ? CAPTURE_FLAG_TX : 0, packet);
+    }
+
+    // Keep the receive stream for the SigMF recorder.  This only copies the samples into memory that was set up ahead
+    // of time; the files are finished off on the recorder's own thread.  Just after ACTIVE the recorder and the OFDM
+    // modem's buffers may not be there yet, and then we simply go without.
+    const bool held = lifecycle_enter(&ctx->lifecycle);
+    const bool recording = held && ctx->sigmf != NULL;
+    if (recording) {
+        struct timespec ts;
+        get_packet_ts(packet, &ts);
+        sigmf_recorder_write(ctx->sigmf, get_packet_data(packet), get_packet_len(packet), &ts);
+    }
+
+    if (ctx->tx) {
+        if (held) {
+            lifecycle_exit(&ctx->lifecycle);
+        }
+        return;
+    }
+
+    // Remember the timestamp of the latest packet so that timed commands can be lined up with the sample stream.  The
+    // integer seconds go in the top half and the sample count within the second in the bottom half.
+    atomic_store_explicit(&ctx->last_rx_timestamp,
+                          (uint64_t) get_packet_ts_int(packet) << 32 | (uint32_t) get_packet_ts_frac(packet),
+                          memory_order_relaxed);
+
+    // Pick up the parameters from the latest "set" command.  This never blocks the command callbacks or us.
+    const struct junk_params *params = params_exchange_read(&ctx->params);
+    const float gain = params->submode == JUNK_SUBMODE_MUTE ? 0.0F : params->gain;
+
+    ctx->rx_tone.gain.gain = gain;
+    ctx->rx_agc.volume = gain;
+    if (params->submode == JUNK_SUBMODE_FSK && params->baud != ctx->fsk_rx.requested) {
+        fsk_demodulator_set_baud(&ctx->fsk_rx, params->baud);
+    }
+    if (-params->shift != ctx->rx_shift.rotate.hz) {
+        dsp_rotate_set(&ctx->rx_shift.rotate, -params->shift, JUNK_SAMPLE_RATE_HZ);
+    }
+
+    junk_rx_level(ctx, get_packet_data(packet), get_packet_len(packet), recording);
+
+    float null_samples[get_packet_len(packet)];
+    if (held || params->submode != JUNK_SUBMODE_OFDM) {
+        dsp_graph_run(&ctx->rx_dsp[params->submode], get_packet_data(packet), null_samples, get_packet_len(packet));
+    } else {
+        memset(null_samples, 0, sizeof(null_samples));
+    }
+
+    junk_send(waveform, ctx, null_samples, get_packet_len(packet), SPEAKER_DATA);
+
+    // Whatever the modems decoded goes to the client as byte data.
+    if (ctx->fsk_rx.num_decoded > 0) {
+        junk_send_decoded(waveform, ctx, params, ctx->fsk_rx.decoded, ctx->fsk_rx.num_decoded);
+        ctx->fsk_rx.num_decoded = 0;
+    }
+    if (ctx->ofdm.rx.num_decoded > 0) {
+        junk_send_decoded(waveform, ctx, params, ctx->ofdm.rx.decoded, ctx->ofdm.rx.num_decoded);
+        ctx->ofdm.rx.num_decoded = 0;
+    }
+
+    waveform_meter_set_float_value(waveform, "junk-snr", (float) ctx->snr);
+    junk_meters_send(waveform, ctx);
+    ctx->snr = ++ctx->snr > 100 ? -100 : ctx->snr;
+
+    if (held) {
+        lifecycle_exit(&ctx->lifecycle);
+    }
+
+    // The modems' byte stream is the client's data, so it only gets the counter when neither is running.
+    if (++ctx->byte_data_counter % 100 == 0 && !junk_submode_is_modem(params->submode)) {
+        size_t len = snprintf(NULL, 0, "Callback Counter: %ld\n", ctx->byte_data_counter);
+        uint8_t data_message[len + 1];
+        snprintf(data_message, sizeof(data_message), "Callback Counter: %ld\n", ctx->byte_data_counter);
+        junk_send_bytes(waveform, ctx, data_message, sizeof(data_message));
+    }
+}
+
+/// \brief Process microphone data to transmit when we are in transmit mode.
+/// In this example we just replace out these samples with the sine wave data and send that to the radio.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
+///               The various accessor functions should be used to access the data.
+static void junk_tx(struct waveform_t *waveform, struct junk_context *ctx, struct waveform_vita_packet *packet) {
+    if (ctx->capture != NULL) {
+        capture_write(ctx->capture, CAPTURE_TX, ctx->tx ? CAPTURE_FLAG_TX : 0, packet);
+    }
+
+    if (false == ctx->tx) {
+        return;
+    }
+
+    const struct junk_params *params = params_exchange_read(&ctx->params);
+    const float gain = params->submode == JUNK_SUBMODE_MUTE ? 0.0F : params->gain;
+
+    ctx->tx_tone.gain.gain = gain;
+    ctx->fsk_tx.amplitude = gain;
+    ctx->ofdm.tx.amplitude = gain;
+    if (params->submode == JUNK_SUBMODE_FSK && params->baud != ctx->fsk_tx.requested) {
+        fsk_modulator_set_baud(&ctx->fsk_tx, params->baud);
+    }
+    if (params->shift != ctx->tx_shift.rotate.hz) {
+        dsp_rotate_set(&ctx->tx_shift.rotate, params->shift, JUNK_SAMPLE_RATE_HZ);
+    }
+
+    // The OFDM modem's symbols come from buffers that are only there while the lifecycle has them.
+    const bool held = params->submode == JUNK_SUBMODE_OFDM && lifecycle_enter(&ctx->lifecycle);
+    float xmit_samples[get_packet_len(packet)];
+    if (held || params->submode != JUNK_SUBMODE_OFDM) {
+        dsp_graph_run(&ctx->tx_dsp[params->submode], get_packet_data(packet), xmit_samples, get_packet_len(packet));
+    } else {
+        memset(xmit_samples, 0, sizeof(xmit_samples));
+    }
+    if (held) {
+        lifecycle_exit(&ctx->lifecycle);
+    }
+
+    junk_send(waveform, ctx, xmit_samples, get_packet_len(packet), TRANSMITTER_DATA);
+}
+
+/// \brief Account for a packet in the telemetry and the metrics and, twice a second, publish the telemetry meters and
+/// the AGC's gain.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param ctx The waveform context
+/// \param stream Which stream the packet came in on
+/// \param packet The packet
+/// \param start_ns When the callback started, from telemetry_now_ns
+static void junk_telemetry(struct waveform_t *waveform, struct junk_context *ctx, const enum telemetry_stream stream,
+                           const struct waveform_vita_packet *packet, const int64_t start_ns) {
+    const int64_t now_ns = telemetry_now_ns();
+    const bool rx = stream == TELEMETRY_RX;
+    metrics_add(ctx->metrics, rx ? METRICS_PACKETS_IN_RX : METRICS_PACKETS_IN_TX, 1);
+    metrics_observe(ctx->metrics, rx ? METRICS_CALLBACK_RX : METRICS_CALLBACK_TX, now_ns - start_ns);
+
+    if (telemetry_packet(&ctx->telemetry, stream, packet, start_ns, now_ns)) {
+        telemetry_publish(&ctx->telemetry, waveform, api_queue_depth(&ctx->api), scheduler_depth(&ctx->scheduler));
+        waveform_meter_set_float_value(waveform, AGC_METER_GAIN, agc_gain_db(&ctx->rx_agc));
+        junk_meters_send(waveform, ctx);
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void junk_dsp_init(struct junk_context *ctx) {
+    const float *tone = TABLES_TONE(JUNK_SAMPLE_RATE_HZ);
+    const unsigned int tone_len = TABLES_TONE_LEN(JUNK_SAMPLE_RATE_HZ);
+    dsp_tone_osc_init(&ctx->rx_nco, tone_len, JUNK_SAMPLE_RATE_HZ);
+    dsp_tone_osc_init(&ctx->tx_nco, tone_len, JUNK_SAMPLE_RATE_HZ);
+    ctx->rx_tone = (struct junk_tone_stage) {
+        .tone = {.table = tone, .len = tone_len, .osc = &ctx->rx_nco},
+    };
+    ctx->tx_tone = (struct junk_tone_stage) {
+        .tone = {.table = tone, .len = tone_len, .osc = &ctx->tx_nco},
+    };
+
+    agc_init(&ctx->rx_agc, JUNK_SAMPLE_RATE_HZ);
+    fsk_modulator_init(&ctx->fsk_tx, JUNK_SAMPLE_RATE_HZ, junk_params_defaults.baud);
+    fsk_demodulator_init(&ctx->fsk_rx, JUNK_SAMPLE_RATE_HZ, junk_params_defaults.baud);
+    ofdm_init(&ctx->ofdm, JUNK_SAMPLE_RATE_HZ);
+    fec_deframer_init(&ctx->fec_rx);
+
+    // In the audio modes the modems' graphs work on the analytic signal between a pair of Hilbert transform stages,
+    // so that the complex stages in the middle are the same ones RAW mode's I/Q would go through.
+    const bool audio = strcmp(JUNK_MODE, "RAW") != 0;
+    const enum hilbert_sideband sideband = strcmp(JUNK_MODE, "DIGL") == 0 ? HILBERT_LSB : HILBERT_USB;
+    hilbert_init(&ctx->rx_analytic, sideband);
+    hilbert_init(&ctx->rx_real, sideband);
+    hilbert_init(&ctx->tx_analytic, sideband);
+    hilbert_init(&ctx->tx_real, sideband);
+    dsp_rotate_set(&ctx->rx_shift.rotate, -junk_params_defaults.shift, JUNK_SAMPLE_RATE_HZ);
+    dsp_rotate_set(&ctx->tx_shift.rotate, junk_params_defaults.shift, JUNK_SAMPLE_RATE_HZ);
+#ifdef JUNK_FIXED_POINT
+    junk_q15_init(ctx, audio, sideband);
+#endif
+
+    for (int submode = 0; submode < JUNK_SUBMODE_COUNT; ++submode) {
+        dsp_graph_init(&ctx->rx_dsp[submode]);
+        dsp_graph_init(&ctx->tx_dsp[submode]);
+    }
+
+    // Muting is the tone at zero volume, so that the tone carries on where it left off when it is unmuted.  The tone is
+    // the same on both halves of every sample, so its graphs only make one, and write it straight into the first half
+    // of the packet since the tone doesn't read what the radio sent.  The speaker gets the tone we make rather
+    // than anything the radio sent, so there is nothing for the AGC to level and the "set" gain is the volume.
+    dsp_graph_init_mono(&ctx->rx_dsp[JUNK_SUBMODE_TONE]);
+    dsp_graph_init_mono(&ctx->tx_dsp[JUNK_SUBMODE_TONE]);
+#ifdef JUNK_FIXED_POINT
+    dsp_graph_add_source(&ctx->rx_dsp[JUNK_SUBMODE_TONE], "tone+gain-q15", fixed_graph_process,
+                         &ctx->q15.rx_tone_graph);
+    dsp_graph_add_source(&ctx->tx_dsp[JUNK_SUBMODE_TONE], "tone+gain-q15", fixed_graph_process,
+                         &ctx->q15.tx_tone_graph);
+#else
+    dsp_graph_add_source(&ctx->rx_dsp[JUNK_SUBMODE_TONE], "tone+gain", junk_tone_run, &ctx->rx_tone);
+    dsp_graph_add_source(&ctx->tx_dsp[JUNK_SUBMODE_TONE], "tone+gain", junk_tone_run, &ctx->tx_tone);
+#endif
+    ctx->rx_dsp[JUNK_SUBMODE_MUTE] = ctx->rx_dsp[JUNK_SUBMODE_TONE];
+    ctx->tx_dsp[JUNK_SUBMODE_MUTE] = ctx->tx_dsp[JUNK_SUBMODE_TONE];
+
+    // The modem passes what it hears on to the speaker so that the operator can tune it in by ear, levelled by the AGC
+    // with the "set" gain as the volume after it.  The modems work on the real part of the signal, which after the
+    // shift is the audio moved by the shift.  With JUNK_FIXED_POINT the Hilbert and shift stages on either side of the
+    // modem run as fixed point graphs, and only the modem and the AGC between them work in float.
+    for (int submode = JUNK_SUBMODE_FSK; submode <= JUNK_SUBMODE_OFDM; ++submode) {
+        struct dsp_graph *rx = &ctx->rx_dsp[submode];
+        struct dsp_graph *tx = &ctx->tx_dsp[submode];
+        const bool fsk = submode == JUNK_SUBMODE_FSK;
+
+#ifdef JUNK_FIXED_POINT
+        dsp_graph_add(rx, audio ? "analytic+shift-q15" : "shift-q15", fixed_graph_process, &ctx->q15.rx_baseband);
+#else
+        if (audio) {
+            dsp_graph_add(rx, "analytic", hilbert_analytic, &ctx->rx_analytic);
+        }
+        dsp_graph_add(rx, "shift", junk_shift_run, &ctx->rx_shift);
+#endif
+        if (fsk) {
+            dsp_graph_add(rx, "fsk-demod", fsk_demodulate, &ctx->fsk_rx);
+        } else {
+            dsp_graph_add(rx, "ofdm-demod", ofdm_demodulate, &ctx->ofdm);
+        }
+        dsp_graph_add(rx, "agc", agc_process, &ctx->rx_agc);
+        if (audio) {
+#ifdef JUNK_FIXED_POINT
+            dsp_graph_add(rx, "real-q15", fixed_graph_process, &ctx->q15.rx_audio);
+#else
+            dsp_graph_add(rx, "real", hilbert_real, &ctx->rx_real);
+#endif
+        }
+
+        if (fsk) {
+            dsp_graph_add_source(tx, "fsk-mod", fsk_modulate, &ctx->fsk_tx);
+        } else {
+            dsp_graph_add_source(tx, "ofdm-mod", ofdm_modulate, &ctx->ofdm);
+        }
+#ifdef JUNK_FIXED_POINT
+        dsp_graph_add(tx, audio ? "analytic+shift+real-q15" : "shift-q15", fixed_graph_process, &ctx->q15.tx_modem);
+#else
+        if (audio) {
+            dsp_graph_add(tx, "analytic", hilbert_analytic, &ctx->tx_analytic);
+        }
+        dsp_graph_add(tx, "shift", junk_shift_run, &ctx->tx_shift);
+        if (audio) {
+            dsp_graph_add(tx, "real", hilbert_real, &ctx->tx_real);
+        }
+#endif
+    }
+}
+
+/// \brief A callback function to process incoming receiver packets.  This is called once for every packet we receive
+/// from the radio.  The work is done in junk_rx; here we time it for the telemetry meters and the metrics.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
+/// \param packet_size The size of the waveform_vita_packet structure
+/// \param arg A pointer to the context structure passed in the waveform_register_rx_data_cb
+void packet_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet,
+               size_t packet_size __attribute__((unused)), void *arg __attribute__((unused))) {
+    struct junk_context *ctx = waveform_get_context(waveform);
+    const int64_t start_ns = telemetry_now_ns();
+
+    // The first callback on this thread after ACTIVE puts it on its real-time footing.
+    if (ctx->realtime != NULL) {
+        realtime_enter(ctx->realtime);
+    }
+
+    junk_rx(waveform, ctx, packet);
+    junk_telemetry(waveform, ctx, TELEMETRY_RX, packet, start_ns);
+}
+
+/// \brief A callback function called for every microphone packet, whether or not we are transmitting.  The work is
+/// done in junk_tx; here we time it for the telemetry meters and the metrics.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
+/// \param packet_size The size of the waveform_vita_packet structure
+/// \param arg A pointer to the context structure passed in the waveform_register_tx_data_cb
+void packet_tx(struct waveform_t *waveform, struct waveform_vita_packet *packet,
+               size_t packet_size __attribute__((unused)), void *arg __attribute__((unused))) {
+    struct junk_context *ctx = waveform_get_context(waveform);
+    const int64_t start_ns = telemetry_now_ns();
+
+    if (ctx->realtime != NULL) {
+        realtime_enter(ctx->realtime);
+    }
+
+    junk_tx(waveform, ctx, packet);
+    junk_telemetry(waveform, ctx, TELEMETRY_TX, packet, start_ns);
+}
@@ -0,0 +1,182 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file junk_waveform.h
+/// @brief The JUNK waveform's context and sample data path
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_JUNK_WAVEFORM_H
+#define WAVEFORM_EXAMPLE_JUNK_WAVEFORM_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "agc.h"
+#include "api_queue.h"
+#include "capture.h"
+#include "commands.h"
+#include "dsp.h"
+#include "fec.h"
+#include "fixed.h"
+#include "fsk.h"
+#include "hilbert.h"
+#include "lifecycle.h"
+#include "metrics.h"
+#include "ofdm.h"
+#include "osc.h"
+#include "realtime.h"
+#include "scheduler.h"
+#include "sigmf.h"
+#include "slice_state.h"
+#include "subscriptions.h"
+#include "telemetry.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The sample rate in Hz that we ask for in waveform_create with SR_24K
+#define JUNK_SAMPLE_RATE_HZ 24000
+
+/// \brief The underlying mode we ask for in waveform_create: "DIGU" or "DIGL" for audio, or "RAW" for I/Q
+#define JUNK_MODE "DIGU"
+
+/// \brief The frequency of the test tone in Hz.  Its table is generated at build time; see tools/gen_tables.py.
+#define JUNK_TONE_HZ 1000
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The state of the tone stages, the operations in JUNK_RX_TONE_CHAIN or JUNK_TX_TONE_CHAIN fused into one
+/// pass.  See dsp.h.
+struct junk_tone_stage {
+    struct dsp_tone tone;
+    struct dsp_gain gain;
+};
+
+/// \brief The state of the shift stages, which move complex baseband by the "shift" parameter.  See dsp.h.
+struct junk_shift_stage {
+    struct dsp_rotate rotate;
+};
+
+/// \brief The tone, shift and Hilbert stages in Q15, and the fixed point graphs that run them, used instead of the
+/// float ones with JUNK_FIXED_POINT.  Each follows the same oscillator as its float counterpart.  See fixed.h.
+struct junk_q15_stages {
+    struct fixed_tone rx_tone;
+    struct fixed_tone tx_tone;
+    struct fixed_hilbert rx_analytic;
+    struct fixed_hilbert rx_real;
+    struct fixed_hilbert tx_analytic;
+    struct fixed_hilbert tx_real;
+    struct fixed_rotate rx_shift;
+    struct fixed_rotate tx_shift;
+    struct fixed_graph rx_tone_graph;
+    struct fixed_graph tx_tone_graph;
+    struct fixed_graph rx_baseband;     ///< What the received packet goes through before the demodulator
+    struct fixed_graph rx_audio;        ///< What the modem's audio goes through after the AGC
+    struct fixed_graph tx_modem;        ///< What the modulator's signal goes through on its way to the radio
+};
+
+// A structure to hold context for the waveform.  This can be passed as a pointer to the callback registration functions
+// so that they have access to waveform common data.  We keep things in here like the current phase of the sine wave
+// for both the TX and RX sides of things.
+struct junk_context {
+    struct osc rx_nco;          ///< Where the receive tone is; see dsp_tone_osc_init
+    struct osc tx_nco;          ///< Where the transmit tone is
+    bool tx;
+    int16_t snr;
+    uint64_t byte_data_counter;
+    struct params_exchange params;
+    struct slice_state_table slices;
+    struct subscription_manager subscriptions;
+    struct api_queue api;
+    struct scheduler scheduler;
+    _Atomic uint64_t last_rx_timestamp;
+
+    // What the data callbacks do to each packet in each submode, built by junk_dsp_init.  See dsp.h.
+    struct junk_tone_stage rx_tone;
+    struct junk_tone_stage tx_tone;
+    struct agc rx_agc;          ///< Levels the received audio the modems pass on to the speaker
+    float rx_level;             ///< The received level for the SigMF trigger; see junk_rx_level
+    float rx_level_hold;        ///< The highest packet peak since the last drop
+    size_t rx_level_len;        ///< The packet length in samples that rx_level_decay was worked out for
+    float rx_level_decay;
+    struct fsk_modulator fsk_tx;
+    struct fsk_demodulator fsk_rx;
+    struct ofdm ofdm;           ///< Its plan and buffers are a lifecycle resource; see ofdm_acquire
+    struct fec_deframer fec_rx;
+    struct hilbert rx_analytic;
+    struct hilbert rx_real;
+    struct hilbert tx_analytic;
+    struct hilbert tx_real;
+    struct junk_shift_stage rx_shift;
+    struct junk_shift_stage tx_shift;
+    struct junk_q15_stages q15;
+    struct dsp_graph rx_dsp[JUNK_SUBMODE_COUNT];
+    struct dsp_graph tx_dsp[JUNK_SUBMODE_COUNT];
+
+    // If not NULL, every sample packet is recorded here before it is processed.  See capture.h.
+    struct capture *capture;
+
+    // If not NULL, the receive stream is fed to this recorder while the lifecycle below has it.  See sigmf.h.
+    struct sigmf_recorder *sigmf;
+
+    // The resources that are only held while the waveform is ACTIVE.  See lifecycle.h.
+    struct lifecycle lifecycle;
+
+    // Our own load, for the telemetry meters.  See telemetry.h.
+    struct telemetry telemetry;
+
+    // If not NULL, the data callbacks apply these real-time settings to their threads.  See realtime.h.
+    struct realtime *realtime;
+
+    // If not NULL, packets, sends and callback times are counted here for the Prometheus exporter.  See metrics.h.
+    struct metrics *metrics;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Build the receive and transmit DSP graphs for every submode.  Call this once the context is in place and
+/// before the data callbacks can run; the graphs point into the context, so it mustn't move afterwards.
+/// \param ctx The waveform context
+void junk_dsp_init(struct junk_context *ctx);
+
+/// \brief The receive data callback.  See junk_waveform.c.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param packet The VITA-49 packet
+/// \param packet_size The size of the waveform_vita_packet structure
+/// \param arg Unused
+void packet_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet, size_t packet_size, void *arg);
+
+/// \brief The transmit data callback.  See junk_waveform.c.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param packet The VITA-49 packet
+/// \param packet_size The size of the waveform_vita_packet structure
+/// \param arg Unused
+void packet_tx(struct waveform_t *waveform, struct waveform_vita_packet *packet, size_t packet_size, void *arg);
+
+#endif // WAVEFORM_EXAMPLE_JUNK_WAVEFORM_H
@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file kwargs.c
+/// @brief Zero-copy tokenizer for key=value keyword arguments
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stddef.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "kwargs.h"
+
+// ****************************************
+// Global Functions
+// ****************************************
+const char *kwargs_find(const unsigned int argc, char *const argv[], const char *key) {
+    const char *value = NULL;
+    struct kwarg kwarg;
+
+    for (unsigned int i = 0; i < argc; ++i) {
+        if (kwarg_split(argv[i], &kwarg) && kwarg_is(&kwarg, key))
+            value = kwarg.value;
+    }
+
+    return value;
+}
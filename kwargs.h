@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file kwargs.h
+/// @brief Zero-copy tokenizer for key=value keyword arguments
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_KWARGS_H
+#define WAVEFORM_EXAMPLE_KWARGS_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A keyword argument as a view into the original argument string.  Nothing is copied or modified; the key is
+/// not NUL terminated but the value is, since it always runs to the end of the argument.
+struct kwarg {
+    const char *key;
+    size_t key_len;
+    const char *value;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Split an argument of the form key=value.
+/// \param arg The argument as received in argv
+/// \param kwarg The keyword argument to fill in
+/// \return true if the argument was a keyword argument, false if it has no '='
+static inline bool kwarg_split(const char *arg, struct kwarg *kwarg) {
+    const char *equals = strchr(arg, '=');
+    if (equals == NULL)
+        return false;
+
+    kwarg->key = arg;
+    kwarg->key_len = (size_t) (equals - arg);
+    kwarg->value = equals + 1;
+    return true;
+}
+
+/// \brief Check whether a keyword argument has the given key.
+/// \param kwarg The keyword argument
+/// \param key The NUL terminated key to compare against
+/// \return true if the keys are equal
+static inline bool kwarg_is(const struct kwarg *kwarg, const char *key) {
+    return strncmp(kwarg->key, key, kwarg->key_len) == 0 && key[kwarg->key_len] == '\0';
+}
+
+/// \brief Find the value of a key in an argument list.  For a one-off lookup; to pick several keys out of the same
+/// list, iterate with kwarg_split once instead.
+/// \param argc The number of arguments
+/// \param argv The arguments
+/// \param key The key to look for
+/// \return The value of the last matching argument or NULL if there is none
+const char *kwargs_find(unsigned int argc, char *const argv[], const char *key);
+
+#endif // WAVEFORM_EXAMPLE_KWARGS_H
@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file lifecycle.c
+/// @brief Resources that are only held while the waveform is ACTIVE
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "lifecycle.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000LL
+
+// How long to sleep between looks at whether the data callbacks have let go of the resources
+#define LIFECYCLE_DRAIN_POLL_US 200
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read the monotonic clock in nanoseconds
+/// \return The current value of CLOCK_MONOTONIC
+static uint64_t lifecycle_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * NS_PER_SEC + (uint64_t) now.tv_nsec;
+}
+
+/// \brief The activation thread.  Acquires every resource in order and then lets the callbacks at them.
+/// \param arg The struct lifecycle
+/// \return Always NULL
+static void *lifecycle_thread(void *arg) {
+    struct lifecycle *lifecycle = arg;
+    const uint64_t start = lifecycle_now_ns();
+
+    lifecycle->stats.acquired = 0;
+    lifecycle->stats.failed = 0;
+    for (size_t i = 0; i < lifecycle->num_resources; ++i) {
+        struct lifecycle_resource *resource = &lifecycle->resources[i];
+        resource->held = resource->acquire(resource->arg) == 0;
+        if (resource->held) {
+            ++lifecycle->stats.acquired;
+        } else {
+            fprintf(stderr, "Unable to acquire %s, continuing without it\n", resource->name);
+            ++lifecycle->stats.failed;
+        }
+    }
+
+    lifecycle->stats.acquire_ns = lifecycle_now_ns() - start;
+    lifecycle->stats.rss_active = lifecycle_rss_bytes();
+    atomic_store_explicit(&lifecycle->state, LIFECYCLE_READY, memory_order_release);
+
+    fprintf(stderr, "Acquired %zu of %zu resources in %.1f ms, resident memory %zu KiB -> %zu KiB\n",
+            lifecycle->stats.acquired, lifecycle->num_resources, (double) lifecycle->stats.acquire_ns / 1e6,
+            lifecycle->stats.rss_inactive / 1024, lifecycle->stats.rss_active / 1024);
+    return NULL;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void lifecycle_init(struct lifecycle *lifecycle) {
+    memset(lifecycle, 0, sizeof(*lifecycle));
+    atomic_init(&lifecycle->state, LIFECYCLE_RELEASED);
+    atomic_init(&lifecycle->users, 0);
+}
+
+int lifecycle_register(struct lifecycle *lifecycle, const char *name, int (*acquire)(void *arg),
+                       void (*release)(void *arg), void *arg) {
+    if (lifecycle->num_resources == LIFECYCLE_MAX_RESOURCES)
+        return -1;
+
+    lifecycle->resources[lifecycle->num_resources++] = (struct lifecycle_resource) {
+        .name = name,
+        .acquire = acquire,
+        .release = release,
+        .arg = arg,
+    };
+    return 0;
+}
+
+int lifecycle_activate(struct lifecycle *lifecycle) {
+    if (atomic_load_explicit(&lifecycle->state, memory_order_relaxed) != LIFECYCLE_RELEASED)
+        return 0;
+
+    ++lifecycle->stats.activations;
+    lifecycle->stats.rss_inactive = lifecycle_rss_bytes();
+    atomic_store_explicit(&lifecycle->state, LIFECYCLE_ACQUIRING, memory_order_relaxed);
+
+    const int ret = pthread_create(&lifecycle->thread, NULL, lifecycle_thread, lifecycle);
+    if (ret != 0) {
+        atomic_store_explicit(&lifecycle->state, LIFECYCLE_RELEASED, memory_order_relaxed);
+        errno = ret;
+        return -1;
+    }
+
+    lifecycle->thread_started = true;
+    return 0;
+}
+
+void lifecycle_deactivate(struct lifecycle *lifecycle, FILE *file) {
+    if (lifecycle->thread_started) {
+        pthread_join(lifecycle->thread, NULL);
+        lifecycle->thread_started = false;
+    }
+
+    if (atomic_load_explicit(&lifecycle->state, memory_order_relaxed) == LIFECYCLE_RELEASED)
+        return;
+
+    // Shut the door and then wait for anybody already inside to leave.  Both sides use sequentially consistent
+    // operations so that a callback either sees the door shut or is seen in users, never neither.
+    atomic_store(&lifecycle->state, LIFECYCLE_RELEASED);
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = LIFECYCLE_DRAIN_POLL_US * 1000L};
+    while (atomic_load(&lifecycle->users) != 0)
+        nanosleep(&poll, NULL);
+
+    const size_t rss_before = lifecycle_rss_bytes();
+    for (size_t i = lifecycle->num_resources; i-- > 0;) {
+        struct lifecycle_resource *resource = &lifecycle->resources[i];
+        if (resource->held) {
+            resource->release(resource->arg);
+            resource->held = false;
+        }
+    }
+
+#ifdef __GLIBC__
+    // Large allocations are unmapped as soon as they are freed, but smaller ones only go back to the heap.  Hand the
+    // free space at the top of the heap, and any whole free pages within it, back to the kernel too.
+    malloc_trim(0);
+#endif
+
+    lifecycle->stats.rss_released = lifecycle_rss_bytes();
+    fprintf(file, "Released %zu resources, resident memory %zu KiB -> %zu KiB\n", lifecycle->stats.acquired,
+            rss_before / 1024, lifecycle->stats.rss_released / 1024);
+}
+
+bool lifecycle_enter(struct lifecycle *lifecycle) {
+    atomic_fetch_add(&lifecycle->users, 1);
+    if (atomic_load(&lifecycle->state) == LIFECYCLE_READY)
+        return true;
+
+    atomic_fetch_sub_explicit(&lifecycle->users, 1, memory_order_release);
+    return false;
+}
+
+void lifecycle_exit(struct lifecycle *lifecycle) {
+    atomic_fetch_sub_explicit(&lifecycle->users, 1, memory_order_release);
+}
+
+size_t lifecycle_rss_bytes(void) {
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm == NULL)
+        return 0;
+
+    unsigned long size;
+    unsigned long resident;
+    const int fields = fscanf(statm, "%lu %lu", &size, &resident);
+    fclose(statm);
+    if (fields != 2)
+        return 0;
+
+    return (size_t) resident * (size_t) sysconf(_SC_PAGESIZE);
+}
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file lifecycle.h
+/// @brief Resources that are only held while the waveform is ACTIVE
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_LIFECYCLE_H
+#define WAVEFORM_EXAMPLE_LIFECYCLE_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most resources that can be registered
+#define LIFECYCLE_MAX_RESOURCES 16
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Where the resources are.  Only the activation thread moves ACQUIRING to READY; everything else happens on
+/// the thread that calls lifecycle_activate and lifecycle_deactivate, which is the library's state callback.
+enum lifecycle_state {
+    LIFECYCLE_RELEASED,
+    LIFECYCLE_ACQUIRING,
+    LIFECYCLE_READY,
+};
+
+/// \brief Something big the waveform only needs while it is ACTIVE, such as a buffer pool or a filter bank
+struct lifecycle_resource {
+    const char *name;
+    int (*acquire)(void *arg);  ///< Allocate and prefault it; returns 0 for success otherwise a negative value
+    void (*release)(void *arg); ///< Give all of it back
+    void *arg;
+    bool held;
+};
+
+/// \brief What the last activation and deactivation did.  Resident memory is in bytes.
+struct lifecycle_stats {
+    uint64_t activations;
+    size_t acquired;
+    size_t failed;
+    uint64_t acquire_ns;
+    size_t rss_inactive;        ///< Before the last activation
+    size_t rss_active;          ///< Once everything was acquired
+    size_t rss_released;        ///< After the last deactivation
+};
+
+/// \brief The resources and their state.
+///
+/// The docs say that a waveform may sit INACTIVE for weeks and shouldn't hold on to much memory while it does.  So
+/// resources are acquired when the waveform goes ACTIVE, on a thread of our own so that the first packets aren't held
+/// up, and are all released again at INACTIVE.  Until everything has been acquired, lifecycle_enter tells the data
+/// callbacks to go without; they never wait for it.
+struct lifecycle {
+    struct lifecycle_resource resources[LIFECYCLE_MAX_RESOURCES];
+    size_t num_resources;
+
+    _Atomic int state;
+    _Atomic unsigned int users;
+
+    pthread_t thread;
+    bool thread_started;
+    struct lifecycle_stats stats;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize the resource lifecycle with nothing registered and nothing held.
+/// \param lifecycle The lifecycle to initialize
+void lifecycle_init(struct lifecycle *lifecycle);
+
+/// \brief Register a resource.  This must be done before the radio is started.  Resources are acquired in the order
+/// they are registered and released in the reverse order.
+/// \param lifecycle The lifecycle
+/// \param name The name to report it by, which must outlive the lifecycle
+/// \param acquire Allocates the resource
+/// \param release Releases the resource
+/// \param arg Passed to acquire and release
+/// \return 0 for success otherwise a negative value if there are too many resources
+int lifecycle_register(struct lifecycle *lifecycle, const char *name, int (*acquire)(void *arg),
+                       void (*release)(void *arg), void *arg);
+
+/// \brief Start acquiring every resource in the background.  Call this from the state callback at ACTIVE.
+/// \param lifecycle The lifecycle
+/// \return 0 for success otherwise a negative value if the activation thread couldn't be started
+int lifecycle_activate(struct lifecycle *lifecycle);
+
+/// \brief Wait for any activation in progress, wait for the data callbacks to stop using the resources, release all of
+/// them and report the resident memory before and after.  Call this from the state callback at INACTIVE, and once
+/// the radio has stopped in case INACTIVE never came.  It does nothing if nothing is held.
+/// \param lifecycle The lifecycle
+/// \param file Where to report
+void lifecycle_deactivate(struct lifecycle *lifecycle, FILE *file);
+
+/// \brief Start using the resources from a callback.  If this returns true the resources stay put until the matching
+/// lifecycle_exit.  This never blocks.
+/// \param lifecycle The lifecycle
+/// \return true if every resource has been acquired, otherwise false and the caller must do without
+bool lifecycle_enter(struct lifecycle *lifecycle);
+
+/// \brief Stop using the resources after a lifecycle_enter that returned true.
+/// \param lifecycle The lifecycle
+void lifecycle_exit(struct lifecycle *lifecycle);
+
+/// \brief Read the resident memory of this process.
+/// \return The resident set size in bytes, or 0 if it can't be read
+size_t lifecycle_rss_bytes(void);
+
+#endif // WAVEFORM_EXAMPLE_LIFECYCLE_H
@@ -22,35 +22,67 @@
 // System Includes
 // ****************************************
 #include <arpa/inet.h>
+#include <errno.h>
 #include <getopt.h>
 #include <libgen.h>
+#include <limits.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 // ****************************************
 // Project Includes
 // ****************************************
 #include <waveform/waveform_api.h>
+#include "api_queue.h"
+#include "capture.h"
+#include "commands.h"
+#include "discovery.h"
+#include "fec.h"
+#include "junk_waveform.h"
+#include "kwargs.h"
+#include "lifecycle.h"
+#include "metrics.h"
+#include "ofdm.h"
+#include "realtime.h"
+#include "scheduler.h"
+#include "sigmf.h"
+#include "slice_state.h"
+#include "subscriptions.h"
+#include "telemetry.h"
 
 // ****************************************
 // Structs, Enums, typedefs
 // ****************************************
 
-// A structure to hold context for the waveform.  This can be passed as a pointer to the callback registration functions
-// so that they have access to waveform common data.  We keep things in here like the current phase of the sine wave
-// for both the TX and RX sides of things.
-struct junk_context {
-    _Atomic uint8_t rx_phase;
-    _Atomic uint8_t tx_phase;
-    bool tx;
+// The portion of the waveform context that describes where our DSP is "at."  When the radio drops the connection we
+// copy this out of the context before tearing everything down and copy it back into the fresh context once we have
+// reconnected so that the NCOs pick up where they left off rather than restarting from zero, and so that whatever the
+// user last set with the "set" command stays in effect.  Note that the transmit flag is deliberately not part of this;
+// a dropped connection always leaves the radio unkeyed.
+struct junk_dsp_snapshot {
+    uint64_t rx_phase;
+    uint64_t tx_phase;
+    uint64_t rx_shift_phase;
+    uint64_t tx_shift_phase;
     int16_t snr;
     uint64_t byte_data_counter;
+    struct junk_params params;
+};
+
+// The SigMF recorder only runs while the waveform is ACTIVE, since its ring and prepared data file are the biggest
+// things we hold.  This is what it takes to recreate it each time, with its recordings numbered on from the last.
+struct sigmf_resource {
+    struct sigmf_config config;
+    struct sigmf_recorder recorder;
 };
 
 // ****************************************
@@ -58,44 +90,51 @@ struct junk_context {
 // ****************************************
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
+// The reconnect delay starts at RECONNECT_BACKOFF_INITIAL_MS and doubles on every failed attempt up to
+// RECONNECT_BACKOFF_MAX_MS.  A connection that stays up for at least RECONNECT_STABLE_SECS resets the delay so that a
+// single drop after a long session is retried almost immediately.
+#define RECONNECT_BACKOFF_INITIAL_MS 50
+#define RECONNECT_BACKOFF_MAX_MS 10000
+#define RECONNECT_STABLE_SECS 30
+
 // ****************************************
 // Static Variables
 // ****************************************
 
-// The values for a 1000Hz sine wave at 24kHz sample rate precalculated to save processor time.
-static const float sin_table[] = {
-    0.0F,
-    0.25881904510252074F,
-    0.49999999999999994F,
-    0.7071067811865475F,
-    0.8660254037844386F,
-    0.9659258262890682F,
-    1.0F,
-    0.9659258262890683F,
-    0.8660254037844388F,
-    0.7071067811865476F,
-    0.5000000000000003F,
-    0.258819045102521F,
-    1.2246467991473532e-16F,
-    -0.25881904510252035F,
-    -0.4999999999999998F,
-    -0.7071067811865471F,
-    -0.8660254037844384F,
-    -0.9659258262890681F,
-    -1.0F,
-    -0.9659258262890684F,
-    -0.866025403784439F,
-    -0.7071067811865477F,
-    -0.5000000000000004F,
-    -0.2588190451025215F
-};
-
 //  A set of meters that we intend to send to the radio.  Each meter has a name, minimum and maximum value, and a unit
 //  associated with it.  See the documentation for all the different units supported.
 static const struct waveform_meter_entry meters[] = {
     {.name = "junk-snr", .min = -100.0f, .max = 100.0f, .unit = DB},
     {.name = "junk-foff", .min = 0.0f, .max = 100000.0f, .unit = DB},
-    {.name = "junk-clock-offset", .min = 0.0f, .max = 100000.0f, .unit = DB}
+    {.name = "junk-clock-offset", .min = 0.0f, .max = 100000.0f, .unit = DB},
+    {.name = AGC_METER_GAIN, .min = -20.0f, .max = 40.0f, .unit = DB},
+
+    // How hard we are working, so that an operator can see it from any client.  See telemetry.h.
+    {.name = TELEMETRY_METER_CPU, .min = 0.0f, .max = 100.0f, .unit = PERCENT},
+    {.name = TELEMETRY_METER_DSP_CPU, .min = 0.0f, .max = 100.0f, .unit = PERCENT},
+    {.name = TELEMETRY_METER_DUTY, .min = 0.0f, .max = 100.0f, .unit = PERCENT},
+    {.name = TELEMETRY_METER_API_QUEUE, .min = 0.0f, .max = (float) (API_QUEUE_DEPTH + API_QUEUE_MAX_WINDOW),
+     .unit = NONE},
+    {.name = TELEMETRY_METER_SCHED_QUEUE, .min = 0.0f, .max = (float) SCHEDULER_CAPACITY, .unit = NONE},
+    {.name = TELEMETRY_METER_DROPS, .min = 0.0f, .max = 1000000.0f, .unit = NONE},
+};
+
+// The status handlers referenced by subscription_interests below, which are defined with the other callbacks.
+static int slice_status(struct waveform_t *waveform, unsigned int argc, char *argv[], void *arg);
+static bool slice_status_filter(unsigned int argc, char *argv[]);
+
+//  The statuses we want to hear about from the radio.  Each has the name we register a status callback for, the
+//  subscribe command that asks the radio to send it, a filter that can drop messages before they go any further, the
+//  handler for the messages that get through and the message rate above which we complain that it is flooding the
+//  command thread.
+static const struct subscription_interest subscription_interests[] = {
+    {
+        .status = "slice",
+        .command = "sub slice all",
+        .filter = slice_status_filter,
+        .handler = slice_status,
+        .max_rate = 50
+    },
 };
 
 
@@ -103,128 +142,110 @@ static const struct waveform_meter_entry meters[] = {
 // Static Functions
 // ****************************************
 
-/// \brief An example "status" callback
-/// A callback that merely echos the arguments we receive.  This is used as the "status" callback in the main program
-/// to receive any status updates we have subscribed to in the radio.
+/// \brief Filter for "slice" status messages.  Drops statuses for slices beyond what our slice state table tracks
+/// before anything else looks at them.
+/// \param argc The number of arguments in the status
+/// \param argv The arguments in the status
+/// \return true to deliver the message
+static bool slice_status_filter(unsigned int argc, char *argv[]) {
+    return argc > 2 && strtoul(argv[1], NULL, 10) < SLICE_STATE_MAX_SLICES;
+}
+
+/// \brief The "slice" status handler.  Hands the message to the slice state table in the waveform context.
 /// \param waveform A pointer to the opaque waveform structure returned by waveform_create
 /// \param argc The number of arguments in the status command
 /// \param argv An array of the arguments in the status command
-/// \param arg A pointer to the context structure passed in the waveform_register_status_cb
+/// \param arg Unused; the subscription manager passes NULL
 /// \return 0 for success otherwise a negative value on error
-static int echo_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc, char *argv[],
+static int slice_status(struct waveform_t *waveform, unsigned int argc, char *argv[],
                         void *arg __attribute__((unused))) {
-    fprintf(stderr, "Got a status for %s\n", argv[0]);
-    fprintf(stderr, "Number of args is %u\n", argc);
-    for(int i = 0; i < argc; ++i) {
-        fprintf(stderr, "ARG #%u: %s\n", i, argv[i]);
-    }
-    return 0;
-}
-
-/// \brief A command callback to just print the arguments received.
-/// This callback is used when the radio has received a
-/// command destined for the waveform in the form "slice 1 waveform_cmd ..." where ... is filled in by freeform text
-/// that's passed verbatim to the waveform.  The callback in libwaveform expects a "command" as it's first argument.
-/// For example "slice 1 waveform_cmd set foo=bar"
-/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
-/// \param argc The number of arguments in the waveform command
-/// \param argv An array of the arguments in the waveform command
-/// \param arg A pointer to the context structure passed in the waveform_register_command_cb
-/// \return 0 for success otherwise a negative value on error
-static int test_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc,
-                        char *argv[], void *arg __attribute__((unused))) {
-    for (int i = 0; i < argc; ++i)
-        fprintf(stderr, "ARG #%u: %s\n", i, argv[i]);
-
-    return 0;
-}
-
-/// \brief A callback function to process incoming receiver packets.
-/// This is called once for every packet we receive from the
-/// radio.  In this case we just clear out the samples we receive, replace them with the proper sine wave values, and
-/// send it to the radio for the speaker data using waveform_send_data_packet.  We use the context passed to us that
-/// we set in the registration command to keep track of our current phase and meter data.  After sending a packet we
-/// update the meter data and send that to the radio as well.
-/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
-/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
-///               The various accessor functions should be used to access the data such as get_packet_len() used here.
-/// \param packet_size The size of the waveform_vita_packet structure
-/// \param arg A pointer to the context structure passed in the waveform_register_rx_data_cb
-static void packet_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet,
-                      size_t packet_size __attribute__((unused)), void *arg __attribute__((unused))) {
     struct junk_context *ctx = waveform_get_context(waveform);
+    return slice_state_status_cb(waveform, argc, argv, &ctx->slices);
+}
 
-    if (ctx->tx) {
-        return;
-    }
-
-    float null_samples[get_packet_len(packet)];
-    memset(null_samples, 0, sizeof(null_samples));
+/// \brief An example slice change callback
+/// The "slice" status messages are parsed into a slice state table by slice_state_status_cb, which then calls this with
+/// just the fields that changed.  Here we merely print them.  Any callback can read the current state of a slice at any
+/// time with slice_state_get without waiting for a status message.
+/// \param table The slice state table that was updated
+/// \param slice The slice whose fields changed
+/// \param changed A mask of SLICE_FIELD_BIT() for the fields that changed
+/// \param arg The argument passed to slice_state_init
+static void slice_changed(const struct slice_state_table *table, const unsigned int slice, const uint32_t changed,
+                          void *arg __attribute__((unused))) {
+    for (unsigned int field = 0; field < SLICE_FIELD_COUNT; ++field) {
+        if ((changed & SLICE_FIELD_BIT(field)) == 0)
+            continue;
 
-    for (int i = 0; i < get_packet_len(packet); i += 2) {
-        null_samples[i] = null_samples[i + 1] =
-                          sin_table[ctx->rx_phase] * 0.5F;
-        ctx->rx_phase = (ctx->rx_phase + 1) % 24;
+        if (field == SLICE_FIELD_MODE) {
+            char mode[9];
+            slice_state_mode(table, slice, mode);
+            fprintf(stderr, "Slice %u %s is now %s\n", slice, slice_state_field_name(field), mode);
+        } else {
+            fprintf(stderr, "Slice %u %s is now %lld\n", slice, slice_state_field_name(field),
+                    (long long) slice_state_get(table, slice, field));
+        }
     }
+}
 
-    waveform_send_data_packet(waveform, null_samples,
-                              get_packet_len(packet), SPEAKER_DATA);
-
-    waveform_meter_set_float_value(waveform, "junk-snr", (float) ctx->snr);
-    waveform_meters_send(waveform);
-    ctx->snr = ++ctx->snr > 100 ? -100 : ctx->snr;
+/// \brief Queue bytes for whichever modem is transmitting.
+/// \param ctx The waveform context
+/// \param ofdm true for the OFDM modem, false for the FSK modem
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return The number queued, which is less than len if the queue filled up
+static size_t data_rx_queue(struct junk_context *ctx, const bool ofdm, const uint8_t *data, const size_t len) {
+    return ofdm ? ofdm_queue(&ctx->ofdm, data, len) : fsk_modulator_queue(&ctx->fsk_tx, data, len);
+}
 
-    if (++ctx->byte_data_counter % 100 == 0) {
-        size_t len = snprintf(NULL, 0, "Callback Counter: %ld\n", ctx->byte_data_counter);
-        uint8_t data_message[len + 1];
-        snprintf(data_message, sizeof(data_message), "Callback Counter: %ld\n", ctx->byte_data_counter);
-        waveform_send_byte_data_packet(waveform, data_message, sizeof(data_message));
-    }
+/// \brief Queue bytes for the modem the submode selects, only if they all fit.
+/// \param ctx The waveform context
+/// \param ofdm true for the OFDM modem, false for FSK
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return true if they were queued, otherwise false, and none of them were
+static bool data_rx_queue_whole(struct junk_context *ctx, const bool ofdm, const uint8_t *data, const size_t len) {
+    return ofdm ? ofdm_queue_whole(&ctx->ofdm, data, len) : fsk_modulator_queue_whole(&ctx->fsk_tx, data, len);
 }
 
 /// \brief A callback function called when we receive a VITA-49 packet with data in it rather than samples.
 /// This is used when a waveform is talking to a modem that performs the underlying modulation, such as the internal
-/// RapidM modem on a 9000 series radio.
+/// RapidM modem on a 9000 series radio.  Here it is the data the client wants sent, which we queue for the FSK or the
+/// OFDM modem, whichever the submode selects, to transmit the next time it is keyed.  With "set fec=on" it goes in
+/// FEC frames.
 /// \param waveform A pointer to the opaque waveform structure returned by waveform_create
 /// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
 ///               The various accessor functions should be used to access the data.
 /// \param packet_size The size of the waveform_vita_packet structure
 /// \param arg A pointer to the context structure passed in the waveform_register_byte_data_cb
-static void data_rx(struct waveform_t *waveform __attribute__((unused)),
-                    struct waveform_vita_packet *packet, size_t packet_size __attribute__((unused)),
-                    void *arg __attribute__((unused))) {
-    fprintf(stderr, "Got packet...\n");
-    fprintf(stderr, "  Length: %d\n", get_packet_byte_data_length(packet));
-    fprintf(stderr, "  Content: %s\n", (char *) get_packet_byte_data(packet));
-}
-
-/// \brief A callback function called when we are in transmit mode and receive microphone data to transmit.
-/// In this example we just replace out these samples with the sine wave data and send that to the radio.
-/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
-/// \param packet A structure containing the VITA-49 packet data.  This should be considered read-only and opaque.
-///               The various accessor functions should be used to access the data.
-/// \param packet_size The size of the waveform_vita_packet structure
-/// \param arg A pointer to the context structure passed in the waveform_register_tx_data_cb
-static void packet_tx(struct waveform_t *waveform,
-                      struct waveform_vita_packet *packet, size_t packet_size __attribute__((unused)),
-                      void *arg __attribute__((unused))) {
+static void data_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet,
+                    size_t packet_size __attribute__((unused)), void *arg __attribute__((unused))) {
     struct junk_context *ctx = waveform_get_context(waveform);
+    const size_t len = get_packet_byte_data_length(packet);
 
-    if (false == ctx->tx) {
+    // This runs on the same workqueue as the other data callbacks, so it may read the parameters too.
+    const struct junk_params *params = params_exchange_read(&ctx->params);
+    const bool ofdm = params->submode == JUNK_SUBMODE_OFDM;
+    const uint8_t *data = get_packet_byte_data(packet);
+
+    if (params->fec != JUNK_FEC_ON) {
+        const size_t queued = data_rx_queue(ctx, ofdm, data, len);
+        if (queued < len) {
+            fprintf(stderr, "%s transmit queue full, dropped %zu bytes\n", ofdm ? "OFDM" : "FSK", len - queued);
+        }
         return;
     }
 
-    float xmit_samples[get_packet_len(packet)];
-    memset(xmit_samples, 0, sizeof(xmit_samples));
-
-    for (int i = 0; i < get_packet_len(packet); i += 2) {
-        xmit_samples[i] = xmit_samples[i + 1] =
-                          sin_table[ctx->tx_phase] * 0.5F;
-        ctx->tx_phase = (ctx->tx_phase + 1) % 24;
+    // With FEC the bytes go in frames, which are only any use whole, so a frame that doesn't fit isn't queued at all.
+    for (size_t offset = 0; offset < len; offset += FEC_PAYLOAD) {
+        const size_t chunk = len - offset < FEC_PAYLOAD ? len - offset : FEC_PAYLOAD;
+        uint8_t frame[FEC_FRAME];
+        fec_frame(data + offset, chunk, frame);
+        if (!data_rx_queue_whole(ctx, ofdm, frame, sizeof(frame))) {
+            fprintf(stderr, "%s transmit queue full, dropped %zu bytes\n", ofdm ? "OFDM" : "FSK", len - offset);
+            return;
+        }
     }
-
-    waveform_send_data_packet(waveform, xmit_samples,
-                              get_packet_len(packet), TRANSMITTER_DATA);
 }
 
 /// \brief A callback to be invoked on the completion of a command on the radio.  In this case we just print the
@@ -234,11 +255,113 @@ static void packet_tx(struct waveform_t *waveform,
 /// \param message The descriptive message returned from the radio.  See the API documentation wiki
 /// \param arg A pointer to the context structure passed in the waveform_send_api_command_cb
 static void set_filter_callback(struct waveform_t *waveform __attribute__((unused)), const unsigned int code,
-                                char *message, void *arg __attribute__((unused))) {
+                                const char *message, void *arg __attribute__((unused))) {
     fprintf(stderr, "Invoked callback for code %d, message %s\n", code,
             message);
 }
 
+/// \brief A command callback to run a radio command at a precise time in the future.
+/// For example "slice 1 waveform_cmd at ms=250 filt 0 100 2800" sets the filter 250ms after the most recent receive
+/// packet, exactly on a sample boundary.  This is the building block for things like frequency hopping or slotted
+/// transmission, where every change has to land on a particular sample.  The command is handed to the timed command
+/// scheduler, which in turn sends it to the radio ahead of time with waveform_send_timed_api_command_cb.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the waveform command
+/// \param argv An array of the arguments in the waveform command
+/// \param arg A pointer to the context structure passed in the waveform_register_command_cb
+/// \return 0 for success otherwise a negative value on error
+static int at_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc, char *argv[],
+                      void *arg) {
+    struct junk_context *ctx = arg;
+    struct kwarg kwarg;
+
+    if (argc < 3 || !kwarg_split(argv[1], &kwarg) || !kwarg_is(&kwarg, "ms")) {
+        return COMMAND_ERR_SYNTAX;
+    }
+
+    char *end;
+    const long delay_ms = strtol(kwarg.value, &end, 10);
+    if (*end != '\0' || delay_ms < 0) {
+        return COMMAND_ERR_BAD_VALUE;
+    }
+
+    // Put the remaining arguments back together into the command to run.
+    char command[SCHEDULER_COMMAND_LEN] = {0};
+    size_t len = 0;
+    for (unsigned int i = 2; i < argc; ++i) {
+        const int ret = snprintf(command + len, sizeof(command) - len, "%s%s", i > 2 ? " " : "", argv[i]);
+        if (ret < 0 || (size_t) ret >= sizeof(command) - len) {
+            return COMMAND_ERR_BAD_VALUE;
+        }
+        len += ret;
+    }
+
+    // Count forward from the last sample we heard from the radio.  If we haven't received anything yet, fall back to
+    // the wall clock; the command then won't be sample aligned but it will still run at about the right time.
+    struct timespec at;
+    const uint64_t timestamp = atomic_load_explicit(&ctx->last_rx_timestamp, memory_order_relaxed);
+    if (timestamp != 0) {
+        scheduler_sample_time((uint32_t) (timestamp >> 32), (uint32_t) timestamp, JUNK_SAMPLE_RATE_HZ,
+                              delay_ms * JUNK_SAMPLE_RATE_HZ / 1000, &at);
+    } else {
+        clock_gettime(CLOCK_REALTIME, &at);
+        at.tv_sec += delay_ms / 1000;
+        at.tv_nsec += (delay_ms % 1000) * 1000000L;
+        if (at.tv_nsec >= 1000000000L) {
+            at.tv_sec += 1;
+            at.tv_nsec -= 1000000000L;
+        }
+    }
+
+    return scheduler_add(&ctx->scheduler, &at, "%s", command) == 0 ? COMMAND_OK : COMMAND_ERR_OUT_OF_RANGE;
+}
+
+/// \brief A command callback to trigger a SigMF recording by hand, for example "slice 1 waveform_cmd record".  The
+/// recording includes the seconds before the command as well as those after it.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the waveform command
+/// \param argv An array of the arguments in the waveform command
+/// \param arg A pointer to the context structure passed in the waveform_register_command_cb
+/// \return 0 for success otherwise a negative value on error
+static int record_command(struct waveform_t *waveform __attribute__((unused)), unsigned int argc,
+                          char *argv[] __attribute__((unused)), void *arg) {
+    struct junk_context *ctx = arg;
+
+    if (argc != 1) {
+        return COMMAND_ERR_SYNTAX;
+    }
+
+    // The recorder only exists while we are ACTIVE and it has been set up.
+    if (!lifecycle_enter(&ctx->lifecycle)) {
+        return COMMAND_ERR_NOT_READY;
+    }
+    sigmf_recorder_trigger(ctx->sigmf, "record command");
+    lifecycle_exit(&ctx->lifecycle);
+    return COMMAND_OK;
+}
+
+/// \brief Start the SigMF recorder.  A lifecycle resource acquired at ACTIVE.
+/// \param arg The struct sigmf_resource
+/// \return 0 for success otherwise a negative value
+static int sigmf_acquire(void *arg) {
+    struct sigmf_resource *sigmf = arg;
+
+    if (sigmf_recorder_init(&sigmf->recorder, &sigmf->config) != 0) {
+        fprintf(stderr, "Unable to start SigMF recorder %s: %s\n", sigmf->config.base_path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/// \brief Stop the SigMF recorder, keeping any recording in progress.  A lifecycle resource released at INACTIVE.
+/// \param arg The struct sigmf_resource
+static void sigmf_release(void *arg) {
+    struct sigmf_resource *sigmf = arg;
+
+    sigmf_recorder_destroy(&sigmf->recorder);
+    sigmf->config.first_index = sigmf->recorder.index;
+}
+
 /// \brief A callback to be called when the waveform changes state.  It is important to implement this callback so that
 /// your waveform knows when we have keyed the transmitter and we should start sending TX data packets rather than
 /// speaker packets.  In this function we note in the context structure that we are in transmit mode and allow the
@@ -255,11 +378,29 @@ static void state_test(struct waveform_t *waveform, const enum waveform_state st
         // Active state is when the user has selected the waveform in the user interface indicating their intent to use
         // this waveform.  We do any preparation we need to do to be able to receive data such as reinitializing data
         // structures, clearing buffers, etc.  In our case here we need to tell the radio to set the filter width to
-        // 3000 Hz.
+        // 3000 Hz.  We send it through the API queue in our context, which limits how many commands are outstanding
+        // at once and keeps track of how long the radio takes to answer.  Because we give it the key "filt 0", if
+        // another filter change for slice 0 is queued before this one goes out, only the newest is sent.
         case ACTIVE:
             fprintf(stderr, "wf is active\n");
-            waveform_send_api_command_cb(waveform, &set_filter_callback,
-                                         NULL, "filt 0 100 3000");
+
+            // Set up everything we only hold while active on a thread of its own so that we can get on with the
+            // packets.  Until it is done the data callbacks do without.
+            if (lifecycle_activate(&ctx->lifecycle) != 0) {
+                fprintf(stderr, "Failed to start activating resources: %s\n", strerror(errno));
+            }
+
+            api_queue_submit(&ctx->api, "filt 0", &set_filter_callback, NULL, "filt 0 100 3000");
+
+            // Have the data callback threads go real time and fault in everything they touch before audio flows.
+            if (ctx->realtime != NULL) {
+                realtime_arm(ctx->realtime);
+            }
+
+            // Start handing timed commands to the radio.  Nothing is scheduled until someone uses the "at" command.
+            if (scheduler_start(&ctx->scheduler) != 0) {
+                fprintf(stderr, "Failed to start the timed command scheduler\n");
+            }
             break;
 
         // Inactive state is when the user has selected another mode on the radio user interface.  We need to do any
@@ -268,6 +409,19 @@ static void state_test(struct waveform_t *waveform, const enum waveform_state st
         // to "sleep" the waveform.
         case INACTIVE:
             fprintf(stderr, "wf is inactive\n");
+            subscriptions_dump(&ctx->subscriptions, stderr);
+            api_queue_dump(&ctx->api, stderr);
+            scheduler_stop(&ctx->scheduler);
+            scheduler_dump(&ctx->scheduler, stderr);
+            if (ctx->realtime != NULL) {
+                realtime_dump(ctx->realtime, stderr);
+            }
+            if (ctx->capture != NULL) {
+                capture_flush(ctx->capture);
+            }
+
+            // Give back everything we only need while active, and say how much memory that returned.
+            lifecycle_deactivate(&ctx->lifecycle, stderr);
             break;
 
         // PTT requested is the state triggered when the user keys the radio, whether via MOX, the PTT button on the
@@ -295,15 +449,208 @@ static void state_test(struct waveform_t *waveform, const enum waveform_state st
     }
 }
 
+/// \brief Create the waveform on a radio and register all of its callbacks and meters.
+/// This is everything that has to be redone each time we connect to the radio, so it is kept together here and called
+/// from the reconnect loop in main.
+/// \param radio The radio returned from waveform_radio_create
+/// \param ctx The waveform context structure to attach to the new waveform
+/// \return The new waveform or NULL if it could not be created
+static struct waveform_t *junk_waveform_create(struct radio_t *radio, struct junk_context *ctx) {
+    int res;
+
+    // Create a waveform on the radio.  We need a name for it, which the radio uses internally to track the waveform.
+    // The short name is the name that will appear on the radio UI when selecting the "mode."  It must be four
+    // characters or less to fit within the confines of the GUI.
+
+    // The underlying mode determines what demodulation
+    // is done by the radio before sending the sample data to the waveform.  For example, if you are attempting to
+    // write a waveform implementing 1200baud AFSK, you would like to use "FM" as your underlying mode to be able to
+    // have the tones already decoded.  Conversely, you would want to use something like DIGU to decode HF digital
+    // modes.  There is a special mode called "RAW" that is not presented to users on the UI, but is nonetheless
+    // present for waveforms.  This will give you unmodulated data as I/Q pairs instead of L/R baseband data.  In this
+    // way you can do anything you want with it.  JUNK_MODE picks it, and in the audio modes junk_dsp_init puts Hilbert
+    // transform stages around the modems so that the stages between see complex baseband as RAW would give them.
+    struct waveform_t *waveform =
+            waveform_create(radio, "JunkMode", "JUNK", JUNK_MODE, "1.0.0", SR_24K);
+    if (waveform == NULL) {
+        fprintf(stderr, "Failed to create waveform\n");
+        return NULL;
+    }
+
+    // Register status callbacks for the statuses we declared interest in at the top of this file.  Note that
+    // registering a status callback does not cause the library to subscribe to these status messages; it only sets
+    // up a callback in case it hears one.  The subscription manager sends the matching "sub" commands once we are
+    // connected.  See the Wiki at https://github.com/flexradio/smartsdr-api-docs/wiki/TCPIP-sub for more information
+    // on the subscription types.  Each message is counted and run through the interest's filter before the handler
+    // sees it, so that statuses we don't care about cost as little as possible.  The "slice" handler keeps the slice
+    // state table in our context up to date.
+    slice_state_init(&ctx->slices, slice_changed, NULL);
+    subscriptions_init(&ctx->subscriptions, subscription_interests, ARRAY_SIZE(subscription_interests));
+    res = subscriptions_register(&ctx->subscriptions, waveform);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register status callbacks\n");
+    }
+
+    // Register a state callback for the waveform.  This callback is called when the waveform is activated/deactivated
+    // and when PTT is asserted or deasserted.  See the state_test callback in this file for a more detailed description
+    // of the states and their usages.
+    res = waveform_register_state_cb(waveform, &state_test, NULL);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register state callback\n");
+    }
+
+    // Register a callback to handle receiver data.  Whenever a receiver VITA-49 packet is received, this callback is
+    // fired.  The waveform is expected to process whatever data it's given from the receiver and act appropriately.
+    // If audio is desired from the speaker or remote audio, the waveform must send packets back to the radio on the
+    // speaker stream.  The pacing of such packets should match the incoming receiver data, i.e. you should be sending
+    // out as many samples as you receive.
+    res = waveform_register_rx_data_cb(waveform, &packet_rx, NULL);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register RX data callback\n");
+    }
+
+    // Register a callback to handle transmitter data.  Whenever a transmit VITA-49 packet is received, this callback
+    // is fired.  This packet will contain data from the microphone for the waveforms use.  If the waveform is not
+    // using the microphone for this mode (i.e. data), it is free to ignore the payload.  However, these packets can
+    // be used for pacing the data stream.  For every sample we get from the microphone, a sample is needs to be
+    // generated to the transmitter output stream from the waveform.  You need to use waveform_send_data_packet to
+    // send samples to the radio to be transmitted.  Note that the transmitter will not key until it has started to
+    // receive transmitter stream packets and it will not unkey until it has ceased to receive those packets.
+    res = waveform_register_tx_data_cb(waveform, &packet_tx, NULL);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register TX data callback\n");
+    }
+
+    // Register a callback for "byte stream" data.  This is data routed through the radio from a byte stream source
+    // such as a serial port or a RapidM modem.
+    res = waveform_register_byte_data_cb(waveform, &data_rx, NULL);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register byte data callback\n");
+    }
+
+    // Register a callback for commands from the client.  This callback is called whenever a command is received that
+    // is needed to be processed by the waveform.  This functionality can be used to, for example, set a submode that
+    // this waveform handles.  In the FreeDV waveform, we use this to determine whether to use 1600, 700C or any of
+    // the other sub modes.  This can also be used to set any other internal parameters of the waveform.  There is
+    // currently no generic way in the client software to send these commands, but they can be sent using a companion
+    // application to control the waveform.  Our commands and the parameters they accept are declared in a table in
+    // commands.c and commands.def; each handler gets the parameter exchange as its context so that it can hand new
+    // parameters to the data callbacks.
+    for (size_t i = 0; i < junk_commands_count; ++i) {
+        res = waveform_register_command_cb(waveform, junk_commands[i].name, junk_commands[i].handler, &ctx->params);
+        if (res == -1) {
+            fprintf(stderr, "Failed to register %s command callback\n", junk_commands[i].name);
+        }
+    }
+
+    // The "at" command needs the whole context rather than just the parameters, so it is registered on its own.
+    res = waveform_register_command_cb(waveform, "at", at_command, ctx);
+    if (res == -1) {
+        fprintf(stderr, "Failed to register at command callback\n");
+    }
+
+    // Only offer the "record" command if there is a SigMF recorder to trigger.
+    if (ctx->sigmf != NULL) {
+        res = waveform_register_command_cb(waveform, "record", record_command, ctx);
+        if (res == -1) {
+            fprintf(stderr, "Failed to register record command callback\n");
+        }
+    }
+
+    // Set up the meters we intend to send to the radio.  This sends a command to make sure all of those meters are
+    // registered and ready to receive data.  The data can then be sent at periodic intervals using the
+    // waveform_meter_set_*_value family of functions followed by waveform_meters_send.
+    waveform_register_meter_list(waveform, meters, ARRAY_SIZE(meters));
+
+    // Set the waveform context.  This is a pointer to a data structure of your choice that's kept with the opaque
+    // waveform structure and made available to any of the callbacks using the waveform_get_context() function.  This
+    // can be used to store any sort of persistent state you need to have between callbacks.  In our example here we
+    // use this to store the current phase of the NCOs and whether we are transmitting.  This could also be used to
+    // store our current submode or any other parameters.  There is also a per-callback context in case you need state
+    // data that only applies to a single callback.
+    waveform_set_context(waveform, ctx);
+
+    return waveform;
+}
+
+/// \brief Save the DSP portion of the waveform context so that it can be restored after a reconnect.
+/// \param ctx The waveform context to read from
+/// \param snapshot The snapshot to fill in
+static void junk_context_save(const struct junk_context *ctx, struct junk_dsp_snapshot *snapshot) {
+    snapshot->rx_phase = atomic_load(&ctx->rx_nco.phase);
+    snapshot->tx_phase = atomic_load(&ctx->tx_nco.phase);
+    snapshot->rx_shift_phase = atomic_load(&ctx->rx_shift.rotate.osc.phase);
+    snapshot->tx_shift_phase = atomic_load(&ctx->tx_shift.rotate.osc.phase);
+    snapshot->snr = ctx->snr;
+    snapshot->byte_data_counter = ctx->byte_data_counter;
+    snapshot->params = *params_exchange_current(&ctx->params);
+}
+
+/// \brief Restore a previously saved DSP snapshot into a freshly initialized waveform context, after junk_dsp_init has
+/// set its oscillators going.
+/// \param ctx The waveform context to write to
+/// \param snapshot The snapshot previously filled in by junk_context_save
+static void junk_context_restore(struct junk_context *ctx, const struct junk_dsp_snapshot *snapshot) {
+    atomic_store(&ctx->rx_nco.phase, snapshot->rx_phase);
+    atomic_store(&ctx->tx_nco.phase, snapshot->tx_phase);
+    atomic_store(&ctx->rx_shift.rotate.osc.phase, snapshot->rx_shift_phase);
+    atomic_store(&ctx->tx_shift.rotate.osc.phase, snapshot->tx_shift_phase);
+    ctx->snr = snapshot->snr;
+    ctx->byte_data_counter = snapshot->byte_data_counter;
+    params_exchange_init(&ctx->params, &snapshot->params);
+    ctx->tx = false;
+}
+
+/// \brief Read the monotonic clock in seconds.  Used to decide whether a connection was up long enough to reset the
+/// reconnect backoff.
+/// \return The current value of CLOCK_MONOTONIC in seconds
+static time_t monotonic_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+/// \brief Sleep for the given number of milliseconds, restarting the sleep if it is interrupted by a signal.
+/// \param ms The number of milliseconds to sleep
+static void sleep_milliseconds(unsigned int ms) {
+    struct timespec delay = {
+        .tv_sec = ms / 1000,
+        .tv_nsec = (long) (ms % 1000) * 1000000L
+    };
+
+    while (nanosleep(&delay, &delay) == -1)
+        ;
+}
+
+/// \brief The next step of the exponential backoff between attempts to reach the radio.
+/// \param backoff_ms The backoff just waited, 0 for none
+/// \return The backoff to wait next time
+static unsigned int backoff_next(const unsigned int backoff_ms) {
+    if (backoff_ms == 0)
+        return RECONNECT_BACKOFF_INITIAL_MS;
+    return backoff_ms * 2 > RECONNECT_BACKOFF_MAX_MS ? RECONNECT_BACKOFF_MAX_MS : backoff_ms * 2;
+}
+
 /// \brief Print a usage message to the console
 /// @param progname The name of this program
 static void usage(const char *progname) {
     fprintf(stderr, "Usage: %s [options]\n\n", progname);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -h <hostname>, --host=<hostname>  Hostname or IP of the radio [default: perform discovery]\n");
+    fprintf(stderr, "                                     May be given more than once; the first to answer is used\n");
+    fprintf(stderr, "  -c <file>, --radio-cache=<file>    File holding the last radio address [default: ~/.cache]\n");
+    fprintf(stderr, "  -w <count>, --api-window=<count>   Radio commands awaiting a response at once [default: %d]\n",
+            API_QUEUE_DEFAULT_WINDOW);
+    fprintf(stderr, "  -r <file>, --record=<file>         Record every sample packet to a capture file for replay\n");
+    fprintf(stderr, "  -s <base>, --sigmf=<base>          Make triggered SigMF recordings of the RX stream\n");
+    fprintf(stderr, "  -t[<prio>], --realtime[=<prio>]    Lock memory, run data callbacks SCHED_FIFO [default: %d]\n",
+            REALTIME_DEFAULT_PRIORITY);
+    fprintf(stderr, "  -a <cpu>, --cpu=<cpu>              With --realtime, pin the data callbacks to this CPU\n");
+    fprintf(stderr, "  -m <addr>, --metrics=<addr>        Serve Prometheus metrics on a Unix socket path, port or\n");
+    fprintf(stderr, "                                     host:port [default: off, TCP binds to 127.0.0.1]\n");
 }
 
-/// \brief The command line parameters.  Currently just the hostname or IP of the radio
+/// \brief The command line parameters
 static const struct option example_options[] = {
     {
         .name = "host",
@@ -311,6 +658,48 @@ static const struct option example_options[] = {
         .flag = NULL,
         .val = 'h' //  This keeps the value the same as the short value -h
     },
+    {
+        .name = "radio-cache",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'c'
+    },
+    {
+        .name = "api-window",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'w'
+    },
+    {
+        .name = "record",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'r'
+    },
+    {
+        .name = "sigmf",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 's'
+    },
+    {
+        .name = "realtime",
+        .has_arg = optional_argument,
+        .flag = NULL,
+        .val = 't'
+    },
+    {
+        .name = "cpu",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'a'
+    },
+    {
+        .name = "metrics",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'm'
+    },
     {0} // Sentinel
 };
 
@@ -319,42 +708,112 @@ static const struct option example_options[] = {
 // ****************************************
 int main(const int argc, char **argv) {
     struct sockaddr_in *addr = NULL;
+    struct sockaddr_in *candidates = NULL;
+    size_t num_candidates = 0;
+    char cache_path[PATH_MAX] = {0};
+    unsigned int api_window = API_QUEUE_DEFAULT_WINDOW;
+    const char *record_path = NULL;
+    struct capture capture = {0};
+    const char *sigmf_base = NULL;
+    struct sigmf_resource sigmf = {0};
+    int realtime_priority = 0;
+    int realtime_cpu = -1;
+    struct realtime realtime;
+    const char *metrics_address = NULL;
+    struct metrics metrics;
 
-    // Create an instance of the waveform context structure to register with the library.  We can get a pointer to
-    // this structure back by using waveform_get_context on the opaque waveform structure.  The library user is
-    // responsible for all memory management and thread concurrency issues with this structure. The library merely
-    // stores a pointer and regurgitates it back to the user when asked.
-    struct junk_context ctx = {0};
+    // The DSP state carried from one connection to the next.  It starts zeroed just like a fresh context would, with
+    // the default waveform parameters.
+    struct junk_dsp_snapshot snapshot = {.params = junk_params_defaults};
 
     // Parse the command line
     while (1) {
         int indexptr;
-        const int option = getopt_long(argc, argv, "h:", example_options, &indexptr);
+        const int option = getopt_long(argc, argv, "h:c:w:r:s:t::a:m:", example_options, &indexptr);
 
         if (option == -1) // We're done with options
             break;
 
         switch (option) { // NOLINT(*-multiway-paths-covered)
             case 'h': {
-                if (addr != NULL) {
-                    free(addr);
-                    usage(basename(argv[0]));
-                    exit(1);
-                }
+                // A name may resolve to several addresses (e.g. a radio with both wired and wireless interfaces).
+                // Keep all of them as candidates and let them race rather than betting on the first one.
+                const struct addrinfo hints = {
+                    .ai_family = AF_INET,
+                    .ai_socktype = SOCK_STREAM
+                };
 
                 struct addrinfo *addrlist;
-                const int ret = getaddrinfo(optarg, "4992", NULL, &addrlist);
+                const int ret = getaddrinfo(optarg, "4992", &hints, &addrlist);
                 if (ret != 0) {
                     fprintf(stderr, "Host lookup for %s failed: %s\n", optarg, gai_strerror(ret));
                     exit(1);
                 }
 
-                addr = malloc(sizeof(*addr));
-                memcpy(addr, addrlist[0].ai_addr, sizeof(*addr));
+                for (const struct addrinfo *ai = addrlist; ai != NULL; ai = ai->ai_next) {
+                    struct sockaddr_in *grown = realloc(candidates, (num_candidates + 1) * sizeof(*candidates));
+                    if (grown == NULL) {
+                        fprintf(stderr, "Out of memory\n");
+                        exit(1);
+                    }
+                    candidates = grown;
+                    memcpy(&candidates[num_candidates++], ai->ai_addr, sizeof(*candidates));
+                }
 
                 freeaddrinfo(addrlist);
                 break;
             }
+            case 'c':
+                if (snprintf(cache_path, sizeof(cache_path), "%s", optarg) >= (int) sizeof(cache_path)) {
+                    fprintf(stderr, "Radio cache path too long\n");
+                    exit(1);
+                }
+                break;
+            case 'w': {
+                char *end;
+                const unsigned long window = strtoul(optarg, &end, 10);
+                if (*end != '\0' || window < 1 || window > API_QUEUE_MAX_WINDOW) {
+                    fprintf(stderr, "API window must be between 1 and %d\n", API_QUEUE_MAX_WINDOW);
+                    exit(1);
+                }
+                api_window = (unsigned int) window;
+                break;
+            }
+            case 'r':
+                record_path = optarg;
+                break;
+            case 's':
+                sigmf_base = optarg;
+                break;
+            case 't': {
+                if (optarg == NULL) {
+                    realtime_priority = REALTIME_DEFAULT_PRIORITY;
+                    break;
+                }
+                char *end;
+                const long priority = strtol(optarg, &end, 10);
+                if (*end != '\0' || priority < sched_get_priority_min(SCHED_FIFO) ||
+                    priority > sched_get_priority_max(SCHED_FIFO)) {
+                    fprintf(stderr, "Real-time priority must be between %d and %d\n",
+                            sched_get_priority_min(SCHED_FIFO), sched_get_priority_max(SCHED_FIFO));
+                    exit(1);
+                }
+                realtime_priority = (int) priority;
+                break;
+            }
+            case 'a': {
+                char *end;
+                const long cpu = strtol(optarg, &end, 10);
+                if (*end != '\0' || cpu < 0 || cpu >= sysconf(_SC_NPROCESSORS_CONF)) {
+                    fprintf(stderr, "CPU must be between 0 and %ld\n", sysconf(_SC_NPROCESSORS_CONF) - 1);
+                    exit(1);
+                }
+                realtime_cpu = (int) cpu;
+                break;
+            }
+            case 'm':
+                metrics_address = optarg;
+                break;
             default:
                 usage(basename(argv[0]));
                 exit(1);
@@ -371,129 +830,197 @@ int main(const int argc, char **argv) {
         exit(1);
     }
 
-    //  If we didn't get an address on the command line, perform discovery for it.  We wait for 10 seconds before giving
-    //  up.  Most of the time a production waveform will not perform this process as it should be given the IP address
-    //  to the local radio from some process.
-    if (addr == NULL) {
-        const struct timeval timeout = {
-            .tv_sec = 10,
-            .tv_usec = 0
+    // The capture file spans reconnects, so that a field problem that involves the radio dropping us is recorded as one
+    // continuous stream.  Replay it with waveform-replay.
+    if (record_path != NULL && capture_create(&capture, record_path, JUNK_SAMPLE_RATE_HZ) != 0) {
+        fprintf(stderr, "Unable to create capture file %s: %s\n", record_path, strerror(errno));
+        exit(1);
+    }
+
+    // The SigMF recorder keeps the last few seconds of the receive stream in memory and writes them out along with
+    // what follows whenever something triggers a recording.  It is started each time the waveform goes ACTIVE and
+    // stopped at INACTIVE, but we try it once now so that a bad path is reported straight away.
+    if (sigmf_base != NULL) {
+        sigmf.config = (struct sigmf_config) {
+            .base_path = sigmf_base,
+            .sample_rate = JUNK_SAMPLE_RATE_HZ,
+            .complex = false,
+            .description = "JunkMode (JUNK) waveform-example 1.0.0, " JUNK_MODE " left/right audio",
+            .pre_seconds = SIGMF_DEFAULT_PRE_SECONDS,
+            .post_seconds = SIGMF_DEFAULT_POST_SECONDS,
         };
+        if (sigmf_acquire(&sigmf) != 0) {
+            exit(1);
+        }
+        sigmf_release(&sigmf);
+    }
 
-        addr = waveform_discover_radio(&timeout);
-        if (addr == NULL) {
-            fprintf(stderr, "No radio found");
-            return 0;
+    // In real-time mode memory is locked now, before the library creates its threads, so that their stacks are locked
+    // too.  The data callback threads set their own scheduling at ACTIVE; see realtime.h.  Page faults and preemption
+    // by everything else on the radio's CPU are what glitch the audio under load, and this takes both off the table.
+    if (realtime_cpu >= 0 && realtime_priority == 0) {
+        fprintf(stderr, "--cpu only applies with --realtime\n");
+        exit(1);
+    }
+    if (realtime_priority != 0) {
+        if (realtime_init(&realtime, realtime_priority, realtime_cpu) != 0) {
+            fprintf(stderr, "Unable to lock memory, continuing without: %s\n", strerror(errno));
         }
     }
 
-    fprintf(stderr, "Connecting to radio at %s:%u\n", inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
+    // The exporter spans reconnects just like the capture file, so that the counters are continuous and Prometheus
+    // only sees a reset when we restart.  Scrapes are answered on a thread of our own; the data callbacks only ever
+    // touch their own thread's counters.  See metrics.h.
+    if (metrics_address != NULL) {
+        if (metrics_init(&metrics) != 0 || metrics_serve(&metrics, metrics_address) != 0) {
+            fprintf(stderr, "Unable to serve metrics on %s: %s\n", metrics_address, strerror(errno));
+            exit(1);
+        }
+        fprintf(stderr, "Serving metrics on %s\n", metrics_address);
+    }
 
-    // Create a radio to which to connect.  We need its address in order to create an instance.  We are returned an
-    // opaque structure to manage the radio.  Note that this is just a data structure at this point and we have not
-    // connected to the radio.  The library does not connect to the radio until waveform_radio_start is invoked.
-    struct radio_t *radio = waveform_radio_create(addr);
-    free(addr);
+    if (cache_path[0] == '\0' && discovery_cache_default_path(cache_path, sizeof(cache_path)) != 0) {
+        fprintf(stderr, "Unable to determine radio cache path\n");
+    }
 
+    //  If we were given addresses on the command line, probe all of them at once and use whichever radio answers
+    //  first.  Otherwise perform discovery for it, racing it against the radio we last connected to so that restarts
+    //  are nearly instant when the radio hasn't moved.  Each look waits up to 10 seconds for an answer.  Most of the
+    //  time a production waveform will not perform discovery as it should be given the IP address to the local radio
+    //  from some process, and in that case we never consult the cache either so we cannot wander off to another radio.
+    const bool discover = num_candidates == 0;
+    if (discover && cache_path[0] != '\0') {
+        struct sockaddr_in cached;
+        if (discovery_cache_load(cache_path, &cached) == 0) {
+            candidates = malloc(sizeof(*candidates));
+            if (candidates != NULL) {
+                candidates[num_candidates++] = cached;
+            }
+        }
+    }
 
-    // Create a waveform on the radio.  We need a name for it, which the radio uses internally to track the waveform.
-    // The short name is the name that will appear on the radio UI when selecting the "mode."  It must be four
-    // characters or less to fit within the confines of the GUI.
+    const struct timeval timeout = {
+        .tv_sec = 10,
+        .tv_usec = 0
+    };
 
-    // The underlying mode determines what demodulation
-    // is done by the radio before sending the sample data to the waveform.  For example, if you are attempting to
-    // write a waveform implementing 1200baud AFSK, you would like to use "FM" as your underlying mode to be able to
-    // have the tones already decoded.  Conversely, you would want to use something like DIGU to decode HF digital
-    // modes.  There is a special mode called "RAW" that is not presented to users on the UI, but is nonetheless
-    // present for waveforms.  This will give you unmodulated data as I/Q pairs instead of L/R baseband data.  In this
-    // way you can do anything you want with it.
-    struct waveform_t *test_waveform =
-            waveform_create(radio, "JunkMode", "JUNK", "DIGU", "1.0.0", SR_24K);
-
-    // Register a status callback so that we get updates on the slice.  Any "slice" status will cause the echo_command
-    // callback to be run.  You can specify a pointer to a context structure if you need to pass something just for
-    // this callback, otherwise you can use the global waveform context structure.  Note that this command does not
-    // cause the library to subscribe to these status messages; it only sets up a callback in case it hears one.  You
-    // must use waveform_send_api_command to send a subscribe command to the radio as per the API.  See the Wiki at
-    // https://github.com/flexradio/smartsdr-api-docs/wiki/TCPIP-sub for more information on the subscription types
-    int res = waveform_register_status_cb(test_waveform, "slice", echo_command, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register status callback\n");
+    // A single address given on the command line is the radio we are meant to use, so we go straight to connecting
+    // to it: a radio that is still booting refuses the probe, and the reconnect loop below already waits for it.
+    // Otherwise we keep looking, backing off in the same way, rather than give up on a radio that isn't up yet.
+    unsigned int backoff_ms = 0;
+    if (!discover && num_candidates == 1) {
+        addr = malloc(sizeof(*addr));
+        if (addr == NULL) {
+            fprintf(stderr, "Unable to allocate radio address\n");
+            exit(1);
+        }
+        *addr = candidates[0];
+    } else {
+        while ((addr = discovery_find_radio(candidates, num_candidates, discover, &timeout)) == NULL) {
+            backoff_ms = backoff_next(backoff_ms);
+            fprintf(stderr, "No radio found, looking again in %u ms\n", backoff_ms);
+            sleep_milliseconds(backoff_ms);
+        }
     }
+    free(candidates);
 
-    // Register a state callback for the waveform.  This callback is called when the waveform is activated/deactivated
-    // and when PTT is asserted or deasserted.  See the state_test callback in this file for a more detailed description
-    // of the states and their usages.
-    res = waveform_register_state_cb(test_waveform, &state_test, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register state callback\n");
-    }
+    // Keep connecting to the radio for as long as we run.  We hold on to the address for the life of the process so
+    // that after a disconnect we go straight back to the radio we were talking to rather than paying for discovery
+    // again.  Each pass through the loop builds a brand new radio and waveform because the library does not support
+    // restarting a radio once its event loops have stopped.
+    backoff_ms = 0;
+    while (1) {
+        fprintf(stderr, "Connecting to radio at %s:%u\n", inet_ntoa(addr->sin_addr), ntohs(addr->sin_port));
 
-    // Register a callback to handle receiver data.  Whenever a receiver VITA-49 packet is received, this callback is
-    // fired.  The waveform is expected to process whatever data it's given from the receiver and act appropriately.
-    // If audio is desired from the speaker or remote audio, the waveform must send packets back to the radio on the
-    // speaker stream.  The pacing of such packets should match the incoming receiver data, i.e. you should be sending
-    // out as many samples as you receive.
-    res = waveform_register_rx_data_cb(test_waveform, &packet_rx, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register RX data callback\n");
-    }
+        // Create an instance of the waveform context structure to register with the library.  We can get a pointer to
+        // this structure back by using waveform_get_context on the opaque waveform structure.  The library user is
+        // responsible for all memory management and thread concurrency issues with this structure. The library merely
+        // stores a pointer and regurgitates it back to the user when asked.  We restore the DSP state saved from the
+        // last connection into it so that we resume where we left off.
+        struct junk_context ctx = {0};
+        junk_dsp_init(&ctx);
+        junk_context_restore(&ctx, &snapshot);
+        telemetry_init(&ctx.telemetry, JUNK_SAMPLE_RATE_HZ);
+        ctx.capture = record_path != NULL ? &capture : NULL;
+        ctx.sigmf = sigmf_base != NULL ? &sigmf.recorder : NULL;
+        ctx.realtime = realtime_priority != 0 ? &realtime : NULL;
+        ctx.metrics = metrics_address != NULL ? &metrics : NULL;
 
-    // Register a callback to handle transmitter data.  Whenever a transmit VITA-49 packet is received, this callback
-    // is fired.  This packet will contain data from the microphone for the waveforms use.  If the waveform is not
-    // using the microphone for this mode (i.e. data), it is free to ignore the payload.  However, these packets can
-    // be used for pacing the data stream.  For every sample we get from the microphone, a sample is needs to be
-    // generated to the transmitter output stream from the waveform.  You need to use waveform_send_data_packet to
-    // send samples to the radio to be transmitted.  Note that the transmitter will not key until it has started to
-    // receive transmitter stream packets and it will not unkey until it has ceased to receive those packets.
-    res = waveform_register_tx_data_cb(test_waveform, &packet_tx, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register TX data callback\n");
-    }
+        // Create a radio to which to connect.  We need its address in order to create an instance.  We are returned an
+        // opaque structure to manage the radio.  Note that this is just a data structure at this point and we have not
+        // connected to the radio.  The library does not connect to the radio until waveform_radio_start is invoked.
+        struct radio_t *radio = waveform_radio_create(addr);
+        if (radio == NULL) {
+            fprintf(stderr, "Failed to create radio\n");
+            exit(1);
+        }
 
-    // Register a callback for "byte stream" data.  This is data routed through the radio from a byte stream source
-    // such as a serial port or a RapidM modem.
-    res = waveform_register_byte_data_cb(test_waveform, &data_rx, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register byte data callback\n");
-    }
+        // The resources we only hold while ACTIVE.  See lifecycle.h.
+        lifecycle_init(&ctx.lifecycle);
+        if (sigmf_base != NULL) {
+            lifecycle_register(&ctx.lifecycle, "SigMF recorder", sigmf_acquire, sigmf_release, &sigmf);
+        }
+        lifecycle_register(&ctx.lifecycle, "OFDM modem", ofdm_acquire, ofdm_release, &ctx.ofdm);
 
-    // Register a callback for commands from the client.  This callback is called whenever a command is received that
-    // is needed to be processed by the waveform.  This functionality can be used to, for example, set a submode that
-    // this waveform handles.  In the FreeDV waveform, we use this to determine whether to use 1600, 700C or any of
-    // the other sub modes.  This can also be used to set any other internal parameters of the waveform.  There is
-    // currently no generic way in the client software to send these commands, but they can be sent using a companion
-    // application to control the waveform.
-    res = waveform_register_command_cb(test_waveform, "set", test_command, NULL);
-    if (res == -1) {
-        fprintf(stderr, "Failed to register command callback\n");
-    }
+        struct waveform_t *test_waveform = junk_waveform_create(radio, &ctx);
+        if (test_waveform == NULL) {
+            waveform_radio_destroy(radio);
+            exit(1);
+        }
 
-    // Set up the meters we intend to send to the radio.  This sends a command to make sure all of those meters are
-    // registered and ready to receive data.  The data can then be sent at periodic intervals using the
-    // waveform_meter_set_*_value family of functions followed by waveform_meters_send.
-    waveform_register_meter_list(test_waveform, meters, ARRAY_SIZE(meters));
+        // Commands sent from our callbacks go through this queue so that they can be paced, coalesced and timed.
+        api_queue_init(&ctx.api, test_waveform, api_window);
+        ctx.api.metrics = ctx.metrics;
 
-    // Set the waveform context.  This is a pointer to a data structure of your choice that's kept with the opaque
-    // waveform structure and made available to any of the callbacks using the waveform_get_context() function.  This
-    // can be used to store any sort of persistent state you need to have between callbacks.  In our example here we
-    // use this to store the current phase of the NCOs and whether we are transmitting.  This could also be used to
-    // store our current submode or any other parameters.  There is also a per-callback context in case you need state
-    // data that only applies to a single callback.
-    waveform_set_context(test_waveform, &ctx);
+        // Timed commands are handed to the radio this far ahead of when they must execute.
+        scheduler_init(&ctx.scheduler, test_waveform, SCHEDULER_DEFAULT_LEAD_MS);
 
-    // Start the radio.  This causes the library to connect to the radio and start its various event loops.  It is not
-    // currently supported to change any callbacks after the waveform_start_radio command has been executed.
-    res = waveform_radio_start(radio);
-    if (res == -1) {
-        fprintf(stderr, "Failed to start radio\n");
-    }
+        // Start the radio.  This causes the library to connect to the radio and start its various event loops.  It is
+        // not currently supported to change any callbacks after the waveform_start_radio command has been executed.
+        const time_t started = monotonic_seconds();
+        int res = waveform_radio_start(radio);
+        if (res == -1) {
+            fprintf(stderr, "Failed to start radio\n");
+        } else {
+            // Now that we are connected, ask the radio for the statuses we are interested in.
+            subscriptions_send(&ctx.subscriptions, test_waveform);
 
-    // Wait for the radio to be finished.  In normal operation we should not ever get here unless the radio is going
-    // to shut down for some reason or we have been forcibly disconnected by the radio.  Essentially this waits until
-    // the various event loop threads have ceased running.
-    res = waveform_radio_wait(radio);
-    if (res == -1) {
-        fprintf(stderr, "Failed to wait on radio completion\n");
+            // Remember this radio so that the next time we start we can try it right away.
+            if (cache_path[0] != '\0' && discovery_cache_save(cache_path, addr) != 0) {
+                fprintf(stderr, "Failed to save radio address to %s\n", cache_path);
+            }
+
+            // Wait for the radio to be finished.  In normal operation we should not ever get here unless the radio is
+            // going to shut down for some reason or we have been forcibly disconnected by the radio.  Essentially this
+            // waits until the various event loop threads have ceased running.
+            res = waveform_radio_wait(radio);
+            if (res == -1) {
+                fprintf(stderr, "Failed to wait on radio completion\n");
+            }
+        }
+
+        // The event loops have stopped, so nothing else is touching the context.  Save off the DSP state and tear
+        // down this instance of the radio.
+        junk_context_save(&ctx, &snapshot);
+        lifecycle_deactivate(&ctx.lifecycle, stderr);
+        scheduler_stop(&ctx.scheduler);
+        scheduler_destroy(&ctx.scheduler);
+        api_queue_destroy(&ctx.api);
+        if (ctx.capture != NULL) {
+            capture_flush(ctx.capture);
+        }
+        waveform_destroy(test_waveform);
+        waveform_radio_destroy(radio);
+
+        // If the connection stayed up for a while this is a fresh failure and we should retry right away.  Otherwise
+        // back off exponentially so that we don't hammer a radio that is rebooting or refusing us.
+        if (monotonic_seconds() - started >= RECONNECT_STABLE_SECS) {
+            backoff_ms = 0;
+        }
+
+        fprintf(stderr, "Lost connection to radio, reconnecting in %u ms\n", backoff_ms);
+        sleep_milliseconds(backoff_ms);
+
+        backoff_ms = backoff_next(backoff_ms);
     }
 }
@@ -0,0 +1,439 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file metrics.c
+/// @brief Runtime counters and histograms, served to Prometheus from a local socket
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "metrics.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// How often the exporter thread looks up from poll to see whether it should stop
+#define METRICS_POLL_MS 250
+
+// How long a scraper gets to send its request before we answer anyway
+#define METRICS_REQUEST_TIMEOUT_SECS 1
+
+// The most of a request we read.  We only look at the method.
+#define METRICS_REQUEST_LEN 1024
+
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4; charset=utf-8"
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief How a counter or histogram is exposed.  Consecutive entries with the same family share its HELP and TYPE.
+struct metrics_name {
+    const char *family;
+    const char *labels;
+    const char *help;
+};
+
+/// \brief Every shard added up
+struct metrics_totals {
+    uint64_t counters[METRICS_COUNTERS];
+    uint64_t buckets[METRICS_HISTOGRAMS][METRICS_BUCKETS + 1];
+    uint64_t sum_ns[METRICS_HISTOGRAMS];
+};
+
+// ****************************************
+// Static Variables
+// ****************************************
+
+static const struct metrics_name counter_names[METRICS_COUNTERS] = {
+    [METRICS_PACKETS_IN_RX] = {"waveform_packets_in_total", "stream=\"rx\"", "Sample packets received from the radio"},
+    [METRICS_PACKETS_IN_TX] = {"waveform_packets_in_total", "stream=\"tx\"", "Sample packets received from the radio"},
+    [METRICS_PACKETS_OUT_SPEAKER] = {"waveform_packets_out_total", "type=\"speaker\"",
+                                     "Sample packets sent to the radio"},
+    [METRICS_PACKETS_OUT_TRANSMITTER] = {"waveform_packets_out_total", "type=\"transmitter\"",
+                                         "Sample packets sent to the radio"},
+    [METRICS_SAMPLES_OUT_SPEAKER] = {"waveform_samples_out_total", "type=\"speaker\"", "Floats sent to the radio"},
+    [METRICS_SAMPLES_OUT_TRANSMITTER] = {"waveform_samples_out_total", "type=\"transmitter\"",
+                                         "Floats sent to the radio"},
+    [METRICS_BYTE_PACKETS_OUT] = {"waveform_byte_packets_out_total", NULL, "Byte data packets sent to the radio"},
+    [METRICS_BYTES_OUT] = {"waveform_byte_data_out_bytes_total", NULL, "Bytes sent in byte data packets"},
+    [METRICS_METER_SENDS] = {"waveform_meter_sends_total", NULL, "Meter updates sent to the radio"},
+};
+
+static const struct metrics_name histogram_names[METRICS_HISTOGRAMS] = {
+    [METRICS_CALLBACK_RX] = {"waveform_callback_duration_seconds", "stream=\"rx\"",
+                             "Time spent in the data callbacks per packet"},
+    [METRICS_CALLBACK_TX] = {"waveform_callback_duration_seconds", "stream=\"tx\"",
+                             "Time spent in the data callbacks per packet"},
+    [METRICS_METER_SEND] = {"waveform_meter_send_duration_seconds", NULL, "Time taken to send the meters"},
+    [METRICS_COMMAND_RTT] = {"waveform_command_rtt_seconds", NULL, "Radio command round trips through the API queue"},
+};
+
+__thread struct metrics_shard *metrics_thread_shard;
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Add a shard's counts to the totals.  Must be called with the lock held.
+/// \param totals The totals
+/// \param shard The shard
+static void metrics_sum(struct metrics_totals *totals, const struct metrics_shard *shard) {
+    for (size_t i = 0; i < METRICS_COUNTERS; ++i)
+        totals->counters[i] += atomic_load_explicit(&shard->counters[i], memory_order_relaxed);
+
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; ++h) {
+        for (size_t b = 0; b <= METRICS_BUCKETS; ++b)
+            totals->buckets[h][b] += atomic_load_explicit(&shard->histograms[h].buckets[b], memory_order_relaxed);
+        totals->sum_ns[h] += atomic_load_explicit(&shard->histograms[h].sum_ns, memory_order_relaxed);
+    }
+}
+
+/// \brief Fold an exiting thread's shard into the retired totals and make it available again.
+/// \param arg The shard
+static void metrics_retire_shard(void *arg) {
+    struct metrics_shard *shard = arg;
+    struct metrics *metrics = shard->owner;
+
+    pthread_mutex_lock(&metrics->lock);
+    for (size_t i = 0; i < METRICS_COUNTERS; ++i) {
+        atomic_fetch_add_explicit(&metrics->retired.counters[i],
+                                  atomic_load_explicit(&shard->counters[i], memory_order_relaxed),
+                                  memory_order_relaxed);
+        atomic_store_explicit(&shard->counters[i], 0, memory_order_relaxed);
+    }
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; ++h) {
+        for (size_t b = 0; b <= METRICS_BUCKETS; ++b) {
+            atomic_fetch_add_explicit(&metrics->retired.histograms[h].buckets[b],
+                                      atomic_load_explicit(&shard->histograms[h].buckets[b], memory_order_relaxed),
+                                      memory_order_relaxed);
+            atomic_store_explicit(&shard->histograms[h].buckets[b], 0, memory_order_relaxed);
+        }
+        atomic_fetch_add_explicit(&metrics->retired.histograms[h].sum_ns,
+                                  atomic_load_explicit(&shard->histograms[h].sum_ns, memory_order_relaxed),
+                                  memory_order_relaxed);
+        atomic_store_explicit(&shard->histograms[h].sum_ns, 0, memory_order_relaxed);
+    }
+    shard->in_use = false;
+    pthread_mutex_unlock(&metrics->lock);
+}
+
+/// \brief Print the HELP and TYPE lines for a family unless the previous entry already did.
+/// \param file Where to write
+/// \param names The table
+/// \param i The entry
+/// \param type The Prometheus type
+static void metrics_write_header(FILE *file, const struct metrics_name *names, const size_t i, const char *type) {
+    if (i > 0 && strcmp(names[i - 1].family, names[i].family) == 0)
+        return;
+
+    fprintf(file, "# HELP %s %s.\n", names[i].family, names[i].help);
+    fprintf(file, "# TYPE %s %s\n", names[i].family, type);
+}
+
+/// \brief Answer one scrape.
+/// \param metrics The metrics
+/// \param fd The connection
+static void metrics_answer(struct metrics *metrics, const int fd) {
+    const struct timeval timeout = {.tv_sec = METRICS_REQUEST_TIMEOUT_SECS, .tv_usec = 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // Read until the end of the headers, or for as long as the scraper takes to send them.
+    char request[METRICS_REQUEST_LEN + 1];
+    size_t len = 0;
+    while (len < METRICS_REQUEST_LEN) {
+        const ssize_t n = recv(fd, request + len, METRICS_REQUEST_LEN - len, 0);
+        if (n <= 0)
+            break;
+        len += (size_t) n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") != NULL)
+            break;
+    }
+    request[len] = '\0';
+
+    char *body = NULL;
+    size_t body_len = 0;
+    FILE *file = open_memstream(&body, &body_len);
+    if (file == NULL)
+        return;
+
+    const bool head = strncmp(request, "HEAD ", 5) == 0;
+    const char *status = "200 OK";
+    if (head || strncmp(request, "GET ", 4) == 0) {
+        metrics_write(metrics, file);
+    } else {
+        status = "405 Method Not Allowed";
+        fprintf(file, "Only GET is supported\n");
+    }
+    fclose(file);
+
+    char header[256];
+    const int header_len = snprintf(header, sizeof(header),
+                                    "HTTP/1.0 %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n"
+                                    "Connection: close\r\n\r\n", status, METRICS_CONTENT_TYPE, body_len);
+    send(fd, header, (size_t) header_len, MSG_NOSIGNAL);
+    for (size_t sent = 0; !head && sent < body_len;) {
+        const ssize_t n = send(fd, body + sent, body_len - sent, MSG_NOSIGNAL);
+        if (n <= 0)
+            break;
+        sent += (size_t) n;
+    }
+    free(body);
+}
+
+/// \brief The exporter thread.  Answers one scrape at a time; Prometheus only ever sends one.
+/// \param arg The struct metrics
+/// \return Always NULL
+static void *metrics_thread(void *arg) {
+    struct metrics *metrics = arg;
+    struct pollfd pfd = {.fd = metrics->listen_fd, .events = POLLIN};
+
+    while (atomic_load_explicit(&metrics->running, memory_order_relaxed)) {
+        if (poll(&pfd, 1, METRICS_POLL_MS) <= 0)
+            continue;
+
+        const int fd = accept(metrics->listen_fd, NULL, NULL);
+        if (fd < 0)
+            continue;
+        metrics_answer(metrics, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+/// \brief Open a listening Unix socket, replacing a stale one left behind by an earlier run.
+/// \param path The socket path
+/// \return The socket, otherwise a negative value with errno set
+static int metrics_listen_unix(const char *path) {
+    struct sockaddr_un sun = {.sun_family = AF_UNIX};
+    if (strlen(path) >= sizeof(sun.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(sun.sun_path, path);
+
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (bind(fd, (struct sockaddr *) &sun, sizeof(sun)) != 0) {
+        const int err = errno;
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+/// \brief Open a listening TCP socket.
+/// \param address A port or host:port
+/// \return The socket, otherwise a negative value with errno set
+static int metrics_listen_tcp(const char *address) {
+    char host[64] = "127.0.0.1";
+    const char *port = address;
+    const char *colon = strrchr(address, ':');
+    if (colon != NULL) {
+        const size_t host_len = (size_t) (colon - address);
+        if (host_len >= sizeof(host)) {
+            errno = ENAMETOOLONG;
+            return -1;
+        }
+        memcpy(host, address, host_len);
+        host[host_len] = '\0';
+        port = colon + 1;
+    }
+
+    const struct addrinfo hints = {
+        .ai_family = AF_INET,
+        .ai_socktype = SOCK_STREAM,
+        .ai_flags = AI_PASSIVE
+    };
+    struct addrinfo *addrlist;
+    if (getaddrinfo(host, port, &hints, &addrlist) != 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    const int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        freeaddrinfo(addrlist);
+        return -1;
+    }
+    const int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    const int ret = bind(fd, addrlist->ai_addr, addrlist->ai_addrlen);
+    const int err = errno;
+    freeaddrinfo(addrlist);
+    if (ret != 0) {
+        close(fd);
+        errno = err;
+        return -1;
+    }
+    return fd;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+int metrics_init(struct metrics *metrics) {
+    memset(metrics, 0, sizeof(*metrics));
+    metrics->listen_fd = -1;
+    metrics->overflow.owner = metrics;
+    metrics->overflow.shared = true;
+    metrics->overflow.in_use = true;
+
+    int ret = pthread_mutex_init(&metrics->lock, NULL);
+    if (ret != 0) {
+        errno = ret;
+        return -1;
+    }
+    ret = pthread_key_create(&metrics->key, metrics_retire_shard);
+    if (ret != 0) {
+        pthread_mutex_destroy(&metrics->lock);
+        errno = ret;
+        return -1;
+    }
+    return 0;
+}
+
+int metrics_serve(struct metrics *metrics, const char *address) {
+    const bool unix_socket = strchr(address, '/') != NULL;
+    metrics->listen_fd = unix_socket ? metrics_listen_unix(address) : metrics_listen_tcp(address);
+    if (metrics->listen_fd < 0)
+        return -1;
+
+    if (listen(metrics->listen_fd, 4) != 0) {
+        const int err = errno;
+        close(metrics->listen_fd);
+        metrics->listen_fd = -1;
+        errno = err;
+        return -1;
+    }
+    snprintf(metrics->address, sizeof(metrics->address), "%s", address);
+
+    atomic_store_explicit(&metrics->running, true, memory_order_relaxed);
+    const int ret = pthread_create(&metrics->thread, NULL, metrics_thread, metrics);
+    if (ret != 0) {
+        close(metrics->listen_fd);
+        metrics->listen_fd = -1;
+        errno = ret;
+        return -1;
+    }
+    metrics->thread_started = true;
+    return 0;
+}
+
+void metrics_destroy(struct metrics *metrics) {
+    if (metrics->thread_started) {
+        atomic_store_explicit(&metrics->running, false, memory_order_relaxed);
+        pthread_join(metrics->thread, NULL);
+        metrics->thread_started = false;
+    }
+    if (metrics->listen_fd >= 0) {
+        close(metrics->listen_fd);
+        metrics->listen_fd = -1;
+        if (strchr(metrics->address, '/') != NULL)
+            unlink(metrics->address);
+    }
+    pthread_key_delete(metrics->key);
+    pthread_mutex_destroy(&metrics->lock);
+}
+
+struct metrics_shard *metrics_claim_shard(struct metrics *metrics) {
+    struct metrics_shard *shard = &metrics->overflow;
+
+    pthread_mutex_lock(&metrics->lock);
+    for (size_t i = 0; i < METRICS_MAX_SHARDS; ++i) {
+        if (!metrics->shards[i].in_use) {
+            shard = &metrics->shards[i];
+            shard->owner = metrics;
+            shard->in_use = true;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&metrics->lock);
+
+    if (!shard->shared)
+        pthread_setspecific(metrics->key, shard);
+    metrics_thread_shard = shard;
+    return shard;
+}
+
+void metrics_write(struct metrics *metrics, FILE *file) {
+    struct metrics_totals totals = {0};
+
+    pthread_mutex_lock(&metrics->lock);
+    metrics_sum(&totals, &metrics->retired);
+    metrics_sum(&totals, &metrics->overflow);
+    for (size_t i = 0; i < METRICS_MAX_SHARDS; ++i) {
+        if (metrics->shards[i].in_use)
+            metrics_sum(&totals, &metrics->shards[i]);
+    }
+    pthread_mutex_unlock(&metrics->lock);
+
+    for (size_t i = 0; i < METRICS_COUNTERS; ++i) {
+        const struct metrics_name *name = &counter_names[i];
+        metrics_write_header(file, counter_names, i, "counter");
+        if (name->labels != NULL) {
+            fprintf(file, "%s{%s} %" PRIu64 "\n", name->family, name->labels, totals.counters[i]);
+        } else {
+            fprintf(file, "%s %" PRIu64 "\n", name->family, totals.counters[i]);
+        }
+    }
+
+    for (size_t h = 0; h < METRICS_HISTOGRAMS; ++h) {
+        const struct metrics_name *name = &histogram_names[h];
+        const char *labels = name->labels != NULL ? name->labels : "";
+        const char *comma = name->labels != NULL ? "," : "";
+        metrics_write_header(file, histogram_names, h, "histogram");
+
+        uint64_t count = 0;
+        for (size_t b = 0; b < METRICS_BUCKETS; ++b) {
+            count += totals.buckets[h][b];
+            fprintf(file, "%s_bucket{%s%sle=\"%.6f\"} %" PRIu64 "\n", name->family, labels, comma,
+                    (double) (1ULL << b) / 1e6, count);
+        }
+        count += totals.buckets[h][METRICS_BUCKETS];
+        fprintf(file, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu64 "\n", name->family, labels, comma, count);
+
+        if (name->labels != NULL) {
+            fprintf(file, "%s_sum{%s} %.9f\n", name->family, labels, (double) totals.sum_ns[h] / 1e9);
+            fprintf(file, "%s_count{%s} %" PRIu64 "\n", name->family, labels, count);
+        } else {
+            fprintf(file, "%s_sum %.9f\n", name->family, (double) totals.sum_ns[h] / 1e9);
+            fprintf(file, "%s_count %" PRIu64 "\n", name->family, count);
+        }
+    }
+}
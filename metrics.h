@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file metrics.h
+/// @brief Runtime counters and histograms, served to Prometheus from a local socket
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_METRICS_H
+#define WAVEFORM_EXAMPLE_METRICS_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most threads that can count at once.  Any more share one extra shard, at the cost of atomic adds.
+#define METRICS_MAX_SHARDS 32
+
+/// \brief The size of a cache line, so that no two threads' counters share one
+#define METRICS_CACHE_LINE 64
+
+/// \brief The number of finite histogram buckets.  Bucket i counts observations of up to 2^i microseconds, so the
+/// largest finite bucket is about 33 seconds; anything longer only goes in +Inf.
+#define METRICS_BUCKETS 26
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The counters.  The names are in metrics.c.
+enum metrics_counter {
+    METRICS_PACKETS_IN_RX,
+    METRICS_PACKETS_IN_TX,
+    METRICS_PACKETS_OUT_SPEAKER,
+    METRICS_PACKETS_OUT_TRANSMITTER,
+    METRICS_SAMPLES_OUT_SPEAKER,
+    METRICS_SAMPLES_OUT_TRANSMITTER,
+    METRICS_BYTE_PACKETS_OUT,
+    METRICS_BYTES_OUT,
+    METRICS_METER_SENDS,
+    METRICS_COUNTERS
+};
+
+/// \brief The histograms, all of durations.  The names are in metrics.c.
+enum metrics_histogram {
+    METRICS_CALLBACK_RX,        ///< Time spent in the receive data callback
+    METRICS_CALLBACK_TX,        ///< Time spent in the transmit data callback
+    METRICS_METER_SEND,         ///< Time spent in waveform_meters_send
+    METRICS_COMMAND_RTT,        ///< Radio command round trips through the API queue
+    METRICS_HISTOGRAMS
+};
+
+/// \brief One histogram's counts.  Bucket counts are not cumulative; that is done when scraped.
+struct metrics_histogram_counts {
+    _Atomic uint64_t buckets[METRICS_BUCKETS + 1];  ///< The last is for anything beyond the finite buckets
+    _Atomic uint64_t sum_ns;
+};
+
+/// \brief One thread's counts.  Only that thread writes them, so an increment is a plain load and store with no lock
+/// prefix and no cache line bouncing between CPUs.  They are atomic only so that a scrape can read them while they
+/// change.
+struct metrics_shard {
+    _Alignas(METRICS_CACHE_LINE) _Atomic uint64_t counters[METRICS_COUNTERS];
+    struct metrics_histogram_counts histograms[METRICS_HISTOGRAMS];
+    struct metrics *owner;
+    bool shared;                ///< The overflow shard, which any number of threads may write with atomic adds
+    bool in_use;
+};
+
+/// \brief The counts and the exporter.
+///
+/// Each thread that counts something is handed a shard of its own the first time it does.  When the thread exits its
+/// counts are folded into the retired totals and the shard is handed out again, which matters because the library
+/// starts new threads on every reconnect.  Nothing is added up until somebody scrapes, so counting costs the data path
+/// a thread-local load, a compare and the add itself.
+struct metrics {
+    struct metrics_shard shards[METRICS_MAX_SHARDS];
+    struct metrics_shard overflow;
+    struct metrics_shard retired;
+    pthread_mutex_t lock;       ///< Held to hand out, retire and add up shards
+    pthread_key_t key;          ///< Its destructor retires a thread's shard
+
+    int listen_fd;
+    pthread_t thread;
+    bool thread_started;
+    _Atomic bool running;
+    char address[108];          ///< What we are listening on, for the log
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief The calling thread's shard, or NULL if it has none yet.  Use metrics_shard instead.
+extern __thread struct metrics_shard *metrics_thread_shard;
+
+/// \brief Initialize the counts.  Nothing is served until metrics_serve.
+/// \param metrics The metrics to initialize
+/// \return 0 for success otherwise a negative value with errno set
+int metrics_init(struct metrics *metrics);
+
+/// \brief Start serving the metrics to HTTP GET requests on a thread of our own.  Nothing is read from the request;
+/// any path gets the whole exposition in the Prometheus text format.
+/// \param metrics The metrics
+/// \param address A Unix socket path if it contains a '/', otherwise a TCP port or host:port.  TCP binds to
+///                127.0.0.1 unless a host is given.
+/// \return 0 for success otherwise a negative value with errno set
+int metrics_serve(struct metrics *metrics, const char *address);
+
+/// \brief Stop serving and release everything.  Threads that counted must have exited or stopped counting.
+/// \param metrics The metrics
+void metrics_destroy(struct metrics *metrics);
+
+/// \brief Hand the calling thread a shard.  Called by metrics_shard the first time a thread counts something.
+/// \param metrics The metrics
+/// \return The thread's shard
+struct metrics_shard *metrics_claim_shard(struct metrics *metrics);
+
+/// \brief Find the calling thread's shard.
+/// \param metrics The metrics
+/// \return The thread's shard
+static inline struct metrics_shard *metrics_shard(struct metrics *metrics) {
+    struct metrics_shard *shard = metrics_thread_shard;
+    if (__builtin_expect(shard == NULL || shard->owner != metrics, 0))
+        shard = metrics_claim_shard(metrics);
+    return shard;
+}
+
+/// \brief Add to a value in a shard.
+/// \param shard The shard the value is in
+/// \param value The value
+/// \param n How much to add
+static inline void metrics_shard_add(const struct metrics_shard *shard, _Atomic uint64_t *value, const uint64_t n) {
+    if (__builtin_expect(shard->shared, 0)) {
+        atomic_fetch_add_explicit(value, n, memory_order_relaxed);
+    } else {
+        atomic_store_explicit(value, atomic_load_explicit(value, memory_order_relaxed) + n, memory_order_relaxed);
+    }
+}
+
+/// \brief Count something.  This never blocks except the first time a thread counts, when it takes a lock.
+/// \param metrics The metrics, or NULL to do nothing
+/// \param counter What to count
+/// \param n How many
+static inline void metrics_add(struct metrics *metrics, const enum metrics_counter counter, const uint64_t n) {
+    if (metrics == NULL)
+        return;
+
+    struct metrics_shard *shard = metrics_shard(metrics);
+    metrics_shard_add(shard, &shard->counters[counter], n);
+}
+
+/// \brief Record a duration in a histogram.
+/// \param metrics The metrics, or NULL to do nothing
+/// \param histogram Which histogram
+/// \param ns The duration in nanoseconds
+static inline void metrics_observe(struct metrics *metrics, const enum metrics_histogram histogram, const int64_t ns) {
+    if (metrics == NULL || ns < 0)
+        return;
+
+    const uint64_t us = ((uint64_t) ns + 999) / 1000;
+    unsigned int bucket = us <= 1 ? 0 : 64 - __builtin_clzll(us - 1);
+    if (bucket > METRICS_BUCKETS)
+        bucket = METRICS_BUCKETS;
+
+    struct metrics_shard *shard = metrics_shard(metrics);
+    metrics_shard_add(shard, &shard->histograms[histogram].buckets[bucket], 1);
+    metrics_shard_add(shard, &shard->histograms[histogram].sum_ns, (uint64_t) ns);
+}
+
+/// \brief Write the metrics in the Prometheus text exposition format.
+/// \param metrics The metrics
+/// \param file Where to write
+void metrics_write(struct metrics *metrics, FILE *file);
+
+#endif // WAVEFORM_EXAMPLE_METRICS_H
@@ -0,0 +1,209 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef WAVEFORM_SDK_WAVEFORM_API_H
+#define WAVEFORM_SDK_WAVEFORM_API_H
+
+#include <netinet/in.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+struct waveform_t;
+struct waveform_meter_t;
+struct waveform_meter_list_t;
+struct radio_t;
+struct waveform_args_t;
+struct waveform_vita_packet;
+
+enum waveform_units
+{
+   DB,
+   DBM,
+   DBFS,
+   VOLTS,
+   AMPS,
+   RPM,
+   TEMP_F,
+   TEMP_C,
+   SWR,
+   WATTS,
+   PERCENT,
+   NONE
+};
+
+enum waveform_state
+{
+   ACTIVE,
+   INACTIVE,
+   PTT_REQUESTED,
+   UNKEY_REQUESTED
+};
+
+enum waveform_packet_type
+{
+   SPEAKER_DATA,
+   TRANSMITTER_DATA,
+};
+
+enum waveform_log_levels
+{
+   WF_LOG_TRACE = 100,
+   WF_LOG_DEBUG = 200,
+   WF_LOG_INFO = 300,
+   WF_LOG_WARNING = 400,
+   WF_LOG_ERROR = 500,
+   WF_LOG_SEVERE = 600,
+   WF_LOG_FATAL = 700
+};
+
+struct waveform_meter_entry {
+   char* name;
+   float min;
+   float max;
+   enum waveform_units unit;
+};
+
+enum waveform_sample_rate
+{
+   SR_3K = 0x00,
+   SR_6K = 0x01,
+   SR_12K = 0x02,
+   SR_24K = 0x03,
+   SR_48K = 0x04,
+   SR_96K = 0x05,
+   SR_192K = 0x06,
+   SR_384K = 0x07,
+   SR_768K = 0x08,
+   SR_1568K = 0x09,
+   SR_3072K = 0x0A,
+   SR_6144K = 0x0B,
+   SR_12288K = 0x0C,
+   SR_24576K = 0x0D,
+   SR_49152K = 0x0E,
+   SR_98304K = 0x0F,
+   SR_4K = 0x10,
+   SR_8K = 0x11,
+   SR_16K = 0x12,
+   SR_32K = 0x13,
+   SR_64K = 0x14,
+   SR_128K = 0x15,
+   SR_256K = 0x16,
+   SR_512K = 0x17,
+   SR_1024K = 0x18,
+   SR_2048K = 0x19,
+   SR_4096K = 0x1A,
+   SR_8192K = 0x1B,
+   SR_16384K = 0x1C,
+   SR_32768K = 0x1D,
+   SR_65536K = 0x1E,
+   SR_131072K = 0x1F
+};
+
+typedef void (*waveform_state_cb_t)(struct waveform_t *waveform,
+                                    enum waveform_state state, void *arg);
+
+typedef int (*waveform_cmd_cb_t)(struct waveform_t *waveform, unsigned int argc,
+                                 char *argv[], void *arg);
+
+typedef void (*waveform_data_cb_t)(struct waveform_t* waveform, struct waveform_vita_packet* packet,
+                                   size_t packet_size, void* arg);
+
+typedef void (*waveform_response_cb_t)(struct waveform_t* waveform,
+                                       unsigned int code, const char* message,
+                                       void* arg);
+
+struct waveform_t* waveform_create(struct radio_t* radio, const char* name,
+                                   const char* short_name, const char* underlying_mode,
+                                   const char* version, enum waveform_sample_rate data_sample_rate);
+
+void waveform_destroy(struct waveform_t* waveform);
+
+int waveform_register_state_cb(struct waveform_t* waveform,
+                               waveform_state_cb_t cb, void* arg);
+
+int waveform_register_tx_data_cb(struct waveform_t* waveform,
+                                 waveform_data_cb_t cb, void* arg);
+
+int waveform_register_rx_data_cb(struct waveform_t* waveform,
+                                 waveform_data_cb_t cb, void* arg);
+
+int waveform_register_unknown_data_cb(struct waveform_t* waveform, waveform_data_cb_t cb, void* arg);
+
+int waveform_register_byte_data_cb(struct waveform_t* waveform, waveform_data_cb_t cb, void* arg);
+
+int waveform_register_status_cb(struct waveform_t* waveform, const char* status_name,
+                                waveform_cmd_cb_t cb, void* arg);
+
+int waveform_register_command_cb(struct waveform_t* waveform,
+                                 const char* command_name, waveform_cmd_cb_t cb,
+                                 void* arg);
+
+#define waveform_send_api_command(waveform, command, ...)      \
+   waveform_send_api_command_cb(waveform, NULL, NULL, command, \
+                                ##__VA_ARGS__)
+
+int32_t waveform_send_api_command_cb(struct waveform_t* waveform,
+                                     waveform_response_cb_t cb, void* arg,
+                                     const char* command, ...);
+
+#define waveform_send_timed_api_command(waveform, at, command, ...) \
+   waveform_send_timed_api_command_cb(waveform, at, NULL, NULL, NULL, command##__VA_ARGS__)
+
+int32_t waveform_send_timed_api_command_cb(struct waveform_t *waveform, const struct timespec *at,
+                                           waveform_response_cb_t complete_cb, waveform_response_cb_t queued_cb,
+                                           void *arg, const char *command, ...);
+
+void waveform_register_meter(struct waveform_t *waveform, const char *name, float min, float max,
+                             enum waveform_units unit);
+
+int waveform_meter_set_float_value(const struct waveform_t* waveform, char* name, float value);
+
+int waveform_meter_set_int_value(const struct waveform_t* waveform, char* name, short value);
+
+ssize_t waveform_meters_send(struct waveform_t* waveform);
+
+struct radio_t* waveform_radio_create(const struct sockaddr_in* addr);
+
+void waveform_radio_destroy(struct radio_t* radio);
+
+int waveform_radio_wait(const struct radio_t* radio);
+
+int waveform_radio_start(struct radio_t* radio);
+
+ssize_t waveform_send_data_packet(struct waveform_t* waveform, float* samples, size_t num_samples,
+                                  enum waveform_packet_type type);
+
+ssize_t waveform_send_byte_data_packet(struct waveform_t* waveform, const uint8_t* data, size_t data_size);
+
+uint16_t get_packet_len(const struct waveform_vita_packet* packet);
+
+const float* get_packet_data(const struct waveform_vita_packet* packet);
+
+uint32_t get_packet_ts_int(const struct waveform_vita_packet* packet);
+
+uint64_t get_packet_ts_frac(const struct waveform_vita_packet* packet);
+
+void get_packet_ts(const struct waveform_vita_packet* packet, struct timespec* ts);
+
+uint32_t get_stream_id(const struct waveform_vita_packet* packet);
+
+uint64_t get_class_id(const struct waveform_vita_packet* packet);
+
+uint8_t get_packet_count(const struct waveform_vita_packet* packet);
+
+void waveform_set_context(struct waveform_t* wf, void* ctx);
+
+void* waveform_get_context(const struct waveform_t* wf);
+
+void waveform_register_meter_list(struct waveform_t* wf,
+                                  const struct waveform_meter_entry list[],
+                                  int num_meters);
+
+struct sockaddr_in* waveform_discover_radio(const struct timeval* timeout);
+
+void waveform_set_log_level(enum waveform_log_levels level);
+
+const uint8_t* get_packet_byte_data(const struct waveform_vita_packet* packet);
+
+uint32_t get_packet_byte_data_length(const struct waveform_vita_packet* packet);
+
+#endif//WAVEFORM_SDK_WAVEFORM_H
@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file waveform_mock.h
+/// @brief In-memory mock of libwaveform for running a waveform without a radio
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// The mock implements every function in waveform_api.h.  Nothing talks to a network: a "radio" never has anything
+/// to say, commands are answered on the spot with a configurable response, and whatever the waveform sends is counted
+/// and, if asked, kept in memory.  On top of that the functions here let a test or benchmark build packets, drive the
+/// waveform's registered callbacks and look at what came back, all on the calling thread so that every run is the
+/// same.
+
+#ifndef WAVEFORM_SDK_WAVEFORM_MOCK_H
+#define WAVEFORM_SDK_WAVEFORM_MOCK_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A packet.  The library keeps its own opaque; the mock's is just the fields the accessors return, so a test
+/// can fill one in directly.
+struct waveform_vita_packet {
+    uint32_t stream_id;
+    uint64_t class_id;
+    uint32_t ts_int;
+    uint64_t ts_frac;
+    uint8_t packet_count;
+    uint16_t num_samples;
+    uint32_t sample_rate;           ///< Turns ts_frac, a sample count, into nanoseconds for get_packet_ts
+    const float *samples;
+    const uint8_t *byte_data;
+    uint32_t byte_data_length;
+};
+
+/// \brief Everything the waveform has sent of one kind of data
+struct waveform_mock_stream {
+    uint64_t packets;
+    uint64_t samples;               ///< Floats for sample data, bytes for byte data
+    void *data;                     ///< What was sent, if waveform_mock_keep_data is on
+    size_t data_len;                ///< Bytes kept in data
+    size_t data_capacity;
+};
+
+/// \brief A command sent to the radio
+struct waveform_mock_command {
+    char *command;
+    bool timed;
+    struct timespec at;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Fill in a sample packet.
+/// \param packet The packet
+/// \param samples The samples, which must outlive the packet
+/// \param num_samples The number of floats in samples
+/// \param sample_rate The sample rate in Hz, for get_packet_ts
+/// \param sample_count The number of samples, per channel, since the UNIX epoch of the first sample in the packet
+void waveform_mock_packet(struct waveform_vita_packet *packet, const float *samples, uint16_t num_samples,
+                          uint32_t sample_rate, uint64_t sample_count);
+
+/// \brief Call the waveform's registered receive data callback.
+/// \param waveform The waveform
+/// \param packet The packet to deliver
+/// \return 0 for success otherwise a negative value if no callback is registered
+int waveform_mock_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet);
+
+/// \brief Call the waveform's registered transmit data callback.
+/// \param waveform The waveform
+/// \param packet The packet to deliver
+/// \return 0 for success otherwise a negative value if no callback is registered
+int waveform_mock_tx(struct waveform_t *waveform, struct waveform_vita_packet *packet);
+
+/// \brief Call the waveform's registered byte data callback.
+/// \param waveform The waveform
+/// \param packet The packet to deliver
+/// \return 0 for success otherwise a negative value if no callback is registered
+int waveform_mock_byte_data(struct waveform_t *waveform, struct waveform_vita_packet *packet);
+
+/// \brief Call the waveform's registered state callback.
+/// \param waveform The waveform
+/// \param state The new state
+/// \return 0 for success otherwise a negative value if no callback is registered
+int waveform_mock_state(struct waveform_t *waveform, enum waveform_state state);
+
+/// \brief Run a waveform command as if the user had typed "slice N waveform_cmd <line>".
+/// \param waveform The waveform
+/// \param line The command and its arguments, separated by spaces
+/// \return The command callback's return value, or -1 if no callback is registered for the command
+int waveform_mock_command(struct waveform_t *waveform, const char *line);
+
+/// \brief Deliver a status message as if the radio had sent it.
+/// \param waveform The waveform
+/// \param line The status, e.g. "slice 0 RF_frequency=14.074000 mode=DIGU"
+/// \return The status callback's return value, or -1 if no callback is registered for the status
+int waveform_mock_status(struct waveform_t *waveform, const char *line);
+
+/// \brief Set the response given to every command the waveform sends from now on.  The default is 0 and "".
+/// \param waveform The waveform
+/// \param code The response code
+/// \param message The response message, which must outlive the waveform
+void waveform_mock_set_response(struct waveform_t *waveform, unsigned int code, const char *message);
+
+/// \brief Choose whether what the waveform sends is kept in memory or only counted.  Only counting is the default, so
+/// that benchmarks measure the waveform and not the mock.
+/// \param waveform The waveform
+/// \param keep true to keep everything sent from now on
+void waveform_mock_keep_data(struct waveform_t *waveform, bool keep);
+
+/// \brief Look at what the waveform has sent.
+/// \param waveform The waveform
+/// \param type SPEAKER_DATA or TRANSMITTER_DATA
+/// \return The stream
+const struct waveform_mock_stream *waveform_mock_sent(const struct waveform_t *waveform,
+                                                      enum waveform_packet_type type);
+
+/// \brief Look at the byte data the waveform has sent.
+/// \param waveform The waveform
+/// \return The stream
+const struct waveform_mock_stream *waveform_mock_sent_bytes(const struct waveform_t *waveform);
+
+/// \brief Forget everything the waveform has sent, including commands.
+/// \param waveform The waveform
+void waveform_mock_clear(struct waveform_t *waveform);
+
+/// \brief Count the commands the waveform has sent.
+/// \param waveform The waveform
+/// \return The number of commands
+size_t waveform_mock_command_count(struct waveform_t *waveform);
+
+/// \brief Get a command the waveform has sent.
+/// \param waveform The waveform
+/// \param index The command, counting from 0 in the order they were sent
+/// \param command Receives the command, whose string stays valid until waveform_mock_clear or waveform_destroy
+/// \return 0 for success otherwise a negative value if there is no such command
+int waveform_mock_get_command(struct waveform_t *waveform, size_t index, struct waveform_mock_command *command);
+
+/// \brief Get the value last set for a meter.
+/// \param waveform The waveform
+/// \param name The meter name
+/// \param value Receives the value
+/// \return 0 for success otherwise a negative value if the meter is not registered
+int waveform_mock_meter_value(const struct waveform_t *waveform, const char *name, float *value);
+
+/// \brief Count the calls to waveform_meters_send.
+/// \param waveform The waveform
+/// \return The number of calls
+uint64_t waveform_mock_meters_sent(const struct waveform_t *waveform);
+
+#endif // WAVEFORM_SDK_WAVEFORM_MOCK_H
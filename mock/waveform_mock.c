@@ -0,0 +1,590 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file waveform_mock.c
+/// @brief In-memory mock of libwaveform for running a waveform without a radio
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include <waveform/waveform_mock.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most callbacks of each kind, and the most meters, a waveform may register
+#define MOCK_MAX_CALLBACKS 32
+
+/// \brief The most arguments waveform_mock_command and waveform_mock_status split a line into
+#define MOCK_MAX_ARGS 32
+
+/// \brief The longest command the waveform may send, including its terminator
+#define MOCK_COMMAND_LEN 1024
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+struct mock_data_cb {
+    waveform_data_cb_t cb;
+    void *arg;
+};
+
+struct mock_named_cb {
+    char *name;
+    waveform_cmd_cb_t cb;
+    void *arg;
+};
+
+struct mock_meter {
+    char *name;
+    float min;
+    float max;
+    enum waveform_units unit;
+    float value;
+};
+
+struct waveform_t {
+    void *ctx;
+    struct radio_t *radio;
+    char *name;
+    char *short_name;
+    char *underlying_mode;
+    char *version;
+    enum waveform_sample_rate sample_rate;
+
+    struct {
+        waveform_state_cb_t cb;
+        void *arg;
+    } state_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_state_cbs;
+    struct mock_data_cb rx_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_rx_cbs;
+    struct mock_data_cb tx_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_tx_cbs;
+    struct mock_data_cb unknown_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_unknown_cbs;
+    struct mock_data_cb byte_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_byte_cbs;
+    struct mock_named_cb status_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_status_cbs;
+    struct mock_named_cb command_cbs[MOCK_MAX_CALLBACKS];
+    size_t num_command_cbs;
+
+    struct mock_meter meters[MOCK_MAX_CALLBACKS];
+    size_t num_meters;
+    uint64_t meters_sent;
+
+    bool keep_data;
+    struct waveform_mock_stream sent[2];
+    struct waveform_mock_stream sent_bytes;
+
+    // Commands come from whichever thread the waveform likes, so the log and the response are under a lock.
+    pthread_mutex_t lock;
+    struct waveform_mock_command *commands;
+    size_t num_commands;
+    size_t commands_capacity;
+    unsigned int response_code;
+    const char *response_message;
+};
+
+struct radio_t {
+    struct sockaddr_in addr;
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+static char *mock_strdup(const char *s) {
+    if (s == NULL)
+        return NULL;
+    return strdup(s);
+}
+
+static void mock_stream_append(struct waveform_mock_stream *stream, const void *data, const size_t len) {
+    if (stream->data_len + len > stream->data_capacity) {
+        size_t capacity = stream->data_capacity ? stream->data_capacity : 4096;
+        while (capacity < stream->data_len + len)
+            capacity *= 2;
+        void *grown = realloc(stream->data, capacity);
+        if (grown == NULL) {
+            fprintf(stderr, "waveform mock: out of memory keeping %zu bytes of sent data\n", len);
+            return;
+        }
+        stream->data = grown;
+        stream->data_capacity = capacity;
+    }
+    memcpy((char *) stream->data + stream->data_len, data, len);
+    stream->data_len += len;
+}
+
+static void mock_stream_free(struct waveform_mock_stream *stream) {
+    free(stream->data);
+    memset(stream, 0, sizeof(*stream));
+}
+
+static struct mock_meter *mock_find_meter(const struct waveform_t *waveform, const char *name) {
+    for (size_t i = 0; i < waveform->num_meters; ++i) {
+        if (strcmp(waveform->meters[i].name, name) == 0)
+            return (struct mock_meter *) &waveform->meters[i];
+    }
+    return NULL;
+}
+
+static int mock_register_data_cb(struct mock_data_cb *cbs, size_t *count, const waveform_data_cb_t cb, void *arg) {
+    if (*count == MOCK_MAX_CALLBACKS)
+        return -1;
+    cbs[*count].cb = cb;
+    cbs[*count].arg = arg;
+    ++*count;
+    return 0;
+}
+
+static int mock_register_named_cb(struct mock_named_cb *cbs, size_t *count, const char *name,
+                                  const waveform_cmd_cb_t cb, void *arg) {
+    if (*count == MOCK_MAX_CALLBACKS)
+        return -1;
+    cbs[*count].name = mock_strdup(name);
+    if (cbs[*count].name == NULL)
+        return -1;
+    cbs[*count].cb = cb;
+    cbs[*count].arg = arg;
+    ++*count;
+    return 0;
+}
+
+static int mock_deliver(struct waveform_t *waveform, const struct mock_data_cb *cbs, const size_t count,
+                        struct waveform_vita_packet *packet) {
+    if (count == 0)
+        return -1;
+    for (size_t i = 0; i < count; ++i)
+        cbs[i].cb(waveform, packet, sizeof(*packet), cbs[i].arg);
+    return 0;
+}
+
+/// \brief Split a line on spaces in place and call every callback registered under its first word, the way the
+/// library does for a command or a status.
+static int mock_dispatch(struct waveform_t *waveform, const struct mock_named_cb *cbs, const size_t count,
+                         const char *line) {
+    char *copy = strdup(line);
+    if (copy == NULL)
+        return -1;
+
+    char *argv[MOCK_MAX_ARGS];
+    unsigned int argc = 0;
+    char *save = NULL;
+    for (char *token = strtok_r(copy, " ", &save); token != NULL && argc < MOCK_MAX_ARGS;
+         token = strtok_r(NULL, " ", &save))
+        argv[argc++] = token;
+
+    int ret = -1;
+    for (size_t i = 0; argc > 0 && i < count; ++i) {
+        if (strcmp(cbs[i].name, argv[0]) == 0)
+            ret = cbs[i].cb(waveform, argc, argv, cbs[i].arg);
+    }
+
+    free(copy);
+    return ret;
+}
+
+/// \brief Log a command and give it its response.  Returns the sequence number the library would have used.
+static int32_t mock_send_command(struct waveform_t *waveform, const struct timespec *at,
+                                 const waveform_response_cb_t complete_cb, const waveform_response_cb_t queued_cb,
+                                 void *arg, const char *command, va_list ap) {
+    char buffer[MOCK_COMMAND_LEN];
+    const int len = vsnprintf(buffer, sizeof(buffer), command, ap);
+    if (len < 0 || (size_t) len >= sizeof(buffer))
+        return -1;
+
+    pthread_mutex_lock(&waveform->lock);
+    if (waveform->num_commands == waveform->commands_capacity) {
+        const size_t capacity = waveform->commands_capacity ? waveform->commands_capacity * 2 : 64;
+        struct waveform_mock_command *grown = realloc(waveform->commands, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            pthread_mutex_unlock(&waveform->lock);
+            return -1;
+        }
+        waveform->commands = grown;
+        waveform->commands_capacity = capacity;
+    }
+    struct waveform_mock_command *entry = &waveform->commands[waveform->num_commands];
+    entry->command = strdup(buffer);
+    if (entry->command == NULL) {
+        pthread_mutex_unlock(&waveform->lock);
+        return -1;
+    }
+    entry->timed = at != NULL;
+    entry->at = at != NULL ? *at : (struct timespec) {0};
+    const int32_t sequence = (int32_t) waveform->num_commands++;
+    const unsigned int code = waveform->response_code;
+    const char *message = waveform->response_message;
+    pthread_mutex_unlock(&waveform->lock);
+
+    // The radio would answer later on another thread; answering here, with no lock held, keeps runs repeatable and
+    // still lets a callback send another command.
+    if (queued_cb != NULL)
+        queued_cb(waveform, code, message, arg);
+    if (complete_cb != NULL)
+        complete_cb(waveform, code, message, arg);
+
+    return sequence;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+struct waveform_t *waveform_create(struct radio_t *radio, const char *name, const char *short_name,
+                                   const char *underlying_mode, const char *version,
+                                   const enum waveform_sample_rate data_sample_rate) {
+    struct waveform_t *waveform = calloc(1, sizeof(*waveform));
+    if (waveform == NULL)
+        return NULL;
+
+    waveform->radio = radio;
+    waveform->name = mock_strdup(name);
+    waveform->short_name = mock_strdup(short_name);
+    waveform->underlying_mode = mock_strdup(underlying_mode);
+    waveform->version = mock_strdup(version);
+    waveform->sample_rate = data_sample_rate;
+    waveform->response_message = "";
+    pthread_mutex_init(&waveform->lock, NULL);
+    return waveform;
+}
+
+void waveform_destroy(struct waveform_t *waveform) {
+    if (waveform == NULL)
+        return;
+
+    waveform_mock_clear(waveform);
+    free(waveform->commands);
+    for (size_t i = 0; i < waveform->num_status_cbs; ++i)
+        free(waveform->status_cbs[i].name);
+    for (size_t i = 0; i < waveform->num_command_cbs; ++i)
+        free(waveform->command_cbs[i].name);
+    for (size_t i = 0; i < waveform->num_meters; ++i)
+        free(waveform->meters[i].name);
+    free(waveform->name);
+    free(waveform->short_name);
+    free(waveform->underlying_mode);
+    free(waveform->version);
+    pthread_mutex_destroy(&waveform->lock);
+    free(waveform);
+}
+
+int waveform_register_state_cb(struct waveform_t *waveform, waveform_state_cb_t cb, void *arg) {
+    if (waveform->num_state_cbs == MOCK_MAX_CALLBACKS)
+        return -1;
+    waveform->state_cbs[waveform->num_state_cbs].cb = cb;
+    waveform->state_cbs[waveform->num_state_cbs].arg = arg;
+    ++waveform->num_state_cbs;
+    return 0;
+}
+
+int waveform_register_tx_data_cb(struct waveform_t *waveform, waveform_data_cb_t cb, void *arg) {
+    return mock_register_data_cb(waveform->tx_cbs, &waveform->num_tx_cbs, cb, arg);
+}
+
+int waveform_register_rx_data_cb(struct waveform_t *waveform, waveform_data_cb_t cb, void *arg) {
+    return mock_register_data_cb(waveform->rx_cbs, &waveform->num_rx_cbs, cb, arg);
+}
+
+int waveform_register_unknown_data_cb(struct waveform_t *waveform, waveform_data_cb_t cb, void *arg) {
+    return mock_register_data_cb(waveform->unknown_cbs, &waveform->num_unknown_cbs, cb, arg);
+}
+
+int waveform_register_byte_data_cb(struct waveform_t *waveform, waveform_data_cb_t cb, void *arg) {
+    return mock_register_data_cb(waveform->byte_cbs, &waveform->num_byte_cbs, cb, arg);
+}
+
+int waveform_register_status_cb(struct waveform_t *waveform, const char *status_name, waveform_cmd_cb_t cb,
+                                void *arg) {
+    return mock_register_named_cb(waveform->status_cbs, &waveform->num_status_cbs, status_name, cb, arg);
+}
+
+int waveform_register_command_cb(struct waveform_t *waveform, const char *command_name, waveform_cmd_cb_t cb,
+                                 void *arg) {
+    return mock_register_named_cb(waveform->command_cbs, &waveform->num_command_cbs, command_name, cb, arg);
+}
+
+int32_t waveform_send_api_command_cb(struct waveform_t *waveform, waveform_response_cb_t cb, void *arg,
+                                     const char *command, ...) {
+    va_list ap;
+    va_start(ap, command);
+    const int32_t ret = mock_send_command(waveform, NULL, cb, NULL, arg, command, ap);
+    va_end(ap);
+    return ret;
+}
+
+int32_t waveform_send_timed_api_command_cb(struct waveform_t *waveform, const struct timespec *at,
+                                           waveform_response_cb_t complete_cb, waveform_response_cb_t queued_cb,
+                                           void *arg, const char *command, ...) {
+    va_list ap;
+    va_start(ap, command);
+    const int32_t ret = mock_send_command(waveform, at, complete_cb, queued_cb, arg, command, ap);
+    va_end(ap);
+    return ret;
+}
+
+void waveform_register_meter(struct waveform_t *waveform, const char *name, const float min, const float max,
+                             const enum waveform_units unit) {
+    if (waveform->num_meters == MOCK_MAX_CALLBACKS || mock_find_meter(waveform, name) != NULL)
+        return;
+
+    struct mock_meter *meter = &waveform->meters[waveform->num_meters];
+    meter->name = mock_strdup(name);
+    if (meter->name == NULL)
+        return;
+    meter->min = min;
+    meter->max = max;
+    meter->unit = unit;
+    meter->value = min;
+    ++waveform->num_meters;
+}
+
+int waveform_meter_set_float_value(const struct waveform_t *waveform, char *name, const float value) {
+    struct mock_meter *meter = mock_find_meter(waveform, name);
+    if (meter == NULL)
+        return -1;
+    meter->value = value;
+    return 0;
+}
+
+int waveform_meter_set_int_value(const struct waveform_t *waveform, char *name, const short value) {
+    return waveform_meter_set_float_value(waveform, name, (float) value);
+}
+
+ssize_t waveform_meters_send(struct waveform_t *waveform) {
+    ++waveform->meters_sent;
+    return 0;
+}
+
+struct radio_t *waveform_radio_create(const struct sockaddr_in *addr) {
+    struct radio_t *radio = calloc(1, sizeof(*radio));
+    if (radio != NULL && addr != NULL)
+        radio->addr = *addr;
+    return radio;
+}
+
+void waveform_radio_destroy(struct radio_t *radio) {
+    free(radio);
+}
+
+int waveform_radio_wait(const struct radio_t *radio __attribute__((unused))) {
+    return 0;
+}
+
+int waveform_radio_start(struct radio_t *radio __attribute__((unused))) {
+    return 0;
+}
+
+ssize_t waveform_send_data_packet(struct waveform_t *waveform, float *samples, const size_t num_samples,
+                                  const enum waveform_packet_type type) {
+    struct waveform_mock_stream *stream = &waveform->sent[type == SPEAKER_DATA ? 0 : 1];
+    ++stream->packets;
+    stream->samples += num_samples;
+    if (waveform->keep_data)
+        mock_stream_append(stream, samples, num_samples * sizeof(float));
+    return (ssize_t) (num_samples * sizeof(float));
+}
+
+ssize_t waveform_send_byte_data_packet(struct waveform_t *waveform, const uint8_t *data, const size_t data_size) {
+    ++waveform->sent_bytes.packets;
+    waveform->sent_bytes.samples += data_size;
+    if (waveform->keep_data)
+        mock_stream_append(&waveform->sent_bytes, data, data_size);
+    return (ssize_t) data_size;
+}
+
+uint16_t get_packet_len(const struct waveform_vita_packet *packet) {
+    return packet->num_samples;
+}
+
+const float *get_packet_data(const struct waveform_vita_packet *packet) {
+    return packet->samples;
+}
+
+uint32_t get_packet_ts_int(const struct waveform_vita_packet *packet) {
+    return packet->ts_int;
+}
+
+uint64_t get_packet_ts_frac(const struct waveform_vita_packet *packet) {
+    return packet->ts_frac;
+}
+
+void get_packet_ts(const struct waveform_vita_packet *packet, struct timespec *ts) {
+    ts->tv_sec = packet->ts_int;
+    ts->tv_nsec = packet->sample_rate == 0 ? 0
+                  : (long) ((packet->ts_frac % packet->sample_rate) * 1000000000ULL / packet->sample_rate);
+}
+
+uint32_t get_stream_id(const struct waveform_vita_packet *packet) {
+    return packet->stream_id;
+}
+
+uint64_t get_class_id(const struct waveform_vita_packet *packet) {
+    return packet->class_id;
+}
+
+uint8_t get_packet_count(const struct waveform_vita_packet *packet) {
+    return packet->packet_count;
+}
+
+const uint8_t *get_packet_byte_data(const struct waveform_vita_packet *packet) {
+    return packet->byte_data;
+}
+
+uint32_t get_packet_byte_data_length(const struct waveform_vita_packet *packet) {
+    return packet->byte_data_length;
+}
+
+void waveform_set_context(struct waveform_t *wf, void *ctx) {
+    wf->ctx = ctx;
+}
+
+void *waveform_get_context(const struct waveform_t *wf) {
+    return wf->ctx;
+}
+
+void waveform_register_meter_list(struct waveform_t *wf, const struct waveform_meter_entry list[],
+                                  const int num_meters) {
+    for (int i = 0; i < num_meters; ++i)
+        waveform_register_meter(wf, list[i].name, list[i].min, list[i].max, list[i].unit);
+}
+
+struct sockaddr_in *waveform_discover_radio(const struct timeval *timeout __attribute__((unused))) {
+    return NULL;
+}
+
+void waveform_set_log_level(const enum waveform_log_levels level __attribute__((unused))) {
+}
+
+void waveform_mock_packet(struct waveform_vita_packet *packet, const float *samples, const uint16_t num_samples,
+                          const uint32_t sample_rate, const uint64_t sample_count) {
+    static uint8_t packet_count;
+
+    memset(packet, 0, sizeof(*packet));
+    packet->stream_id = 0x04000008;
+    packet->class_id = 0x00001c2d534c03e3ULL;
+    packet->packet_count = packet_count++ & 0x0f;
+    packet->num_samples = num_samples;
+    packet->sample_rate = sample_rate;
+    packet->samples = samples;
+    if (sample_rate != 0) {
+        packet->ts_int = (uint32_t) (sample_count / sample_rate);
+        packet->ts_frac = sample_count % sample_rate;
+    }
+}
+
+int waveform_mock_rx(struct waveform_t *waveform, struct waveform_vita_packet *packet) {
+    return mock_deliver(waveform, waveform->rx_cbs, waveform->num_rx_cbs, packet);
+}
+
+int waveform_mock_tx(struct waveform_t *waveform, struct waveform_vita_packet *packet) {
+    return mock_deliver(waveform, waveform->tx_cbs, waveform->num_tx_cbs, packet);
+}
+
+int waveform_mock_byte_data(struct waveform_t *waveform, struct waveform_vita_packet *packet) {
+    return mock_deliver(waveform, waveform->byte_cbs, waveform->num_byte_cbs, packet);
+}
+
+int waveform_mock_state(struct waveform_t *waveform, const enum waveform_state state) {
+    if (waveform->num_state_cbs == 0)
+        return -1;
+    for (size_t i = 0; i < waveform->num_state_cbs; ++i)
+        waveform->state_cbs[i].cb(waveform, state, waveform->state_cbs[i].arg);
+    return 0;
+}
+
+int waveform_mock_command(struct waveform_t *waveform, const char *line) {
+    return mock_dispatch(waveform, waveform->command_cbs, waveform->num_command_cbs, line);
+}
+
+int waveform_mock_status(struct waveform_t *waveform, const char *line) {
+    return mock_dispatch(waveform, waveform->status_cbs, waveform->num_status_cbs, line);
+}
+
+void waveform_mock_set_response(struct waveform_t *waveform, const unsigned int code, const char *message) {
+    pthread_mutex_lock(&waveform->lock);
+    waveform->response_code = code;
+    waveform->response_message = message != NULL ? message : "";
+    pthread_mutex_unlock(&waveform->lock);
+}
+
+void waveform_mock_keep_data(struct waveform_t *waveform, const bool keep) {
+    waveform->keep_data = keep;
+}
+
+const struct waveform_mock_stream *waveform_mock_sent(const struct waveform_t *waveform,
+                                                      const enum waveform_packet_type type) {
+    return &waveform->sent[type == SPEAKER_DATA ? 0 : 1];
+}
+
+const struct waveform_mock_stream *waveform_mock_sent_bytes(const struct waveform_t *waveform) {
+    return &waveform->sent_bytes;
+}
+
+void waveform_mock_clear(struct waveform_t *waveform) {
+    mock_stream_free(&waveform->sent[0]);
+    mock_stream_free(&waveform->sent[1]);
+    mock_stream_free(&waveform->sent_bytes);
+    waveform->meters_sent = 0;
+
+    pthread_mutex_lock(&waveform->lock);
+    for (size_t i = 0; i < waveform->num_commands; ++i)
+        free(waveform->commands[i].command);
+    waveform->num_commands = 0;
+    pthread_mutex_unlock(&waveform->lock);
+}
+
+size_t waveform_mock_command_count(struct waveform_t *waveform) {
+    pthread_mutex_lock(&waveform->lock);
+    const size_t count = waveform->num_commands;
+    pthread_mutex_unlock(&waveform->lock);
+    return count;
+}
+
+int waveform_mock_get_command(struct waveform_t *waveform, const size_t index, struct waveform_mock_command *command) {
+    int ret = -1;
+    pthread_mutex_lock(&waveform->lock);
+    if (index < waveform->num_commands) {
+        *command = waveform->commands[index];
+        ret = 0;
+    }
+    pthread_mutex_unlock(&waveform->lock);
+    return ret;
+}
+
+int waveform_mock_meter_value(const struct waveform_t *waveform, const char *name, float *value) {
+    const struct mock_meter *meter = mock_find_meter(waveform, name);
+    if (meter == NULL)
+        return -1;
+    *value = meter->value;
+    return 0;
+}
+
+uint64_t waveform_mock_meters_sent(const struct waveform_t *waveform) {
+    return waveform->meters_sent;
+}
@@ -0,0 +1,693 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file ofdm.c
+/// @brief OFDM modem for audio modes: bursts of QPSK symbols with Schmidl-Cox synchronization
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "ofdm.h"
+#include "tables.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// The cyclic prefix is this fraction of the FFT size: 1.3ms at 24kHz, longer than most HF multipath
+#define OFDM_CP_DIVISOR 8
+
+// The moving sums in front of the correlation are this fraction of the FFT size long
+#define OFDM_FILTER_DIVISOR 32
+
+// The received samples are kept for this many symbols, enough for a training symbol to still be there once the end of
+// the correlation plateau has been seen, and for a packet to arrive before the symbols in it are decoded
+#define OFDM_RING_SYMBOLS 4
+
+// The correlation between the halves, over the energy, that counts as a training symbol.  A clean one is nearly 1.
+#define OFDM_SYNC_THRESHOLD 0.75F
+
+// The share of the correlation's peak that counts as its top
+#define OFDM_PEAK_FRACTION 0.95F
+
+// How closely the two training symbols must match what we send before we believe them
+#define OFDM_TRAINING_THRESHOLD 0.6F
+
+// The quietest signal worth synchronizing to, about -80dBFS
+#define OFDM_MIN_LEVEL 1e-4
+
+// The frequency offsets searched beyond what the first training symbol gives, in pairs of subcarriers either way
+#define OFDM_MAX_OFFSET_PAIRS 2
+
+// The RMS level of the transmitted signal at full amplitude.  OFDM peaks well above its RMS, so this leaves room.
+#define OFDM_TX_RMS 0.25F
+
+// The symbols in a burst other than the data: the two training symbols and the silence
+#define OFDM_OVERHEAD_SYMBOLS 3
+
+// The bytes at the start of a burst that give its length
+#define OFDM_HEADER_BYTES 2
+
+// The bits in a data symbol
+#define OFDM_BITS_PER_SYMBOL (OFDM_BYTES_PER_SYMBOL * 8)
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief The next value of the pseudo-random sequence the training symbols are made from, x^9 + x^5 + 1.
+/// \param state The shift register
+/// \return 1 or -1
+static float ofdm_prbs(uint16_t *state) {
+    const unsigned int bit = (*state >> 8 ^ *state >> 4) & 1U;
+    *state = (uint16_t) ((*state << 1 | bit) & 0x1ffU);
+    return bit ? -1.0F : 1.0F;
+}
+
+/// \brief Run the butterflies of an FFT whose input has already been put in bit reversed order.
+/// \param plan The plan
+/// \param buf The data, transformed in place
+/// \param inverse Whether to turn the other way, without scaling
+static void ofdm_fft(const struct ofdm_plan *plan, struct ofdm_complex *buf, const bool inverse) {
+    const unsigned int n = plan->n;
+    const float sign = inverse ? -1.0F : 1.0F;
+
+    for (unsigned int size = 2, stride = n / 2; size <= n; size <<= 1, stride >>= 1) {
+        const unsigned int half = size / 2;
+        for (unsigned int start = 0; start < n; start += size) {
+            for (unsigned int k = 0; k < half; ++k) {
+                const struct ofdm_complex w = plan->twiddle[k * stride];
+                struct ofdm_complex *a = &buf[start + k];
+                struct ofdm_complex *b = &buf[start + k + half];
+                const float re = b->re * w.re - sign * b->im * w.im;
+                const float im = b->im * w.re + sign * b->re * w.im;
+                b->re = a->re - re;
+                b->im = a->im - im;
+                a->re += re;
+                a->im += im;
+            }
+        }
+    }
+}
+
+/// \brief Take the next byte from the queue, if there is one.
+/// \param tx The modulator
+/// \param byte Receives the byte
+/// \return true if there was a byte
+static bool ofdm_dequeue(struct ofdm_modulator *tx, uint8_t *byte) {
+    const size_t head = atomic_load_explicit(&tx->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&tx->tail, memory_order_acquire))
+        return false;
+
+    *byte = tx->queue[head % OFDM_TX_QUEUE];
+    atomic_store_explicit(&tx->head, head + 1, memory_order_release);
+    return true;
+}
+
+/// \brief The next byte of the burst being sent: the header, then the payload from the queue, then padding.
+/// \param tx The modulator
+/// \return The byte
+static uint8_t ofdm_burst_byte(struct ofdm_modulator *tx) {
+    const unsigned int pos = tx->burst_sent++;
+    if (pos == 0)
+        return (uint8_t) tx->burst_len;
+    if (pos == 1)
+        return (uint8_t) ~tx->burst_len;
+
+    uint8_t byte = 0;
+    if (pos - OFDM_HEADER_BYTES < tx->burst_len)
+        ofdm_dequeue(tx, &byte);
+    return byte;
+}
+
+/// \brief Make the next symbol of the burst being sent, starting a new burst if that one is finished.
+/// \param ofdm The modem
+/// \return false if there is nothing to send
+static bool ofdm_next_symbol(struct ofdm *ofdm) {
+    struct ofdm_modulator *tx = &ofdm->tx;
+    const struct ofdm_plan *plan = &ofdm->plan;
+
+    if (tx->symbol_index + 1 >= tx->num_symbols) {
+        const size_t queued = atomic_load_explicit(&tx->tail, memory_order_acquire) -
+                              atomic_load_explicit(&tx->head, memory_order_relaxed);
+        if (queued == 0)
+            return false;
+
+        tx->burst_len = queued < OFDM_MAX_BURST ? (unsigned int) queued : OFDM_MAX_BURST;
+        tx->burst_sent = 0;
+        tx->num_symbols = OFDM_OVERHEAD_SYMBOLS +
+                          (tx->burst_len + OFDM_HEADER_BYTES + OFDM_BYTES_PER_SYMBOL - 1) / OFDM_BYTES_PER_SYMBOL;
+        tx->symbol_index = 0;
+        ++tx->bursts;
+    } else {
+        ++tx->symbol_index;
+    }
+
+    tx->pos = 0;
+    if (tx->symbol_index == tx->num_symbols - 1) {
+        memset(tx->symbol, 0, (plan->n + plan->cp) * sizeof(*tx->symbol));
+        return true;
+    }
+
+    // Put each subcarrier's value in the bin the butterflies want it in; everything else is zero.
+    struct ofdm_complex values[OFDM_CARRIERS];
+    if (tx->symbol_index < 2) {
+        for (size_t i = 0; i < OFDM_CARRIERS; ++i)
+            values[i] = (struct ofdm_complex) {ofdm->training[tx->symbol_index][i], 0.0F};
+    } else {
+        uint8_t bytes[OFDM_BYTES_PER_SYMBOL];
+        for (size_t i = 0; i < OFDM_BYTES_PER_SYMBOL; ++i)
+            bytes[i] = ofdm_burst_byte(tx);
+
+        uint8_t bits[OFDM_BITS_PER_SYMBOL];
+        for (size_t b = 0; b < OFDM_BITS_PER_SYMBOL; ++b)
+            bits[ofdm->interleave[b]] = bytes[b / 8] >> (b % 8) & 1U;
+
+        for (size_t i = 0, d = 0; i < OFDM_CARRIERS; ++i) {
+            if (ofdm->pilot[i]) {
+                values[i] = (struct ofdm_complex) {ofdm->training[1][i], 0.0F};
+            } else {
+                values[i] = (struct ofdm_complex) {
+                    bits[2 * d] ? -(float) M_SQRT1_2 : (float) M_SQRT1_2,
+                    bits[2 * d + 1] ? -(float) M_SQRT1_2 : (float) M_SQRT1_2,
+                };
+                ++d;
+            }
+        }
+    }
+
+    memset(tx->fft, 0, plan->n * sizeof(*tx->fft));
+    for (size_t i = 0; i < OFDM_CARRIERS; ++i)
+        tx->fft[plan->bitrev[(int) ofdm->center + ofdm->carrier[i]]] = values[i];
+    ofdm_fft(plan, tx->fft, true);
+
+    // Only the positive frequencies are filled in, so the real part is the audio signal.
+    const float scale = tx->amplitude * OFDM_TX_RMS / sqrtf(OFDM_CARRIERS / 2.0F);
+    float *symbol = tx->symbol + plan->cp;
+    for (unsigned int m = 0; m < plan->n; ++m)
+        symbol[m] = fminf(fmaxf(scale * tx->fft[m].re, -1.0F), 1.0F);
+    memcpy(tx->symbol, symbol + plan->n - plan->cp, plan->cp * sizeof(*symbol));
+    return true;
+}
+
+/// \brief Transform one FFT window of the received signal with the frequency offset taken out.
+/// \param ofdm The modem
+/// \param start The first sample of the window
+/// \param offset The frequency offset in subcarriers
+static void ofdm_rx_fft(struct ofdm *ofdm, const uint64_t start, const float offset) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const struct ofdm_plan *plan = &ofdm->plan;
+    const unsigned int n = plan->n;
+    const uint64_t mask = (uint64_t) n * OFDM_RING_SYMBOLS - 1;
+
+    // The phase of the correction carries on from the start of the burst so that it is the same rotation throughout.
+    const double step = -2.0 * M_PI * offset / n;
+    const double phase = fmod(step * (double) (start - rx->burst_start), 2.0 * M_PI);
+    float rot_re = (float) cos(phase);
+    float rot_im = (float) sin(phase);
+    const float step_re = (float) cos(step);
+    const float step_im = (float) sin(step);
+
+    for (unsigned int m = 0; m < n; ++m) {
+        const float x = rx->ring[(start + m) & mask];
+        rx->fft[plan->bitrev[m]] = (struct ofdm_complex) {x * rot_re, x * rot_im};
+        const float re = rot_re * step_re - rot_im * step_im;
+        rot_im = rot_re * step_im + rot_im * step_re;
+        rot_re = re;
+    }
+    ofdm_fft(plan, rx->fft, false);
+}
+
+/// \brief Go back to looking for a burst.
+/// \param rx The demodulator
+static void ofdm_rx_search(struct ofdm_demodulator *rx) {
+    rx->state = OFDM_RX_SEARCH;
+    rx->plateau = false;
+}
+
+/// \brief Use both training symbols: find the frequency offset to the nearest subcarrier and set up the equalizer.
+/// \param ofdm The modem
+/// \param start The first sample of the second training symbol's FFT window
+/// \return false if they aren't ours after all
+static bool ofdm_rx_training(struct ofdm *ofdm, const uint64_t start) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    ofdm_rx_fft(ofdm, start, rx->offset);
+
+    // The first training symbol only pins the offset down to within two subcarriers.  Shifted by the rest of it, the
+    // subcarriers of the two symbols line up and differ by exactly what we sent.
+    int best_shift = 0;
+    float best_match = 0.0F;
+    for (int pairs = -OFDM_MAX_OFFSET_PAIRS; pairs <= OFDM_MAX_OFFSET_PAIRS; ++pairs) {
+        float re = 0.0F;
+        float im = 0.0F;
+        float first = 0.0F;
+        float second = 0.0F;
+        for (size_t i = 0; i < OFDM_CARRIERS; ++i) {
+            if (ofdm->training[0][i] == 0.0F)
+                continue;
+
+            const unsigned int bin = (unsigned int) ((int) ofdm->center + ofdm->carrier[i] + 2 * pairs);
+            const struct ofdm_complex a = rx->training[bin];
+            const struct ofdm_complex b = rx->fft[bin];
+            const float sign = ofdm->training[0][i] * ofdm->training[1][i] > 0.0F ? 1.0F : -1.0F;
+            re += sign * (a.re * b.re + a.im * b.im);
+            im += sign * (a.re * b.im - a.im * b.re);
+            first += a.re * a.re + a.im * a.im;
+            second += b.re * b.re + b.im * b.im;
+        }
+
+        const float match = first > 0.0F && second > 0.0F ? sqrtf((re * re + im * im) / (first * second)) : 0.0F;
+        if (match > best_match) {
+            best_match = match;
+            best_shift = 2 * pairs;
+        }
+    }
+
+    if (best_match < OFDM_TRAINING_THRESHOLD)
+        return false;
+
+    rx->offset += (float) best_shift;
+    rx->offset_hz = rx->offset * (float) ofdm->sample_rate / (float) ofdm->plan.n;
+
+    // With all of the offset taken out, each subcarrier of the second symbol is its channel times what we sent.
+    ofdm_rx_fft(ofdm, start, rx->offset);
+    for (size_t i = 0; i < OFDM_CARRIERS; ++i) {
+        const struct ofdm_complex h = rx->fft[(int) ofdm->center + ofdm->carrier[i]];
+        const float power = h.re * h.re + h.im * h.im;
+        const float scale = power > 0.0F ? ofdm->training[1][i] / power : 0.0F;
+        rx->equalizer[i] = (struct ofdm_complex) {scale * h.re, -scale * h.im};
+    }
+    return true;
+}
+
+/// \brief Decode a data symbol.
+/// \param ofdm The modem
+/// \param start The first sample of its FFT window
+/// \param bytes Receives the bytes
+static void ofdm_rx_data(struct ofdm *ofdm, const uint64_t start, uint8_t bytes[OFDM_BYTES_PER_SYMBOL]) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    ofdm_rx_fft(ofdm, start, rx->offset);
+
+    struct ofdm_complex values[OFDM_CARRIERS];
+    float pilot_re = 0.0F;
+    float pilot_im = 0.0F;
+    for (size_t i = 0; i < OFDM_CARRIERS; ++i) {
+        const struct ofdm_complex x = rx->fft[(int) ofdm->center + ofdm->carrier[i]];
+        const struct ofdm_complex e = rx->equalizer[i];
+        values[i] = (struct ofdm_complex) {x.re * e.re - x.im * e.im, x.re * e.im + x.im * e.re};
+        if (ofdm->pilot[i]) {
+            pilot_re += ofdm->training[1][i] * values[i].re;
+            pilot_im += ofdm->training[1][i] * values[i].im;
+        }
+    }
+
+    // Whatever phase the pilots have picked up since the last symbol, from a frequency offset that isn't quite all
+    // gone or the timing drifting, is taken out of this symbol and the equalizer, which so follows it.
+    const float pilot = sqrtf(pilot_re * pilot_re + pilot_im * pilot_im);
+    const float rot_re = pilot > 0.0F ? pilot_re / pilot : 1.0F;
+    const float rot_im = pilot > 0.0F ? -pilot_im / pilot : 0.0F;
+    for (size_t i = 0; i < OFDM_CARRIERS; ++i) {
+        struct ofdm_complex *e = &rx->equalizer[i];
+        const float re = e->re * rot_re - e->im * rot_im;
+        e->im = e->re * rot_im + e->im * rot_re;
+        e->re = re;
+    }
+
+    uint8_t bits[OFDM_BITS_PER_SYMBOL];
+    for (size_t i = 0, d = 0; i < OFDM_CARRIERS; ++i) {
+        if (ofdm->pilot[i])
+            continue;
+
+        const float re = values[i].re * rot_re - values[i].im * rot_im;
+        const float im = values[i].re * rot_im + values[i].im * rot_re;
+        bits[2 * d] = re < 0.0F;
+        bits[2 * d + 1] = im < 0.0F;
+        ++d;
+    }
+
+    memset(bytes, 0, OFDM_BYTES_PER_SYMBOL);
+    for (size_t b = 0; b < OFDM_BITS_PER_SYMBOL; ++b)
+        bytes[b / 8] |= (uint8_t) (bits[ofdm->interleave[b]] << (b % 8));
+}
+
+/// \brief Decode the next symbol of the burst.
+/// \param ofdm The modem
+/// \param start The first sample of its FFT window
+static void ofdm_rx_symbol(struct ofdm *ofdm, const uint64_t start) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const unsigned int index = rx->symbol_index++;
+
+    if (index == 0) {
+        ofdm_rx_fft(ofdm, start, rx->offset);
+        memcpy(rx->training, rx->fft, ofdm->plan.n * sizeof(*rx->training));
+        return;
+    }
+
+    if (index == 1) {
+        if (ofdm_rx_training(ofdm, start)) {
+            rx->state = OFDM_RX_DATA;
+        } else {
+            ++rx->sync_rejects;
+            ofdm_rx_search(rx);
+        }
+        return;
+    }
+
+    uint8_t bytes[OFDM_BYTES_PER_SYMBOL];
+    ofdm_rx_data(ofdm, start, bytes);
+
+    size_t first = 0;
+    if (index == 2) {
+        if (bytes[0] == 0 || bytes[0] > OFDM_MAX_BURST || (bytes[0] ^ bytes[1]) != 0xff) {
+            ++rx->header_errors;
+            ofdm_rx_search(rx);
+            return;
+        }
+        rx->burst_len = bytes[0];
+        rx->burst_received = 0;
+        first = OFDM_HEADER_BYTES;
+    }
+
+    for (size_t i = first; i < OFDM_BYTES_PER_SYMBOL && rx->burst_received < rx->burst_len; ++i) {
+        ++rx->burst_received;
+        if (rx->num_decoded == OFDM_RX_BUFFER) {
+            ++rx->overruns;
+        } else {
+            rx->decoded[rx->num_decoded++] = bytes[i];
+            ++rx->bytes;
+        }
+    }
+
+    if (rx->burst_received == rx->burst_len) {
+        ++rx->bursts;
+        ofdm_rx_search(rx);
+    }
+}
+
+/// \brief A burst's first training symbol ends here, at the middle of the correlation plateau: work out the frequency
+/// offset from the correlation and start on the burst.
+/// \param ofdm The modem
+/// \param end The last sample of the first training symbol's FFT window
+static void ofdm_rx_sync(struct ofdm *ofdm, const uint64_t end) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const unsigned int n = ofdm->plan.n;
+    const uint64_t mask = (uint64_t) n * OFDM_RING_SYMBOLS - 1;
+
+    // The halves of the symbol are the same but for the turn a frequency offset gives them in half a symbol, and the
+    // center bin being even means mixing down doesn't add to it.  That pins the offset down to within two subcarriers.
+    double re = 0.0;
+    double im = 0.0;
+    for (uint64_t t = end - n / 2 + 1; t <= end; ++t) {
+        const struct ofdm_complex a = rx->baseband[(t - n / 2) & mask];
+        const struct ofdm_complex b = rx->baseband[t & mask];
+        re += (double) a.re * b.re + (double) a.im * b.im;
+        im += (double) a.re * b.im - (double) a.im * b.re;
+    }
+
+    rx->offset = (float) (atan2(im, re) / M_PI);
+    rx->burst_start = end - n + 1;
+    rx->symbol_index = 0;
+    rx->state = OFDM_RX_TRAINING;
+}
+
+/// \brief Find the middle of the top of the correlation between two samples and synchronize to it.  The top is as
+/// wide as the cyclic prefix, and its middle puts the FFT windows half way into the cyclic prefix, which leaves room
+/// for timing error either way.
+/// \param ofdm The modem
+/// \param start The first sample above the threshold
+/// \param end The last sample above the threshold
+static void ofdm_rx_peak(struct ofdm *ofdm, const uint64_t start, const uint64_t end) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const uint64_t mask = (uint64_t) ofdm->plan.n * OFDM_RING_SYMBOLS - 1;
+
+    float peak = 0.0F;
+    for (uint64_t t = start; t <= end; ++t)
+        peak = fmaxf(peak, rx->metric[t & mask]);
+
+    uint64_t first = end;
+    uint64_t last = start;
+    for (uint64_t t = start; t <= end; ++t) {
+        if (rx->metric[t & mask] >= OFDM_PEAK_FRACTION * peak) {
+            first = t < first ? t : first;
+            last = t;
+        }
+    }
+    ofdm_rx_sync(ofdm, first + (last - first) / 2);
+}
+
+/// \brief Take in one received sample: keep it, mix it down, filter it and update the correlation.  While searching,
+/// look for the plateau a training symbol gives.
+/// \param ofdm The modem
+/// \param x The sample
+static void ofdm_rx_sample(struct ofdm *ofdm, const float x) {
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const unsigned int n = ofdm->plan.n;
+    const unsigned int half = n / 2;
+    const uint64_t mask = (uint64_t) n * OFDM_RING_SYMBOLS - 1;
+    const uint64_t filter_mask = rx->filter_len - 1;
+    const uint64_t t = rx->count++;
+
+    rx->ring[t & mask] = x;
+
+    const struct ofdm_complex w = ofdm->plan.twiddle[(t * ofdm->center) & (n - 1)];
+    const struct ofdm_complex mixed = {x * w.re, x * w.im};
+    const struct ofdm_complex mixed_old = rx->mixed[t & filter_mask];
+    rx->mixed[t & filter_mask] = mixed;
+    rx->sum_re[0] += (double) mixed.re - mixed_old.re;
+    rx->sum_im[0] += (double) mixed.im - mixed_old.im;
+
+    const struct ofdm_complex summed = {(float) rx->sum_re[0], (float) rx->sum_im[0]};
+    const struct ofdm_complex summed_old = rx->summed[t & filter_mask];
+    rx->summed[t & filter_mask] = summed;
+    rx->sum_re[1] += (double) summed.re - summed_old.re;
+    rx->sum_im[1] += (double) summed.im - summed_old.im;
+
+    const struct ofdm_complex z = {(float) rx->sum_re[1], (float) rx->sum_im[1]};
+    rx->baseband[t & mask] = z;
+
+    // The new term pairs this sample with the one half a symbol back; the term leaving pairs that one with the one a
+    // whole symbol back, which is the same sum as when it was added.
+    const struct ofdm_complex a = rx->baseband[(t - half) & mask];
+    const struct ofdm_complex b = rx->baseband[(t - n) & mask];
+    rx->corr_re += ((double) a.re * z.re + (double) a.im * z.im) - ((double) b.re * a.re + (double) b.im * a.im);
+    rx->corr_im += ((double) a.re * z.im - (double) a.im * z.re) - ((double) b.re * a.im - (double) b.im * a.re);
+    rx->energy += ((double) z.re * z.re + (double) z.im * z.im) - ((double) b.re * b.re + (double) b.im * b.im);
+
+    if (rx->state != OFDM_RX_SEARCH)
+        return;
+
+    const double corr = sqrt(rx->corr_re * rx->corr_re + rx->corr_im * rx->corr_im);
+    const float metric = rx->energy > rx->min_energy ? (float) (2.0 * corr / rx->energy) : 0.0F;
+    rx->metric[t & mask] = metric;
+    if (metric > OFDM_SYNC_THRESHOLD) {
+        if (!rx->plateau) {
+            rx->plateau = true;
+            rx->plateau_start = t;
+        }
+        rx->plateau_end = t;
+    } else if (rx->plateau && t - rx->plateau_end > ofdm->plan.cp / 2) {
+        // A steady tone that happens to repeat every half symbol stays above the threshold for as long as it lasts;
+        // a training symbol only for the cyclic prefix and the slopes either side.
+        rx->plateau = false;
+        if (rx->plateau_end - rx->plateau_start <= n + ofdm->plan.cp)
+            ofdm_rx_peak(ofdm, rx->plateau_start, rx->plateau_end);
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void ofdm_init(struct ofdm *ofdm, const uint32_t sample_rate) {
+    memset(ofdm, 0, sizeof(*ofdm));
+    ofdm->sample_rate = sample_rate;
+    ofdm->tx.amplitude = 1.0F;
+
+    // The first training symbol has twice the power on half the subcarriers, so that both have the same power.
+    uint16_t prbs = 0x1ff;
+    for (int i = 0; i < OFDM_CARRIERS; ++i) {
+        const int k = i < OFDM_CARRIERS / 2 ? i - OFDM_CARRIERS / 2 : i - OFDM_CARRIERS / 2 + 1;
+        ofdm->carrier[i] = k;
+        ofdm->pilot[i] = i % OFDM_PILOT_SPACING == OFDM_PILOT_SPACING / 3;
+        ofdm->training[0][i] = k % 2 == 0 ? (float) M_SQRT2 * ofdm_prbs(&prbs) : 0.0F;
+    }
+    for (int i = 0; i < OFDM_CARRIERS; ++i)
+        ofdm->training[1][i] = ofdm_prbs(&prbs);
+
+    // Each byte's bits go to every OFDM_BYTES_PER_SYMBOL'th place, so neighbouring bits are on subcarriers that are
+    // well apart and the two bits of a subcarrier come from different bytes.
+    for (unsigned int b = 0; b < OFDM_BITS_PER_SYMBOL; ++b)
+        ofdm->interleave[b] = (uint8_t) (b % 8 * OFDM_BYTES_PER_SYMBOL + b / 8);
+}
+
+int ofdm_acquire(void *arg) {
+    struct ofdm *ofdm = arg;
+
+    const unsigned int bits = (unsigned int) lround(log2(ofdm->sample_rate / OFDM_SPACING_HZ));
+    const unsigned int n = 1U << bits;
+    const double spacing = (double) ofdm->sample_rate / n;
+    const unsigned int center = 2 * (unsigned int) lround(OFDM_CENTER_HZ / (2.0 * spacing));
+    const unsigned int reach = OFDM_CARRIERS / 2 + 2 * OFDM_MAX_OFFSET_PAIRS;
+    if (n > OFDM_MAX_FFT || center < reach || center + reach >= n / 2) {
+        fprintf(stderr, "No OFDM plan for a sample rate of %u Hz\n", ofdm->sample_rate);
+        return -1;
+    }
+
+    const unsigned int cp = n / OFDM_CP_DIVISOR;
+    const unsigned int filter_len = n / OFDM_FILTER_DIVISOR > 0 ? n / OFDM_FILTER_DIVISOR : 1;
+    const size_t ring_len = (size_t) n * OFDM_RING_SYMBOLS;
+
+    // One allocation for everything, complex numbers first so that each part is aligned for what it holds
+    const size_t num_complex = n + n + n + ring_len + 2 * (size_t) filter_len;
+    const size_t num_float = (n + cp) + 2 * ring_len;
+    const size_t size = num_complex * sizeof(struct ofdm_complex) + num_float * sizeof(float);
+    void *memory = malloc(size);
+    if (memory == NULL)
+        return -1;
+    memset(memory, 0, size);
+
+    struct ofdm_complex *complex = memory;
+    ofdm->tx.fft = complex;
+    ofdm->rx.fft = complex += n;
+    ofdm->rx.training = complex += n;
+    ofdm->rx.baseband = complex += n;
+    ofdm->rx.mixed = complex += ring_len;
+    ofdm->rx.summed = complex += filter_len;
+    float *real = (float *) (complex + filter_len);
+    ofdm->tx.symbol = real;
+    ofdm->rx.ring = real += n + cp;
+    ofdm->rx.metric = real += ring_len;
+
+    ofdm->memory = memory;
+    ofdm->plan.twiddle = tables_twiddle[bits];
+    ofdm->plan.bitrev = tables_bitrev[bits];
+    ofdm->plan.n = n;
+    ofdm->plan.cp = cp;
+    ofdm->center = center;
+
+    ofdm->tx.pos = n + cp;
+    ofdm->tx.symbol_index = 0;
+    ofdm->tx.num_symbols = 0;
+
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    rx->count = 0;
+    rx->filter_len = filter_len;
+    rx->sum_re[0] = rx->sum_re[1] = rx->sum_im[0] = rx->sum_im[1] = 0.0;
+    rx->corr_re = rx->corr_im = rx->energy = 0.0;
+    const double min_level = OFDM_MIN_LEVEL * filter_len * filter_len;
+    rx->min_energy = n * min_level * min_level;
+    ofdm_rx_search(rx);
+    return 0;
+}
+
+void ofdm_release(void *arg) {
+    struct ofdm *ofdm = arg;
+    free(ofdm->memory);
+    ofdm->memory = NULL;
+    ofdm->plan = (struct ofdm_plan) {0};
+    ofdm->tx.symbol = NULL;
+    ofdm->tx.fft = NULL;
+    ofdm->rx.ring = NULL;
+    ofdm->rx.metric = NULL;
+    ofdm->rx.baseband = NULL;
+    ofdm->rx.mixed = NULL;
+    ofdm->rx.summed = NULL;
+    ofdm->rx.fft = NULL;
+    ofdm->rx.training = NULL;
+}
+
+size_t ofdm_queue(struct ofdm *ofdm, const uint8_t *data, const size_t len) {
+    struct ofdm_modulator *tx = &ofdm->tx;
+    const size_t tail = atomic_load_explicit(&tx->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&tx->head, memory_order_acquire);
+    const size_t space = OFDM_TX_QUEUE - (tail - head);
+    const size_t n = len < space ? len : space;
+
+    for (size_t i = 0; i < n; ++i)
+        tx->queue[(tail + i) % OFDM_TX_QUEUE] = data[i];
+    atomic_store_explicit(&tx->tail, tail + n, memory_order_release);
+
+    if (n < len)
+        atomic_fetch_add_explicit(&tx->dropped, len - n, memory_order_relaxed);
+    return n;
+}
+
+bool ofdm_queue_whole(struct ofdm *ofdm, const uint8_t *data, const size_t len) {
+    struct ofdm_modulator *tx = &ofdm->tx;
+    const size_t tail = atomic_load_explicit(&tx->tail, memory_order_relaxed);
+    const size_t head = atomic_load_explicit(&tx->head, memory_order_acquire);
+    if (OFDM_TX_QUEUE - (tail - head) < len) {
+        atomic_fetch_add_explicit(&tx->dropped, len, memory_order_relaxed);
+        return false;
+    }
+    return ofdm_queue(ofdm, data, len) == len;
+}
+
+void ofdm_modulate(void *arg, const float *in __attribute__((unused)), float *out, const size_t len) {
+    struct ofdm *ofdm = arg;
+    struct ofdm_modulator *tx = &ofdm->tx;
+    const unsigned int symbol_len = ofdm->plan.n + ofdm->plan.cp;
+
+    size_t i = 0;
+    while (ofdm->plan.n > 0 && i + 1 < len) {
+        if (tx->pos == symbol_len && !ofdm_next_symbol(ofdm))
+            break;
+
+        // Copy out as much of the symbol as fits
+        size_t run = (len - i) / DSP_FLOATS_PER_SAMPLE;
+        if (run > symbol_len - tx->pos)
+            run = symbol_len - tx->pos;
+        for (const float *symbol = tx->symbol + tx->pos; run > 0; --run, i += DSP_FLOATS_PER_SAMPLE) {
+            out[i] = out[i + 1] = *symbol++;
+            ++tx->pos;
+        }
+    }
+
+    memset(out + i, 0, (len - i) * sizeof(*out));
+}
+
+void ofdm_demodulate(void *arg, const float *in, float *out, const size_t len) {
+    struct ofdm *ofdm = arg;
+    struct ofdm_demodulator *rx = &ofdm->rx;
+    const unsigned int n = ofdm->plan.n;
+
+    // The packet goes in a symbol's worth at a time so that the ring always still holds the symbols we haven't got to
+    // yet, and then every symbol that has arrived in full is decoded in one go.
+    const size_t chunk = (size_t) n * DSP_FLOATS_PER_SAMPLE;
+    for (size_t i = 0; n > 0 && i + 1 < len;) {
+        const size_t end = len - i > chunk ? i + chunk : len;
+        for (; i + 1 < end; i += DSP_FLOATS_PER_SAMPLE)
+            ofdm_rx_sample(ofdm, in[i]);
+
+        while (rx->state != OFDM_RX_SEARCH) {
+            const uint64_t start = rx->burst_start + (uint64_t) rx->symbol_index * (n + ofdm->plan.cp);
+            if (start + n > rx->count)
+                break;
+            ofdm_rx_symbol(ofdm, start);
+        }
+    }
+
+    if (in != out)
+        memcpy(out, in, len * sizeof(*out));
+}
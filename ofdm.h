@@ -0,0 +1,248 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file ofdm.h
+/// @brief OFDM modem for audio modes: bursts of QPSK symbols with Schmidl-Cox synchronization
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// The modem sends bytes in bursts.  Each burst is two training symbols, then the data symbols and then a symbol's
+/// worth of silence so that the receiver is looking for the next burst before it starts:
+///
+///  - The first training symbol only uses every other subcarrier, so its two halves are the same.  The receiver finds
+///    it by correlating the signal with itself half a symbol later (Schmidl and Cox), which also gives the frequency
+///    offset to within two subcarriers.
+///  - The second uses every subcarrier with a known value.  Compared with the first it settles the frequency offset,
+///    and it gives each subcarrier's gain and phase for the equalizer.
+///  - The data symbols carry two bits on each data subcarrier as QPSK, interleaved so that a fade on neighbouring
+///    subcarriers doesn't take out neighbouring bits.  The pilot subcarriers carry known values that track the phase
+///    from symbol to symbol.  The first data symbol starts with the length of the burst and its complement.
+///
+/// The subcarriers sit either side of OFDM_CENTER_HZ, OFDM_SPACING_HZ apart, which keeps them inside an SSB filter.
+/// The FFT is the size that gives that spacing at the sample rate, so its plan and the buffers sized with it are only
+/// made once the sample rate is known and the waveform is ACTIVE, by ofdm_acquire.  The data callbacks never allocate.
+
+#ifndef WAVEFORM_EXAMPLE_OFDM_H
+#define WAVEFORM_EXAMPLE_OFDM_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The audio frequency the subcarriers are centered on, in Hz
+#define OFDM_CENTER_HZ 1500
+
+/// \brief The spacing of the subcarriers at 24kHz and any power of two times it, in Hz.  Other rates get the nearest
+/// spacing a power of two FFT allows.
+#define OFDM_SPACING_HZ 93.75
+
+/// \brief The largest FFT ofdm_acquire will make, which covers sample rates up to 384kHz
+#define OFDM_MAX_FFT 4096
+
+/// \brief The subcarriers in use, half either side of the center.  The center itself is left empty.
+#define OFDM_CARRIERS 24
+
+/// \brief Every this many subcarriers, one is a pilot
+#define OFDM_PILOT_SPACING 6
+
+/// \brief The subcarriers carrying data
+#define OFDM_DATA_CARRIERS (OFDM_CARRIERS - OFDM_CARRIERS / OFDM_PILOT_SPACING)
+
+/// \brief The bytes in a data symbol, at two bits a data subcarrier
+#define OFDM_BYTES_PER_SYMBOL (OFDM_DATA_CARRIERS * 2 / 8)
+
+/// \brief The most bytes in one burst.  More than this waiting to be sent goes in the next burst.
+#define OFDM_MAX_BURST 250
+
+/// \brief The bytes that can wait to be transmitted
+#define OFDM_TX_QUEUE 4096
+
+/// \brief The decoded bytes held until the receive callback hands them on
+#define OFDM_RX_BUFFER 256
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A complex number.  Kept as a plain pair so that nothing depends on how the compiler treats _Complex.
+struct ofdm_complex {
+    float re;
+    float im;
+};
+
+/// \brief A radix 2 FFT of one size, made by ofdm_acquire
+struct ofdm_plan {
+    unsigned int n;             ///< The FFT size, or 0 if there is no plan
+    unsigned int cp;            ///< The cyclic prefix, in samples
+    const struct ofdm_complex *twiddle; ///< exp(-2 pi i k / n) for every k below n, from tables_twiddle
+    const uint16_t *bitrev;     ///< Where each input goes for the butterflies, from tables_bitrev
+};
+
+/// \brief The transmitter.  The queue is written by the byte data callback and the rest by the transmit data callback.
+struct ofdm_modulator {
+    float amplitude;
+
+    // The symbol being sent: the cyclic prefix and then the symbol, with pos the next sample to go out
+    float *symbol;
+    struct ofdm_complex *fft;
+    unsigned int pos;
+
+    // The burst being sent.  Symbol 0 and 1 are the training symbols and the last is the silence.
+    unsigned int symbol_index;
+    unsigned int num_symbols;
+    unsigned int burst_len;
+    unsigned int burst_sent;
+
+    uint8_t queue[OFDM_TX_QUEUE];
+    _Atomic size_t head;        ///< Written by the consumer
+    _Atomic size_t tail;        ///< Written by the producer
+    _Atomic uint64_t dropped;   ///< Bytes that didn't fit in the queue
+
+    uint64_t bursts;
+};
+
+/// \brief What the receiver is doing
+enum ofdm_rx_state {
+    OFDM_RX_SEARCH,             ///< Looking for the first training symbol
+    OFDM_RX_TRAINING,           ///< Found it; waiting for both training symbols to arrive
+    OFDM_RX_DATA,               ///< Decoding data symbols
+};
+
+/// \brief The receiver.  Only ever touched by the receive data callback.
+struct ofdm_demodulator {
+    // The received samples, for the FFTs, and the same mixed down to the center and low pass filtered, for the
+    // synchronization.  Both are indexed by the sample count.
+    float *ring;
+    struct ofdm_complex *baseband;
+    uint64_t count;
+
+    // The low pass filter is two moving sums of the last filter_len samples; it only has to stop the mirror image
+    // of the signal that mixing a real signal down leaves behind from upsetting the correlation.
+    struct ofdm_complex *mixed;
+    struct ofdm_complex *summed;
+    unsigned int filter_len;
+    double sum_re[2];
+    double sum_im[2];
+
+    // The Schmidl-Cox correlation between the two halves of the last symbol's worth of baseband, and the energy of
+    // all of it.  The energy of both halves rather than just the second keeps the correlation from looking strong
+    // where the signal stops.  Each term is taken away again exactly as it was added, so in double precision the sums
+    // don't wander however long the waveform runs.
+    double corr_re;
+    double corr_im;
+    double energy;
+    double min_energy;
+
+    // The correlation over the energy while searching, and the run of samples it has been above the threshold
+    float *metric;
+    bool plateau;
+    uint64_t plateau_start;
+    uint64_t plateau_end;
+
+    enum ofdm_rx_state state;
+    uint64_t burst_start;       ///< The first sample of the first training symbol's FFT window
+    unsigned int symbol_index;
+    float offset;               ///< The frequency offset in subcarriers
+    struct ofdm_complex *fft;
+    struct ofdm_complex *training;
+    struct ofdm_complex equalizer[OFDM_CARRIERS];
+
+    unsigned int burst_len;
+    unsigned int burst_received;
+
+    uint8_t decoded[OFDM_RX_BUFFER];
+    size_t num_decoded;
+
+    uint64_t bursts;
+    uint64_t bytes;
+    uint64_t sync_rejects;      ///< Correlation peaks that weren't followed by our training symbols
+    uint64_t header_errors;
+    uint64_t overruns;
+    float offset_hz;            ///< The frequency offset of the last burst
+};
+
+/// \brief The modem.  The layout of the subcarriers around the center is fixed when it is initialized; everything that
+/// depends on the FFT size is made by ofdm_acquire and given back by ofdm_release.
+struct ofdm {
+    uint32_t sample_rate;
+    unsigned int center;        ///< The even FFT bin nearest OFDM_CENTER_HZ, set with the plan
+    int carrier[OFDM_CARRIERS]; ///< Each subcarrier's offset from the center, in bins
+    bool pilot[OFDM_CARRIERS];
+    float training[2][OFDM_CARRIERS]; ///< The values on each subcarrier in the two training symbols
+    uint8_t interleave[OFDM_BYTES_PER_SYMBOL * 8]; ///< Where each bit of a data symbol goes
+
+    struct ofdm_plan plan;
+    void *memory;
+
+    struct ofdm_modulator tx;
+    struct ofdm_demodulator rx;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a modem with an empty queue and no plan.
+/// \param ofdm The modem to initialize
+/// \param sample_rate The sample rate in Hz
+void ofdm_init(struct ofdm *ofdm, uint32_t sample_rate);
+
+/// \brief Make the FFT plan and the buffers for the sample rate.  A lifecycle resource acquired at ACTIVE.
+/// \param arg The struct ofdm
+/// \return 0 for success otherwise a negative value
+int ofdm_acquire(void *arg);
+
+/// \brief Give back the plan and the buffers and start both sides afresh.  A lifecycle resource released at INACTIVE.
+/// \param arg The struct ofdm
+void ofdm_release(void *arg);
+
+/// \brief Queue bytes to be sent.  Only one thread may call this.
+/// \param ofdm The modem
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return The number queued, which is less than len if the queue filled up
+size_t ofdm_queue(struct ofdm *ofdm, const uint8_t *data, size_t len);
+
+/// \brief Queue bytes to be sent only if they all fit, for data such as a FEC frame that is no use in part.  Only the
+/// thread that calls ofdm_queue may call this.
+/// \param ofdm The modem
+/// \param data The bytes
+/// \param len The number of bytes
+/// \return true if they were queued, otherwise false, and none of them were
+bool ofdm_queue_whole(struct ofdm *ofdm, const uint8_t *data, size_t len);
+
+/// \brief The modulator as a DSP stage.  It ignores its input and writes the same signal to both floats of each
+/// sample, silence if there is nothing to send or no plan.  See dsp.h.
+/// \param arg The struct ofdm
+/// \param in Unused
+/// \param out Receives the modulated signal
+/// \param len The number of floats
+void ofdm_modulate(void *arg, const float *in, float *out, size_t len);
+
+/// \brief The demodulator as a DSP stage.  It decodes the first float of each sample and passes its input through
+/// unchanged.  Decoded bytes collect in ofdm->rx.decoded.  See dsp.h.
+/// \param arg The struct ofdm
+/// \param in The received signal
+/// \param out Receives a copy of in, which may be the same buffer
+/// \param len The number of floats
+void ofdm_demodulate(void *arg, const float *in, float *out, size_t len);
+
+#endif // WAVEFORM_EXAMPLE_OFDM_H
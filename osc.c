@@ -0,0 +1,100 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file osc.c
+/// @brief Oscillators with a 64 bit phase that stay exact however long they run
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <math.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "osc.h"
+
+// ****************************************
+// Macros
+// ****************************************
+
+// Frequencies are held to this fraction of a hertz
+#define OSC_MILLIHERTZ 1000
+
+// A turn of the phase, as a double
+#define OSC_TURN 18446744073709551616.0
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+// The steps are a 64 bit fraction of a turn times a frequency, which takes twice the width to work out exactly.
+typedef unsigned __int128 osc_u128;
+
+// ****************************************
+// Global Functions
+// ****************************************
+void osc_init(struct osc *osc, const uint32_t sample_rate) {
+    memset(osc, 0, sizeof(*osc));
+    osc->sample_rate = sample_rate;
+    osc->step_divisor = (uint64_t) sample_rate * OSC_MILLIHERTZ;
+    osc->step_re = 1.0F;
+}
+
+void osc_set(struct osc *osc, const double hz) {
+    // A negative frequency steps the phase back, which in 64 bits is the same as stepping it forward by the rest of a
+    // turn.
+    const uint64_t divisor = osc->step_divisor;
+    const int64_t millihertz = llround(hz * OSC_MILLIHERTZ) % (int64_t) divisor;
+    const uint64_t numerator = (uint64_t) (millihertz < 0 ? millihertz + (int64_t) divisor : millihertz);
+    const osc_u128 turn = (osc_u128) numerator << 64;
+
+    osc->hz = hz;
+    osc->step = (uint64_t) (turn / divisor);
+    osc->step_remainder = (uint64_t) (turn % divisor);
+    osc->remainder = 0;
+
+    const double step = 2.0 * M_PI * hz / osc->sample_rate;
+    osc->step_re = (float) cos(step);
+    osc->step_im = (float) sin(step);
+}
+
+void osc_advance(struct osc *osc, const uint64_t samples) {
+    const osc_u128 remainder = (osc_u128) osc->step_remainder * samples + osc->remainder;
+    const uint64_t phase = atomic_load_explicit(&osc->phase, memory_order_relaxed);
+    osc->remainder = (uint64_t) (remainder % osc->step_divisor);
+    atomic_store_explicit(&osc->phase, phase + osc->step * samples + (uint64_t) (remainder / osc->step_divisor),
+                          memory_order_relaxed);
+}
+
+void osc_phasor(const struct osc *osc, float *re, float *im) {
+    const double phase = 2.0 * M_PI * (double) atomic_load_explicit(&osc->phase, memory_order_relaxed) / OSC_TURN;
+    *re = (float) cos(phase);
+    *im = (float) sin(phase);
+}
+
+void osc_phase32(const struct osc *osc, uint32_t *phase, uint32_t *step) {
+    *phase = (uint32_t) (atomic_load_explicit(&osc->phase, memory_order_relaxed) >> 32);
+    *step = (uint32_t) ((osc->step >> 32) + (osc->step >> 31 & 1));
+}
+
+unsigned int osc_index(const struct osc *osc, const unsigned int len) {
+    // Rounded to nearest, since the phase is the ideal one rounded down and may be just short of a table entry
+    const uint64_t phase = atomic_load_explicit(&osc->phase, memory_order_relaxed);
+    const unsigned int index = (unsigned int) (((osc_u128) phase * len + ((osc_u128) 1 << 63)) >> 64);
+    return index == len ? 0 : index;
+}
@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file osc.h
+/// @brief Oscillators with a 64 bit phase that stay exact however long they run
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// The phase is a fraction of a turn in 64 bits, so it wraps by itself and never needs pulling back into range.  A
+/// frequency in whole millihertz is rarely a whole number of those a sample, so the step is kept as a whole part and a
+/// remainder over the sample rate, and the remainders are carried as they add up.  The phase after any number of
+/// samples is then exactly the ideal one rounded down: a tone left running for months is where it should be to 2^-64
+/// of a turn, with no drift from rounding the step.
+///
+/// The oscillator only moves a packet at a time.  The stages that use it work out where it is at the start of a
+/// packet, exactly, and step a float rotator or a table index from there across the packet.  That is the cheap
+/// per-sample part, and whatever rounding error it picks up is thrown away at the next packet, which starts again from
+/// the exact phase.  Nothing about it changes when a packet ends or the radio is keyed and unkeyed, so the signal
+/// carries on with no jump in phase.
+
+#ifndef WAVEFORM_EXAMPLE_OSC_H
+#define WAVEFORM_EXAMPLE_OSC_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief An oscillator.  Only ever moved by one data callback; the phase is atomic so that it can be read from
+/// elsewhere, such as to carry it over a reconnect.
+struct osc {
+    _Atomic uint64_t phase;     ///< The fraction of a turn, in units of 2^-64
+    uint64_t step;              ///< The whole part of the phase step
+    uint64_t step_remainder;    ///< The rest of the step, in units of 2^-64 / step_divisor
+    uint64_t remainder;         ///< The rest of the phase, in the same units, always below step_divisor
+    uint64_t step_divisor;      ///< The sample rate in millihertz
+    uint32_t sample_rate;
+    double hz;                  ///< The frequency, positive or negative
+    float step_re;              ///< The rotation in one sample, for stepping a rotator across a packet
+    float step_im;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize an oscillator at zero phase and frequency.
+/// \param osc The oscillator to initialize
+/// \param sample_rate The sample rate in Hz
+void osc_init(struct osc *osc, uint32_t sample_rate);
+
+/// \brief Change an oscillator's frequency, carrying on from its present phase.
+/// \param osc The oscillator
+/// \param hz The frequency, rounded to the nearest millihertz
+void osc_set(struct osc *osc, double hz);
+
+/// \brief Move an oscillator on, exactly.
+/// \param osc The oscillator
+/// \param samples The number of samples to move it on by
+void osc_advance(struct osc *osc, uint64_t samples);
+
+/// \brief Where an oscillator is, as a unit complex number to seed a rotator with.
+/// \param osc The oscillator
+/// \param re Receives the cosine of the phase
+/// \param im Receives the sine of the phase
+void osc_phasor(const struct osc *osc, float *re, float *im);
+
+/// \brief Where an oscillator is and how far it moves in a sample, as 32 bit fractions of a turn, to seed a phase
+/// accumulator with.  The step is rounded, so the accumulator is only good for a packet or so before it has to be
+/// seeded again.
+/// \param osc The oscillator
+/// \param phase Receives the phase, rounded down
+/// \param step Receives the step, rounded to nearest
+void osc_phase32(const struct osc *osc, uint32_t *phase, uint32_t *step);
+
+/// \brief Where an oscillator is, as an index into a table holding one turn of it.
+/// \param osc The oscillator
+/// \param len The number of values in the table
+/// \return The index of the value nearest the phase
+unsigned int osc_index(const struct osc *osc, unsigned int len);
+
+#endif // WAVEFORM_EXAMPLE_OSC_H
@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file perfect_hash.h
+/// @brief Lookup side of the perfect hashes generated by tools/gen_perfect_hash.py
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_PERFECT_HASH_H
+#define WAVEFORM_EXAMPLE_PERFECT_HASH_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stddef.h>
+#include <stdint.h>
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Compute the slot of a key in a generated perfect hash table.
+/// This is FNV-1a starting from the generated seed, keeping the top bits.  It must match fnv1a() in
+/// tools/gen_perfect_hash.py exactly.
+/// \param seed The <PREFIX>_HASH_SEED from the generated header
+/// \param bits The <PREFIX>_HASH_BITS from the generated header
+/// \param key The start of the key; it need not be NUL terminated
+/// \param len The length of the key
+/// \return The slot to look up in the generated <prefix>_hash_slots table
+static inline unsigned int perfect_hash_slot(const uint32_t seed, const unsigned int bits, const char *key,
+                                             const size_t len) {
+    uint32_t hash = seed;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t) key[i];
+        hash *= 16777619U;
+    }
+
+    return hash >> (32 - bits);
+}
+
+#endif // WAVEFORM_EXAMPLE_PERFECT_HASH_H
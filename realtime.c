@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file realtime.c
+/// @brief Real-time scheduling, CPU affinity and memory locking for the data callback threads
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// For cpu_set_t and pthread_setaffinity_np
+#define _GNU_SOURCE
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "realtime.h"
+
+// ****************************************
+// Static Variables
+// ****************************************
+
+// The generation of settings this thread last applied.  It starts out matching the initial generation, so that nothing
+// happens on a thread until the first realtime_arm.
+static __thread unsigned int realtime_seen;
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Touch every page of the stack below us so that it is resident before we need it.  Kept out of line so that
+/// the array is below the caller's frame rather than merged into it.
+static void __attribute__((noinline)) realtime_prefault_stack(void) {
+    volatile unsigned char stack[REALTIME_STACK_PREFAULT];
+    const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < sizeof(stack); i += page)
+        stack[i] = 0;
+}
+
+/// \brief Apply the settings to the calling thread and prefault its stack.
+/// \param realtime The settings
+static void realtime_prepare_thread(struct realtime *realtime) {
+    const struct sched_param param = {.sched_priority = realtime->priority};
+    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        atomic_store_explicit(&realtime->sched_errno, ret, memory_order_relaxed);
+        atomic_fetch_add_explicit(&realtime->sched_failures, 1, memory_order_relaxed);
+    }
+
+    if (realtime->cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(realtime->cpu, &cpus);
+        ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (ret != 0) {
+            atomic_store_explicit(&realtime->affinity_errno, ret, memory_order_relaxed);
+            atomic_fetch_add_explicit(&realtime->affinity_failures, 1, memory_order_relaxed);
+        }
+    }
+
+    realtime_prefault_stack();
+
+    atomic_fetch_add_explicit(&realtime->threads_prepared, 1, memory_order_relaxed);
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+int realtime_init(struct realtime *realtime, const int priority, const int cpu) {
+    memset(realtime, 0, sizeof(*realtime));
+    realtime->priority = priority;
+    realtime->cpu = cpu;
+    atomic_init(&realtime->generation, 0);
+
+    // MCL_FUTURE also covers the stacks of the threads the library creates when the radio starts, and anything we
+    // allocate later, so that none of it can be paged out from under a data callback.
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+        return -1;
+
+    realtime->locked = true;
+    return 0;
+}
+
+void realtime_arm(struct realtime *realtime) {
+    atomic_fetch_add_explicit(&realtime->generation, 1, memory_order_release);
+}
+
+void realtime_enter(struct realtime *realtime) {
+    const unsigned int generation = atomic_load_explicit(&realtime->generation, memory_order_acquire);
+    if (generation == realtime_seen)
+        return;
+
+    realtime_seen = generation;
+    realtime_prepare_thread(realtime);
+}
+
+void realtime_dump(struct realtime *realtime, FILE *file) {
+    fprintf(file, "Realtime: SCHED_FIFO %d, cpu %d, memory %s, %" PRIu64 " threads prepared\n", realtime->priority,
+            realtime->cpu, realtime->locked ? "locked" : "not locked",
+            atomic_load_explicit(&realtime->threads_prepared, memory_order_relaxed));
+
+    const uint64_t sched_failures = atomic_load_explicit(&realtime->sched_failures, memory_order_relaxed);
+    if (sched_failures > 0)
+        fprintf(file, "Realtime: %" PRIu64 " threads could not be made SCHED_FIFO: %s\n", sched_failures,
+                strerror(atomic_load_explicit(&realtime->sched_errno, memory_order_relaxed)));
+
+    const uint64_t affinity_failures = atomic_load_explicit(&realtime->affinity_failures, memory_order_relaxed);
+    if (affinity_failures > 0)
+        fprintf(file, "Realtime: %" PRIu64 " threads could not be pinned to cpu %d: %s\n", affinity_failures,
+                realtime->cpu, strerror(atomic_load_explicit(&realtime->affinity_errno, memory_order_relaxed)));
+}
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file realtime.h
+/// @brief Real-time scheduling, CPU affinity and memory locking for the data callback threads
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_REALTIME_H
+#define WAVEFORM_EXAMPLE_REALTIME_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The SCHED_FIFO priority given to the data callback threads unless another is asked for.  It is above the
+/// kernel's default for threaded interrupt handlers (50) so that network interrupts can't starve us, but well below the
+/// watchdog and migration threads at 99.
+#define REALTIME_DEFAULT_PRIORITY 60
+
+/// \brief The bytes of stack touched on each data callback thread so that the first deep call doesn't fault
+#define REALTIME_STACK_PREFAULT (128 * 1024)
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The real-time settings and what came of applying them.
+///
+/// We don't create the threads that run our data callbacks; the library does.  So rather than set them up from the
+/// outside, the state callback arms the settings at ACTIVE and each data callback thread applies them to itself, once,
+/// the next time it runs one of our callbacks.  A data callback only pays for one atomic load and a compare when there
+/// is nothing to do.  The buffers the data callbacks use are prefaulted where they are allocated, at ACTIVE; see
+/// lifecycle.h.
+struct realtime {
+    int priority;               ///< SCHED_FIFO priority for the data callback threads
+    int cpu;                    ///< The CPU to pin the data callback threads to, or -1 to leave them be
+    bool locked;                ///< Whether mlockall succeeded
+
+    _Atomic unsigned int generation;    ///< Bumped by realtime_arm; a thread that has seen a lower one has work to do
+    _Atomic uint64_t threads_prepared;
+    _Atomic uint64_t sched_failures;
+    _Atomic uint64_t affinity_failures;
+    _Atomic int sched_errno;
+    _Atomic int affinity_errno;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Lock the process's memory, current and future, and set up the settings for the data callback threads.  A
+/// failure to lock memory is reported but not fatal since everything still works, only with less margin.
+/// \param realtime The settings to initialize
+/// \param priority SCHED_FIFO priority, 1 to 99
+/// \param cpu The CPU to pin the data callback threads to, or -1 for none
+/// \return 0 for success otherwise a negative value with errno set if memory couldn't be locked
+int realtime_init(struct realtime *realtime, int priority, int cpu);
+
+/// \brief Ask every data callback thread to apply the settings and prefault its stack the next time it runs.  Call this
+/// from the state callback at ACTIVE.
+/// \param realtime The settings
+void realtime_arm(struct realtime *realtime);
+
+/// \brief Apply the settings to the calling thread if realtime_arm has been called since it last did.  Call this at
+/// the top of every data callback.  It makes system calls only when there is something to do.
+/// \param realtime The settings
+void realtime_enter(struct realtime *realtime);
+
+/// \brief Print what the settings did.
+/// \param realtime The settings
+/// \param file Where to print
+void realtime_dump(struct realtime *realtime, FILE *file);
+
+#endif // WAVEFORM_EXAMPLE_REALTIME_H
@@ -0,0 +1,354 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file replay.c
+/// @brief Replay a capture file through the waveform's data callbacks without a radio
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// This program is linked against the mock library in mock/ rather than libwaveform, with packets loaded from a capture
+/// file recorded with "waveform-example --record".  Every packet is delivered to packet_rx or packet_tx through the
+/// mock just as the library would have delivered it, either as fast as possible or paced by the packets' own
+/// timestamps, and the time spent inside the callbacks is measured.
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <libgen.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include <waveform/waveform_mock.h>
+#include "capture.h"
+#include "commands.h"
+#include "cycles.h"
+#include "junk_waveform.h"
+#include "lifecycle.h"
+#include "ofdm.h"
+#include "telemetry.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000LL
+
+// How often to look at whether the resources have been acquired
+#define REPLAY_ACTIVATE_POLL_NS 1000000L
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+// A packet as loaded from the capture, with which callback it goes to
+struct replay_packet {
+    struct waveform_vita_packet packet;
+    uint8_t direction;
+    uint8_t flags;
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read the monotonic clock in nanoseconds
+/// \return The current value of CLOCK_MONOTONIC
+static int64_t replay_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * NS_PER_SEC + now.tv_nsec;
+}
+
+/// \brief Load every packet of a capture into memory so that reading the file doesn't get counted in the results.
+/// \param capture The open capture
+/// \param count Receives the number of packets
+/// \return The packets, whose samples point into the same allocation, or NULL on error
+static struct replay_packet *replay_load(struct capture *capture, size_t *count) {
+    struct capture_record record;
+    static float samples[CAPTURE_MAX_SAMPLES];
+    size_t packets = 0;
+    size_t total_samples = 0;
+    int ret;
+
+    while ((ret = capture_read(capture, &record, samples)) == 1) {
+        ++packets;
+        total_samples += record.num_samples;
+    }
+    if (ret < 0 || capture_rewind(capture) != 0)
+        return NULL;
+
+    struct replay_packet *loaded = malloc(packets * sizeof(*loaded) + total_samples * sizeof(float) + 1);
+    if (loaded == NULL)
+        return NULL;
+
+    float *next = (float *) &loaded[packets];
+    for (size_t i = 0; i < packets; ++i) {
+        if (capture_read(capture, &record, next) != 1) {
+            free(loaded);
+            return NULL;
+        }
+
+        loaded[i] = (struct replay_packet) {
+            .packet = {
+                .stream_id = record.stream_id,
+                .class_id = record.class_id,
+                .ts_int = record.ts_int,
+                .ts_frac = record.ts_frac,
+                .packet_count = record.packet_count,
+                .num_samples = (uint16_t) record.num_samples,
+                .sample_rate = capture->sample_rate,
+                .samples = next,
+            },
+            .direction = record.direction,
+            .flags = record.flags,
+        };
+        next += record.num_samples;
+    }
+
+    *count = packets;
+    return loaded;
+}
+
+/// \brief Print a usage message to the console
+/// @param progname The name of this program
+static void usage(const char *progname) {
+    fprintf(stderr, "Usage: %s [options] <capture file>\n\n", progname);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  -t, --realtime                     Pace packets by their timestamps [default: full speed]\n");
+    fprintf(stderr, "  -l <count>, --loops=<count>        Play the capture this many times [default: 1]\n");
+    fprintf(stderr, "  -p <key=value>, --set=<key=value>  Set a parameter as \"set\" would [e.g. submode=fsk]\n");
+}
+
+/// \brief The command line parameters
+static const struct option replay_options[] = {
+    {
+        .name = "realtime",
+        .has_arg = no_argument,
+        .flag = NULL,
+        .val = 't'
+    },
+    {
+        .name = "loops",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'l'
+    },
+    {
+        .name = "set",
+        .has_arg = required_argument,
+        .flag = NULL,
+        .val = 'p'
+    },
+    {0} // Sentinel
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+int main(const int argc, char **argv) {
+    bool realtime = false;
+    unsigned long loops = 1;
+    struct junk_params params = junk_params_defaults;
+
+    while (1) {
+        int indexptr;
+        const int option = getopt_long(argc, argv, "tl:p:", replay_options, &indexptr);
+
+        if (option == -1)
+            break;
+
+        switch (option) { // NOLINT(*-multiway-paths-covered)
+            case 't':
+                realtime = true;
+                break;
+            case 'l': {
+                char *end;
+                loops = strtoul(optarg, &end, 10);
+                if (*end != '\0' || loops < 1) {
+                    fprintf(stderr, "Loop count must be at least 1\n");
+                    exit(1);
+                }
+                break;
+            }
+            case 'p':
+                if (params_parse(&params, 1, &optarg) != COMMAND_OK) {
+                    fprintf(stderr, "Invalid parameter %s\n", optarg);
+                    exit(1);
+                }
+                break;
+            default:
+                usage(basename(argv[0]));
+                exit(1);
+        }
+    }
+
+    if (optind != argc - 1) {
+        usage(basename(argv[0]));
+        exit(1);
+    }
+
+    struct capture capture;
+    if (capture_open(&capture, argv[optind]) != 0) {
+        fprintf(stderr, "Unable to open capture file %s\n", argv[optind]);
+        exit(1);
+    }
+
+    size_t count = 0;
+    struct replay_packet *packets = replay_load(&capture, &count);
+    const uint32_t sample_rate = capture.sample_rate;
+    capture_close(&capture);
+    if (packets == NULL) {
+        fprintf(stderr, "Capture file %s is corrupt\n", argv[optind]);
+        exit(1);
+    }
+    if (count == 0) {
+        fprintf(stderr, "Capture file %s is empty\n", argv[optind]);
+        free(packets);
+        return 0;
+    }
+
+    // The same context the live waveform starts with.
+    struct junk_context ctx = {0};
+    params_exchange_init(&ctx.params, &params);
+    junk_dsp_init(&ctx);
+    telemetry_init(&ctx.telemetry, sample_rate);
+    struct waveform_t *waveform = waveform_create(NULL, "JunkMode", "JUNK", JUNK_MODE, "1.0.0", SR_24K);
+    if (waveform == NULL) {
+        fprintf(stderr, "Failed to create the waveform\n");
+        free(packets);
+        exit(1);
+    }
+    waveform_set_context(waveform, &ctx);
+    waveform_register_rx_data_cb(waveform, packet_rx, NULL);
+    waveform_register_tx_data_cb(waveform, packet_tx, NULL);
+    waveform_register_meter(waveform, "junk-snr", -100.0f, 100.0f, DB);
+    waveform_register_meter(waveform, TELEMETRY_METER_DUTY, 0.0f, 100.0f, PERCENT);
+    waveform_register_meter(waveform, TELEMETRY_METER_DROPS, 0.0f, 1000000.0f, NONE);
+    waveform_register_meter(waveform, AGC_METER_GAIN, -20.0f, 40.0f, DB);
+
+    // Go ACTIVE as the live waveform would and give the resources a moment to be acquired, since the data callbacks
+    // only use them once they all are.
+    lifecycle_init(&ctx.lifecycle);
+    lifecycle_register(&ctx.lifecycle, "OFDM modem", ofdm_acquire, ofdm_release, &ctx.ofdm);
+    if (lifecycle_activate(&ctx.lifecycle) != 0) {
+        fprintf(stderr, "Failed to start acquiring resources\n");
+        waveform_destroy(waveform);
+        free(packets);
+        exit(1);
+    }
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = REPLAY_ACTIVATE_POLL_NS};
+    while (!lifecycle_enter(&ctx.lifecycle))
+        nanosleep(&poll, NULL);
+    lifecycle_exit(&ctx.lifecycle);
+
+    uint64_t cycles = 0;
+    uint64_t samples = 0;
+    uint64_t delivered = 0;
+    const int64_t start_ns = replay_now_ns();
+
+    for (unsigned long loop = 0; loop < loops; ++loop) {
+        // In real time, each packet is delivered when its timestamp comes up relative to the first packet of the pass.
+        // A jump backwards or of more than a second (say, across a reconnect) restarts the pacing from that packet.
+        int64_t base_ns = replay_now_ns();
+        int64_t base_ts_ns = 0;
+        int64_t last_ts_ns = -1;
+
+        for (size_t i = 0; i < count; ++i) {
+            struct replay_packet *replay = &packets[i];
+            struct waveform_vita_packet *packet = &replay->packet;
+
+            if (realtime) {
+                struct timespec ts;
+                get_packet_ts(packet, &ts);
+                const int64_t ts_ns = (int64_t) ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+                if (last_ts_ns < 0 || ts_ns < last_ts_ns || ts_ns - last_ts_ns > NS_PER_SEC) {
+                    base_ns = replay_now_ns();
+                    base_ts_ns = ts_ns;
+                }
+                last_ts_ns = ts_ns;
+
+                const int64_t due = base_ns + (ts_ns - base_ts_ns);
+                const struct timespec deadline = {.tv_sec = due / NS_PER_SEC, .tv_nsec = due % NS_PER_SEC};
+                while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+                    ;
+            }
+
+            ctx.tx = (replay->flags & CAPTURE_FLAG_TX) != 0;
+
+            const uint64_t before = cycles_now();
+            if (replay->direction == CAPTURE_RX)
+                waveform_mock_rx(waveform, packet);
+            else
+                waveform_mock_tx(waveform, packet);
+            cycles += cycles_now() - before;
+
+            samples += packet->num_samples;
+            ++delivered;
+        }
+    }
+
+    const double elapsed = (double) (replay_now_ns() - start_ns) / NS_PER_SEC;
+
+    printf("Replayed %llu packets (%llu samples at %u Hz) in %.3f s\n", (unsigned long long) delivered,
+           (unsigned long long) samples, sample_rate, elapsed);
+    printf("Throughput: %.0f packets/s, %.0f samples/s\n", (double) delivered / elapsed, (double) samples / elapsed);
+    printf("Callbacks: %.2f %s/sample, %.0f %s/packet\n", (double) cycles / (double) samples, CYCLES_UNIT,
+           (double) cycles / (double) delivered, CYCLES_UNIT);
+    printf("Sent: speaker=%llu transmitter=%llu samples, %llu byte packets, %llu meter updates\n",
+           (unsigned long long) waveform_mock_sent(waveform, SPEAKER_DATA)->samples,
+           (unsigned long long) waveform_mock_sent(waveform, TRANSMITTER_DATA)->samples,
+           (unsigned long long) waveform_mock_sent_bytes(waveform)->packets,
+           (unsigned long long) waveform_mock_meters_sent(waveform));
+
+    // The duty cycle meter is only meaningful in real time, when packets arrive as far apart as they did on the air.
+    float duty = 0.0F;
+    float drops = 0.0F;
+    waveform_mock_meter_value(waveform, TELEMETRY_METER_DUTY, &duty);
+    waveform_mock_meter_value(waveform, TELEMETRY_METER_DROPS, &drops);
+    printf("Telemetry: last duty cycle %.2f%%, %.0f packets missing from the capture\n", duty, drops);
+    printf("AGC: gain %.1f dB\n", agc_gain_db(&ctx.rx_agc));
+    dsp_graph_dump(&ctx.rx_dsp[params.submode], "receive", stdout);
+    dsp_graph_dump(&ctx.tx_dsp[params.submode], "transmit", stdout);
+    if (params.submode == JUNK_SUBMODE_FSK) {
+        printf("FSK: %u baud, %" PRIu64 " bytes decoded, %" PRIu64 " framing errors, %" PRIu64 " overruns\n",
+               ctx.fsk_rx.baud, ctx.fsk_rx.bytes, ctx.fsk_rx.framing_errors, ctx.fsk_rx.overruns);
+    }
+    if (params.submode == JUNK_SUBMODE_OFDM) {
+        printf("OFDM: %u point FFT, %" PRIu64 " bursts, %" PRIu64 " bytes decoded, %" PRIu64 " sync rejects, %" PRIu64
+               " header errors, %" PRIu64 " overruns, last offset %.1f Hz\n",
+               ctx.ofdm.plan.n, ctx.ofdm.rx.bursts, ctx.ofdm.rx.bytes, ctx.ofdm.rx.sync_rejects,
+               ctx.ofdm.rx.header_errors, ctx.ofdm.rx.overruns, ctx.ofdm.rx.offset_hz);
+    }
+    if (params.fec == JUNK_FEC_ON) {
+        printf("FEC: %" PRIu64 " frames, %" PRIu64 " bytes corrected, %" PRIu64 " uncorrectable, %" PRIu64
+               " CRC errors, %" PRIu64 " overruns\n",
+               ctx.fec_rx.frames, ctx.fec_rx.corrected, ctx.fec_rx.rs_failures, ctx.fec_rx.crc_errors,
+               ctx.fec_rx.overruns);
+    }
+
+    lifecycle_deactivate(&ctx.lifecycle, stderr);
+
+    waveform_destroy(waveform);
+    free(packets);
+    return 0;
+}
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file scheduler.c
+/// @brief Scheduler for timed radio commands aligned to VITA-49 sample timestamps
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "scheduler.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000LL
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Convert a timespec to nanoseconds
+/// \param ts The time to convert
+/// \return The time in nanoseconds
+static int64_t scheduler_ns(const struct timespec *ts) {
+    return (int64_t) ts->tv_sec * NS_PER_SEC + ts->tv_nsec;
+}
+
+/// \brief Read the wall clock in nanoseconds.  The radio's timestamps and the "at" of timed commands are on the UNIX
+/// epoch, so this is the clock to compare them against.
+/// \return The current value of CLOCK_REALTIME in nanoseconds
+static int64_t scheduler_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return scheduler_ns(&now);
+}
+
+/// \brief Heap ordering: earliest time first, and in order of scheduling for equal times.
+/// \param a The first event
+/// \param b The second event
+/// \return true if a should run before b
+static bool scheduler_before(const struct scheduler_event *a, const struct scheduler_event *b) {
+    const int64_t at_a = scheduler_ns(&a->at);
+    const int64_t at_b = scheduler_ns(&b->at);
+    return at_a < at_b || (at_a == at_b && a->sequence < b->sequence);
+}
+
+/// \brief Remove the earliest event from the heap.  Must be called with the lock held and the heap non-empty.
+/// \param scheduler The scheduler
+/// \param event Receives the earliest event
+static void scheduler_pop(struct scheduler *scheduler, struct scheduler_event *event) {
+    struct scheduler_event *heap = scheduler->heap;
+
+    *event = heap[0];
+    heap[0] = heap[--scheduler->count];
+    atomic_store_explicit(&scheduler->depth, (unsigned int) scheduler->count, memory_order_relaxed);
+
+    size_t i = 0;
+    while (1) {
+        const size_t left = 2 * i + 1;
+        const size_t right = left + 1;
+        size_t smallest = i;
+
+        if (left < scheduler->count && scheduler_before(&heap[left], &heap[smallest]))
+            smallest = left;
+        if (right < scheduler->count && scheduler_before(&heap[right], &heap[smallest]))
+            smallest = right;
+        if (smallest == i)
+            break;
+
+        const struct scheduler_event tmp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = tmp;
+        i = smallest;
+    }
+}
+
+/// \brief Find a free in-flight slot.  Must be called with the lock held.
+/// \param scheduler The scheduler
+/// \return A free slot or NULL if every slot is busy
+static struct scheduler_slot *scheduler_free_slot(struct scheduler *scheduler) {
+    for (size_t i = 0; i < SCHEDULER_IN_FLIGHT; ++i) {
+        if (!scheduler->slots[i].busy)
+            return &scheduler->slots[i];
+    }
+    return NULL;
+}
+
+/// \brief Called when the radio has put a timed command in its queue.  This tells us how much margin the command
+/// really had once it reached the radio.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param code The numeric error code returned from the command.  0 is success, anything else is a failure
+/// \param message The descriptive message returned from the radio
+/// \param arg The struct scheduler_slot for the command
+static void scheduler_queued(struct waveform_t *waveform __attribute__((unused)), const unsigned int code,
+                             const char *message, void *arg) {
+    struct scheduler_slot *slot = arg;
+    struct scheduler *scheduler = slot->scheduler;
+
+    const int64_t slack = scheduler_ns(&slot->at) - scheduler_now_ns();
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (code != 0) {
+        // Leave the slot for the complete callback to free so that it is only ever released once.
+        fprintf(stderr, "Timed command \"%s\" was refused with code %08x: %s\n", slot->command, code, message);
+    } else {
+        if (scheduler->stats.queued == 0 || slack < scheduler->stats.queued_slack_min_ns)
+            scheduler->stats.queued_slack_min_ns = slack;
+        scheduler->stats.queued_slack_sum_ns += slack;
+        ++scheduler->stats.queued;
+        slot->queued = true;
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/// \brief Called when the radio has executed a timed command.  Frees its slot for the next command.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param code The numeric error code returned from the command.  0 is success, anything else is a failure
+/// \param message The descriptive message returned from the radio
+/// \param arg The struct scheduler_slot for the command
+static void scheduler_complete(struct waveform_t *waveform __attribute__((unused)), const unsigned int code,
+                               const char *message, void *arg) {
+    struct scheduler_slot *slot = arg;
+    struct scheduler *scheduler = slot->scheduler;
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (code != 0) {
+        fprintf(stderr, "Timed command \"%s\" failed with code %08x: %s\n", slot->command, code, message);
+        ++scheduler->stats.failed;
+    } else {
+        ++scheduler->stats.completed;
+    }
+    slot->busy = false;
+    pthread_cond_signal(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+/// \brief The scheduler thread.  Sleeps until the earliest command is due to be handed to the radio, i.e. its
+/// execution time less the lead time, and sends it with waveform_send_timed_api_command_cb.
+/// \param arg The struct scheduler
+/// \return Always NULL
+static void *scheduler_thread(void *arg) {
+    struct scheduler *scheduler = arg;
+
+    pthread_mutex_lock(&scheduler->lock);
+    while (scheduler->running) {
+        if (scheduler->count == 0) {
+            pthread_cond_wait(&scheduler->cond, &scheduler->lock);
+            continue;
+        }
+
+        struct scheduler_slot *slot = scheduler_free_slot(scheduler);
+        if (slot == NULL) {
+            pthread_cond_wait(&scheduler->cond, &scheduler->lock);
+            continue;
+        }
+
+        const int64_t due = scheduler_ns(&scheduler->heap[0].at) - scheduler->lead_ns;
+        const int64_t now = scheduler_now_ns();
+        if (now < due) {
+            const struct timespec deadline = {.tv_sec = due / NS_PER_SEC, .tv_nsec = due % NS_PER_SEC};
+            pthread_cond_timedwait(&scheduler->cond, &scheduler->lock, &deadline);
+            continue;
+        }
+
+        struct scheduler_event event;
+        scheduler_pop(scheduler, &event);
+
+        const int64_t slack = scheduler_ns(&event.at) - now;
+        if (scheduler->stats.submitted == 0 || slack < scheduler->stats.submit_slack_min_ns)
+            scheduler->stats.submit_slack_min_ns = slack;
+        if (slack <= 0)
+            ++scheduler->stats.late;
+        ++scheduler->stats.submitted;
+
+        slot->busy = true;
+        slot->queued = false;
+        slot->at = event.at;
+        memcpy(slot->command, event.command, sizeof(slot->command));
+        pthread_mutex_unlock(&scheduler->lock);
+
+        const int32_t ret = waveform_send_timed_api_command_cb(scheduler->waveform, &event.at, scheduler_complete,
+                                                               scheduler_queued, slot, "%s", event.command);
+
+        pthread_mutex_lock(&scheduler->lock);
+        if (ret < 0) {
+            fprintf(stderr, "Failed to send timed command \"%s\"\n", event.command);
+            ++scheduler->stats.failed;
+            slot->busy = false;
+        }
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return NULL;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void scheduler_init(struct scheduler *scheduler, struct waveform_t *waveform, const unsigned int lead_ms) {
+    memset(scheduler, 0, sizeof(*scheduler));
+    pthread_mutex_init(&scheduler->lock, NULL);
+    pthread_cond_init(&scheduler->cond, NULL);
+
+    scheduler->waveform = waveform;
+    scheduler->lead_ns = (int64_t) lead_ms * 1000000LL;
+    for (size_t i = 0; i < SCHEDULER_IN_FLIGHT; ++i)
+        scheduler->slots[i].scheduler = scheduler;
+}
+
+void scheduler_destroy(struct scheduler *scheduler) {
+    pthread_cond_destroy(&scheduler->cond);
+    pthread_mutex_destroy(&scheduler->lock);
+}
+
+int scheduler_start(struct scheduler *scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    if (scheduler->running) {
+        pthread_mutex_unlock(&scheduler->lock);
+        return 0;
+    }
+    scheduler->running = true;
+    pthread_mutex_unlock(&scheduler->lock);
+
+    if (pthread_create(&scheduler->thread, NULL, scheduler_thread, scheduler) != 0) {
+        pthread_mutex_lock(&scheduler->lock);
+        scheduler->running = false;
+        pthread_mutex_unlock(&scheduler->lock);
+        return -1;
+    }
+
+    return 0;
+}
+
+void scheduler_stop(struct scheduler *scheduler) {
+    pthread_mutex_lock(&scheduler->lock);
+    if (!scheduler->running) {
+        pthread_mutex_unlock(&scheduler->lock);
+        return;
+    }
+    scheduler->running = false;
+    scheduler->count = 0;
+    atomic_store_explicit(&scheduler->depth, 0, memory_order_relaxed);
+    pthread_cond_signal(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    pthread_join(scheduler->thread, NULL);
+}
+
+int scheduler_add(struct scheduler *scheduler, const struct timespec *at, const char *format, ...) {
+    struct scheduler_event event = {.at = *at};
+
+    va_list ap;
+    va_start(ap, format);
+    const int len = vsnprintf(event.command, sizeof(event.command), format, ap);
+    va_end(ap);
+    if (len < 0 || (size_t) len >= sizeof(event.command))
+        return -1;
+
+    pthread_mutex_lock(&scheduler->lock);
+    if (scheduler->count == SCHEDULER_CAPACITY) {
+        pthread_mutex_unlock(&scheduler->lock);
+        return -1;
+    }
+
+    event.sequence = scheduler->next_sequence++;
+    ++scheduler->stats.scheduled;
+
+    size_t i = scheduler->count++;
+    atomic_store_explicit(&scheduler->depth, (unsigned int) scheduler->count, memory_order_relaxed);
+    while (i > 0) {
+        const size_t parent = (i - 1) / 2;
+        if (!scheduler_before(&event, &scheduler->heap[parent]))
+            break;
+        scheduler->heap[i] = scheduler->heap[parent];
+        i = parent;
+    }
+    scheduler->heap[i] = event;
+
+    // Only wake the thread if this is now the first thing it has to do.
+    if (i == 0)
+        pthread_cond_signal(&scheduler->cond);
+    pthread_mutex_unlock(&scheduler->lock);
+
+    return 0;
+}
+
+void scheduler_sample_time(const uint32_t ts_int, const uint64_t ts_frac, const uint32_t sample_rate,
+                           const int64_t offset, struct timespec *at) {
+    // Work in whole seconds and samples so that there is no rounding until the final conversion to nanoseconds.
+    int64_t seconds = ts_int;
+    int64_t samples = (int64_t) ts_frac + offset;
+
+    seconds += samples / sample_rate;
+    samples %= sample_rate;
+    if (samples < 0) {
+        samples += sample_rate;
+        --seconds;
+    }
+
+    at->tv_sec = (time_t) seconds;
+    at->tv_nsec = (long) ((samples * NS_PER_SEC) / sample_rate);
+}
+
+unsigned int scheduler_depth(const struct scheduler *scheduler) {
+    return atomic_load_explicit(&scheduler->depth, memory_order_relaxed);
+}
+
+void scheduler_get_stats(struct scheduler *scheduler, struct scheduler_stats *stats) {
+    pthread_mutex_lock(&scheduler->lock);
+    *stats = scheduler->stats;
+    pthread_mutex_unlock(&scheduler->lock);
+}
+
+void scheduler_dump(struct scheduler *scheduler, FILE *out) {
+    struct scheduler_stats stats;
+    scheduler_get_stats(scheduler, &stats);
+
+    fprintf(out, "Timed commands: scheduled=%" PRIu64 " submitted=%" PRIu64 " queued=%" PRIu64 " completed=%" PRIu64
+                 " failed=%" PRIu64 " late=%" PRIu64 "\n", stats.scheduled, stats.submitted, stats.queued,
+            stats.completed, stats.failed, stats.late);
+    if (stats.submitted != 0)
+        fprintf(out, "Timed command slack at submit: min=%" PRId64 "us\n", stats.submit_slack_min_ns / 1000);
+    if (stats.queued != 0)
+        fprintf(out, "Timed command slack when queued: min=%" PRId64 "us avg=%" PRId64 "us\n",
+                stats.queued_slack_min_ns / 1000, stats.queued_slack_sum_ns / (int64_t) stats.queued / 1000);
+}
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file scheduler.h
+/// @brief Scheduler for timed radio commands aligned to VITA-49 sample timestamps
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_SCHEDULER_H
+#define WAVEFORM_EXAMPLE_SCHEDULER_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most future commands that can be scheduled at once
+#define SCHEDULER_CAPACITY 64
+
+/// \brief The most commands that can have been handed to the radio and not yet completed
+#define SCHEDULER_IN_FLIGHT 16
+
+/// \brief The longest command, including its terminator
+#define SCHEDULER_COMMAND_LEN 128
+
+/// \brief The default time ahead of execution at which a command is handed to the radio
+#define SCHEDULER_DEFAULT_LEAD_MS 100
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief A command waiting in the heap
+struct scheduler_event {
+    struct timespec at;
+    uint64_t sequence;
+    char command[SCHEDULER_COMMAND_LEN];
+};
+
+struct scheduler;
+
+/// \brief A command handed to the radio and awaiting its queued and complete callbacks
+struct scheduler_slot {
+    struct scheduler *scheduler;
+    bool busy;
+    bool queued;
+    struct timespec at;
+    char command[SCHEDULER_COMMAND_LEN];
+};
+
+/// \brief Scheduler counters.  Slack is how far ahead of its execution time a command was, in nanoseconds; negative
+/// slack means the command was late.
+struct scheduler_stats {
+    uint64_t scheduled;
+    uint64_t submitted;
+    uint64_t queued;
+    uint64_t completed;
+    uint64_t failed;
+    uint64_t late;
+    int64_t submit_slack_min_ns;
+    int64_t queued_slack_min_ns;
+    int64_t queued_slack_sum_ns;
+};
+
+/// \brief A timed command scheduler for one waveform
+struct scheduler {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool running;
+    struct waveform_t *waveform;
+    int64_t lead_ns;
+    uint64_t next_sequence;
+    struct scheduler_event heap[SCHEDULER_CAPACITY];
+    size_t count;
+    struct scheduler_slot slots[SCHEDULER_IN_FLIGHT];
+    struct scheduler_stats stats;
+
+    // count, copied out from under the lock so that it can be read without taking it
+    _Atomic unsigned int depth;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a scheduler.  It does nothing until started.
+/// \param scheduler The scheduler to initialize
+/// \param waveform The waveform to send commands through
+/// \param lead_ms How long before its execution time each command is handed to the radio
+void scheduler_init(struct scheduler *scheduler, struct waveform_t *waveform, unsigned int lead_ms);
+
+/// \brief Release a scheduler.  It must be stopped and the radio's event loops must have stopped.
+/// \param scheduler The scheduler to release
+void scheduler_destroy(struct scheduler *scheduler);
+
+/// \brief Start the scheduler thread.
+/// \param scheduler The scheduler
+/// \return 0 for success otherwise a negative value if the thread could not be started
+int scheduler_start(struct scheduler *scheduler);
+
+/// \brief Stop the scheduler thread and discard every command not yet handed to the radio.  Commands already handed to
+/// the radio still complete.
+/// \param scheduler The scheduler
+void scheduler_stop(struct scheduler *scheduler);
+
+/// \brief Schedule a command to execute on the radio at a given time.
+/// \param scheduler The scheduler
+/// \param at When the radio should execute the command, on the radio's (UNIX epoch) clock
+/// \param format A printf(3) style format for the command
+/// \return 0 for success otherwise a negative value if the scheduler is full or the command is too long
+int scheduler_add(struct scheduler *scheduler, const struct timespec *at, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+/// \brief Compute the time of a sample relative to a VITA-49 packet timestamp.
+/// The radio's fractional timestamp counts samples since the top of the second, so this is exact at any sample rate.
+/// \param ts_int The integer seconds from get_packet_ts_int
+/// \param ts_frac The sample count from get_packet_ts_frac
+/// \param sample_rate The sample rate in Hz
+/// \param offset The number of samples after the packet's first sample, may be negative
+/// \param at Receives the time of that sample
+void scheduler_sample_time(uint32_t ts_int, uint64_t ts_frac, uint32_t sample_rate, int64_t offset,
+                           struct timespec *at);
+
+/// \brief Count the commands waiting to be handed to the radio.  This never takes the lock, so the data callbacks may
+/// call it.
+/// \param scheduler The scheduler
+/// \return The number of commands
+unsigned int scheduler_depth(const struct scheduler *scheduler);
+
+/// \brief Take a copy of the scheduler's counters.
+/// \param scheduler The scheduler
+/// \param stats Receives the counters
+void scheduler_get_stats(struct scheduler *scheduler, struct scheduler_stats *stats);
+
+/// \brief Print the scheduler's counters and slack.
+/// \param scheduler The scheduler
+/// \param out Where to print
+void scheduler_dump(struct scheduler *scheduler, FILE *out);
+
+#endif // WAVEFORM_EXAMPLE_SCHEDULER_H
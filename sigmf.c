@@ -0,0 +1,405 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file sigmf.c
+/// @brief Triggered SigMF recorder for the receive stream with a pre-trigger ring
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include "dsp.h"
+#include "sigmf.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000LL
+
+// How often the recorder thread looks for a finished recording
+#define SIGMF_POLL_MS 20
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Build the path of one of the files of a recording.
+/// \param recorder The recorder
+/// \param index The recording number
+/// \param extension The file extension, including the dot
+/// \param path Receives the path
+/// \param len The size of path
+/// \return 0 for success otherwise a negative value if the path is too long
+static int sigmf_path(const struct sigmf_recorder *recorder, const unsigned int index, const char *extension,
+                      char *path, const size_t len) {
+    const int ret = snprintf(path, len, "%s-%04u%s", recorder->base_path, index, extension);
+    return ret < 0 || (size_t) ret >= len ? -1 : 0;
+}
+
+/// \brief Create and map the data file for the next recording, big enough for a full recording.  The pages are
+/// populated up front so that the data callback doesn't take the faults that would otherwise fill them.
+/// \param recorder The recorder
+/// \return 0 for success otherwise a negative value with errno set
+static int sigmf_prepare(struct sigmf_recorder *recorder) {
+    char path[SIGMF_TEXT_LEN + 32];
+    if (sigmf_path(recorder, recorder->index, ".sigmf-data", path, sizeof(path)) != 0) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    recorder->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (recorder->fd == -1)
+        return -1;
+
+    const size_t bytes = recorder->map_len * sizeof(float);
+    int ret = posix_fallocate(recorder->fd, 0, (off_t) bytes);
+    if (ret != 0) {
+        close(recorder->fd);
+        unlink(path);
+        errno = ret;
+        return -1;
+    }
+
+    recorder->map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, recorder->fd, 0);
+    if (recorder->map == MAP_FAILED) {
+        const int saved_errno = errno;
+        recorder->map = NULL;
+        close(recorder->fd);
+        unlink(path);
+        errno = saved_errno;
+        return -1;
+    }
+
+    recorder->written = 0;
+    return 0;
+}
+
+/// \brief Write a string as a JSON string literal.
+/// \param out Where to write
+/// \param text The string
+static void sigmf_json_string(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const char *c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\')
+            fprintf(out, "\\%c", *c);
+        else if ((unsigned char) *c < 0x20)
+            fprintf(out, "\\u%04x", (unsigned char) *c);
+        else
+            fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+/// \brief Write the .sigmf-meta file for the recording that has just finished.  It is written to a temporary name
+/// and renamed into place so that a reader never sees a partial file.
+/// \param recorder The recorder
+/// \return 0 for success otherwise a negative value
+static int sigmf_write_meta(const struct sigmf_recorder *recorder) {
+    char path[SIGMF_TEXT_LEN + 32];
+    char tmp_path[SIGMF_TEXT_LEN + 32];
+    if (sigmf_path(recorder, recorder->index, ".sigmf-meta", path, sizeof(path)) != 0 ||
+        sigmf_path(recorder, recorder->index, ".sigmf-meta.tmp", tmp_path, sizeof(tmp_path)) != 0)
+        return -1;
+
+    FILE *out = fopen(tmp_path, "w");
+    if (out == NULL)
+        return -1;
+
+    // The packet timestamp is for the first sample after the trigger, so back up over the pre-trigger samples to get
+    // the time of the first sample in the file.
+    const uint64_t pre_samples = recorder->trigger_pre / DSP_FLOATS_PER_SAMPLE;
+    const uint64_t post_samples = recorder->written / DSP_FLOATS_PER_SAMPLE;
+    const int64_t start_ns = (int64_t) recorder->trigger_time.tv_sec * NS_PER_SEC + recorder->trigger_time.tv_nsec -
+                             (int64_t) (pre_samples * NS_PER_SEC / recorder->config.sample_rate);
+    const time_t start_sec = (time_t) (start_ns / NS_PER_SEC);
+    struct tm start_tm;
+    gmtime_r(&start_sec, &start_tm);
+    char datetime[32];
+    strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%S", &start_tm);
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"global\": {\n");
+    fprintf(out, "    \"core:datatype\": \"%s\",\n", recorder->config.complex ? "cf32_le" : "rf32_le");
+    fprintf(out, "    \"core:num_channels\": %u,\n", recorder->config.complex ? 1 : DSP_FLOATS_PER_SAMPLE);
+    fprintf(out, "    \"core:sample_rate\": %u,\n", recorder->config.sample_rate);
+    fprintf(out, "    \"core:version\": \"1.0.0\",\n");
+    fprintf(out, "    \"core:recorder\": \"waveform-example\",\n");
+    fprintf(out, "    \"core:description\": ");
+    sigmf_json_string(out, recorder->description);
+    fprintf(out, "\n  },\n");
+    fprintf(out, "  \"captures\": [\n");
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"core:sample_start\": 0,\n");
+    fprintf(out, "      \"core:datetime\": \"%s.%09lldZ\"\n", datetime, (long long) (start_ns % NS_PER_SEC));
+    fprintf(out, "    }\n");
+    fprintf(out, "  ],\n");
+    fprintf(out, "  \"annotations\": [\n");
+    fprintf(out, "    {\n");
+    fprintf(out, "      \"core:sample_start\": %llu,\n", (unsigned long long) pre_samples);
+    fprintf(out, "      \"core:sample_count\": %llu,\n", (unsigned long long) post_samples);
+    fprintf(out, "      \"core:label\": \"trigger\",\n");
+    fprintf(out, "      \"core:comment\": ");
+    sigmf_json_string(out, recorder->reason != NULL ? recorder->reason : "");
+    fprintf(out, "\n    }\n");
+    fprintf(out, "  ]\n");
+    fprintf(out, "}\n");
+
+    if (fclose(out) != 0 || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/// \brief Complete the recording that the data callback has finished, or that was cut short.  Fills in the
+/// pre-trigger samples from the ring, which the data callback leaves alone while it isn't ARMED, trims the data file
+/// to what was recorded and writes the metadata.
+/// \param recorder The recorder
+static void sigmf_finish(struct sigmf_recorder *recorder) {
+    const uint64_t first = recorder->trigger_head - recorder->trigger_pre;
+    const size_t offset = (size_t) (first % recorder->ring_len);
+    const size_t head_len = recorder->ring_len - offset < recorder->trigger_pre ? recorder->ring_len - offset
+                                                                                : recorder->trigger_pre;
+    memcpy(recorder->map, recorder->ring + offset, head_len * sizeof(float));
+    memcpy(recorder->map + head_len, recorder->ring, (recorder->trigger_pre - head_len) * sizeof(float));
+
+    const size_t used = recorder->trigger_pre + recorder->written;
+    munmap(recorder->map, recorder->map_len * sizeof(float));
+    recorder->map = NULL;
+    if (ftruncate(recorder->fd, (off_t) (used * sizeof(float))) != 0)
+        fprintf(stderr, "Unable to trim SigMF recording %u: %s\n", recorder->index, strerror(errno));
+    close(recorder->fd);
+    recorder->fd = -1;
+
+    if (sigmf_write_meta(recorder) != 0) {
+        fprintf(stderr, "Unable to write SigMF metadata for recording %u\n", recorder->index);
+    } else {
+        fprintf(stderr, "SigMF recording %s-%04u: %zu samples before and %zu after trigger \"%s\"\n",
+                recorder->base_path, recorder->index, recorder->trigger_pre / DSP_FLOATS_PER_SAMPLE,
+                recorder->written / DSP_FLOATS_PER_SAMPLE, recorder->reason);
+    }
+}
+
+/// \brief Release the prepared data file of a recorder that never used it.
+/// \param recorder The recorder
+static void sigmf_discard(struct sigmf_recorder *recorder) {
+    char path[SIGMF_TEXT_LEN + 32];
+
+    munmap(recorder->map, recorder->map_len * sizeof(float));
+    recorder->map = NULL;
+    close(recorder->fd);
+    recorder->fd = -1;
+    if (sigmf_path(recorder, recorder->index, ".sigmf-data", path, sizeof(path)) == 0)
+        unlink(path);
+}
+
+/// \brief Arm the recorder for the next trigger, with an empty ring.  Only called while the data callback is not
+/// touching the ring.
+/// \param recorder The recorder
+static void sigmf_arm(struct sigmf_recorder *recorder) {
+    recorder->ring_start = recorder->ring_head;
+    atomic_store_explicit(&recorder->trigger, NULL, memory_order_relaxed);
+    atomic_store_explicit(&recorder->state, SIGMF_ARMED, memory_order_release);
+}
+
+/// \brief The recorder thread.  Waits for the data callback to finish a recording, completes it and prepares the
+/// next data file.
+/// \param arg The struct sigmf_recorder
+/// \return Always NULL
+static void *sigmf_thread(void *arg) {
+    struct sigmf_recorder *recorder = arg;
+    const struct timespec poll = {.tv_sec = 0, .tv_nsec = SIGMF_POLL_MS * 1000000L};
+
+    while (atomic_load_explicit(&recorder->running, memory_order_relaxed)) {
+        if (atomic_load_explicit(&recorder->state, memory_order_acquire) != SIGMF_FINISHED) {
+            nanosleep(&poll, NULL);
+            continue;
+        }
+
+        sigmf_finish(recorder);
+
+        if (++recorder->index == SIGMF_MAX_RECORDINGS) {
+            fprintf(stderr, "Made %d SigMF recordings, not recording any more\n", SIGMF_MAX_RECORDINGS);
+            atomic_store_explicit(&recorder->state, SIGMF_OFF, memory_order_release);
+            break;
+        }
+
+        if (sigmf_prepare(recorder) != 0) {
+            fprintf(stderr, "Unable to prepare SigMF recording %u: %s\n", recorder->index, strerror(errno));
+            atomic_store_explicit(&recorder->state, SIGMF_OFF, memory_order_release);
+            break;
+        }
+
+        sigmf_arm(recorder);
+    }
+
+    return NULL;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+int sigmf_recorder_init(struct sigmf_recorder *recorder, const struct sigmf_config *config) {
+    memset(recorder, 0, sizeof(*recorder));
+    recorder->fd = -1;
+    recorder->config = *config;
+    recorder->index = config->first_index;
+    atomic_init(&recorder->state, SIGMF_OFF);
+    atomic_init(&recorder->trigger, NULL);
+    atomic_init(&recorder->running, false);
+    atomic_init(&recorder->triggers_ignored, 0);
+
+    if (snprintf(recorder->base_path, sizeof(recorder->base_path), "%s", config->base_path) >=
+        (int) sizeof(recorder->base_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    snprintf(recorder->description, sizeof(recorder->description), "%s",
+             config->description != NULL ? config->description : "");
+    recorder->config.base_path = recorder->base_path;
+    recorder->config.description = recorder->description;
+
+    // Keep at least one packet's worth of ring so that the arithmetic works even with no pre-trigger time.
+    const size_t floats_per_second = (size_t) config->sample_rate * DSP_FLOATS_PER_SAMPLE;
+    recorder->pre_len = config->pre_seconds * floats_per_second;
+    recorder->post_len = config->post_seconds * floats_per_second;
+    recorder->ring_len = recorder->pre_len > 0 ? recorder->pre_len : DSP_FLOATS_PER_SAMPLE;
+    recorder->map_len = recorder->pre_len + recorder->post_len;
+    if (recorder->post_len == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (recorder->index >= SIGMF_MAX_RECORDINGS) {
+        errno = ENOSPC;
+        return -1;
+    }
+
+    // Write the whole ring now, like the data file's MAP_POPULATE, so that the data callback never takes the page
+    // faults that would otherwise fill it in.  calloc alone wouldn't do, since it can hand back untouched zero pages.
+    recorder->ring = malloc(recorder->ring_len * sizeof(float));
+    if (recorder->ring == NULL)
+        return -1;
+    memset(recorder->ring, 0, recorder->ring_len * sizeof(float));
+
+    if (sigmf_prepare(recorder) != 0) {
+        const int saved_errno = errno;
+        free(recorder->ring);
+        recorder->ring = NULL;
+        errno = saved_errno;
+        return -1;
+    }
+
+    sigmf_arm(recorder);
+    atomic_store_explicit(&recorder->running, true, memory_order_relaxed);
+    const int ret = pthread_create(&recorder->thread, NULL, sigmf_thread, recorder);
+    if (ret != 0) {
+        atomic_store_explicit(&recorder->running, false, memory_order_relaxed);
+        sigmf_discard(recorder);
+        free(recorder->ring);
+        recorder->ring = NULL;
+        errno = ret;
+        return -1;
+    }
+
+    return 0;
+}
+
+void sigmf_recorder_destroy(struct sigmf_recorder *recorder) {
+    if (recorder->ring == NULL)
+        return;
+
+    atomic_store_explicit(&recorder->running, false, memory_order_relaxed);
+    pthread_join(recorder->thread, NULL);
+
+    // Keep whatever was recorded of a recording that was cut short, and throw away a file that was never used.
+    const int state = atomic_load_explicit(&recorder->state, memory_order_acquire);
+    if (state == SIGMF_RECORDING || state == SIGMF_FINISHED) {
+        sigmf_finish(recorder);
+        ++recorder->index;
+    } else if (state == SIGMF_ARMED) {
+        sigmf_discard(recorder);
+    }
+    atomic_store_explicit(&recorder->state, SIGMF_OFF, memory_order_relaxed);
+
+    free(recorder->ring);
+    recorder->ring = NULL;
+}
+
+void sigmf_recorder_trigger(struct sigmf_recorder *recorder, const char *reason) {
+    const char *expected = NULL;
+
+    if (atomic_load_explicit(&recorder->state, memory_order_relaxed) != SIGMF_ARMED ||
+        !atomic_compare_exchange_strong(&recorder->trigger, &expected, reason))
+        atomic_fetch_add_explicit(&recorder->triggers_ignored, 1, memory_order_relaxed);
+}
+
+void sigmf_recorder_write(struct sigmf_recorder *recorder, const float *samples, size_t count,
+                          const struct timespec *ts) {
+    int state = atomic_load_explicit(&recorder->state, memory_order_acquire);
+
+    if (state == SIGMF_ARMED) {
+        const char *reason = atomic_exchange_explicit(&recorder->trigger, NULL, memory_order_relaxed);
+        if (reason == NULL) {
+            // Nothing has happened yet, so just keep the most recent samples.  If the packet is bigger than the ring
+            // only its tail fits.
+            if (count > recorder->ring_len) {
+                recorder->ring_head += count - recorder->ring_len;
+                samples += count - recorder->ring_len;
+                count = recorder->ring_len;
+            }
+
+            const size_t offset = (size_t) (recorder->ring_head % recorder->ring_len);
+            const size_t head_len = recorder->ring_len - offset < count ? recorder->ring_len - offset : count;
+            memcpy(recorder->ring + offset, samples, head_len * sizeof(float));
+            memcpy(recorder->ring, samples + head_len, (count - head_len) * sizeof(float));
+            recorder->ring_head += count;
+            return;
+        }
+
+        // Triggered.  Note how much of the ring belongs to this recording; the recorder thread copies it into the
+        // front of the file once we are done, and everything from this packet on goes straight in after it.
+        const uint64_t available = recorder->ring_head - recorder->ring_start;
+        recorder->reason = reason;
+        recorder->trigger_head = recorder->ring_head;
+        recorder->trigger_pre = (size_t) (available < recorder->pre_len ? available : recorder->pre_len);
+        recorder->trigger_time = *ts;
+        recorder->written = 0;
+        state = SIGMF_RECORDING;
+        atomic_store_explicit(&recorder->state, state, memory_order_relaxed);
+    }
+
+    if (state == SIGMF_RECORDING) {
+        const size_t room = recorder->post_len - recorder->written;
+        const size_t n = count < room ? count : room;
+        memcpy(recorder->map + recorder->trigger_pre + recorder->written, samples, n * sizeof(float));
+        recorder->written += n;
+
+        if (recorder->written == recorder->post_len)
+            atomic_store_explicit(&recorder->state, SIGMF_FINISHED, memory_order_release);
+    }
+}
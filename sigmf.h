@@ -0,0 +1,146 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file sigmf.h
+/// @brief Triggered SigMF recorder for the receive stream with a pre-trigger ring
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_SIGMF_H
+#define WAVEFORM_EXAMPLE_SIGMF_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The default seconds of samples kept from before a trigger
+#define SIGMF_DEFAULT_PRE_SECONDS 5
+
+/// \brief The default seconds of samples recorded after a trigger
+#define SIGMF_DEFAULT_POST_SECONDS 10
+
+/// \brief The most recordings made before the recorder switches itself off, so that a trigger that keeps firing can't
+/// fill the disk
+#define SIGMF_MAX_RECORDINGS 16
+
+/// \brief The longest description or path, including its terminator
+#define SIGMF_TEXT_LEN 256
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Where the recorder is in its cycle.  Only the data callback moves ARMED to RECORDING and RECORDING to
+/// FINISHED; only the recorder thread moves FINISHED back to ARMED or to OFF.
+enum sigmf_state {
+    SIGMF_OFF,
+    SIGMF_ARMED,
+    SIGMF_RECORDING,
+    SIGMF_FINISHED,
+};
+
+/// \brief What to record and how to describe it
+struct sigmf_config {
+    const char *base_path;      ///< Recordings are <base_path>-NNNN.sigmf-data and .sigmf-meta
+    uint32_t sample_rate;       ///< Sample rate in Hz
+    bool complex;               ///< true for I/Q pairs (RAW mode), false for two interleaved real channels
+    const char *description;    ///< Free text for core:description, e.g. the waveform name and mode
+    unsigned int pre_seconds;   ///< Seconds kept from before a trigger
+    unsigned int post_seconds;  ///< Seconds recorded after a trigger
+    unsigned int first_index;   ///< The number of the first recording, so that a recreated recorder carries on counting
+};
+
+/// \brief A triggered recorder.  The data callback feeds it with sigmf_recorder_write, which only ever copies samples
+/// into memory.  Everything that needs a system call, from creating and mapping the next file to writing the metadata,
+/// happens on the recorder's own thread.
+struct sigmf_recorder {
+    struct sigmf_config config;
+    char base_path[SIGMF_TEXT_LEN];
+    char description[SIGMF_TEXT_LEN];
+    _Atomic int state;
+
+    // The pre-trigger ring, written only by the data callback while ARMED.  ring_head counts every float ever written;
+    // ring_start is where the ring was last cleared, so that a recording never includes pre-trigger samples from
+    // before the previous one.
+    float *ring;
+    size_t ring_len;
+    uint64_t ring_head;
+    uint64_t ring_start;
+
+    // The current data file, created and mapped ahead of time by the recorder thread.  The pre-trigger samples go at
+    // the front and the samples after the trigger follow them.
+    int fd;
+    float *map;
+    size_t map_len;
+    size_t pre_len;
+    size_t post_len;
+    size_t written;
+    unsigned int index;
+
+    // The reason for a trigger not yet picked up by the data callback, or NULL
+    const char *_Atomic trigger;
+
+    // Filled in by the data callback when it picks up a trigger
+    const char *reason;
+    uint64_t trigger_head;
+    size_t trigger_pre;
+    struct timespec trigger_time;
+
+    pthread_t thread;
+    _Atomic bool running;
+    _Atomic uint64_t triggers_ignored;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Create a recorder, allocate its ring, prepare the first data file and start its thread.
+/// \param recorder The recorder to initialize
+/// \param config What to record; the strings are copied
+/// \return 0 for success otherwise a negative value with errno set, ENOSPC if first_index has reached
+/// SIGMF_MAX_RECORDINGS
+int sigmf_recorder_init(struct sigmf_recorder *recorder, const struct sigmf_config *config);
+
+/// \brief Stop the recorder thread, finish any recording in progress and release everything.  No data callback may be
+/// running.  Afterwards index is the number for the next recording, to pass as first_index to a new recorder.
+/// \param recorder The recorder
+void sigmf_recorder_destroy(struct sigmf_recorder *recorder);
+
+/// \brief Ask for a recording.  It starts with the next packet, includes up to pre_seconds from before it, and is
+/// ignored if a recording is already in progress.  This may be called from any thread.
+/// \param recorder The recorder
+/// \param reason Why, for the recording's annotation.  This must be a string literal or otherwise never freed.
+void sigmf_recorder_trigger(struct sigmf_recorder *recorder, const char *reason);
+
+/// \brief Feed samples to the recorder.  This must only be called from the data callback.  It never blocks and never
+/// makes a system call.
+/// \param recorder The recorder
+/// \param samples The samples from the packet
+/// \param count The number of floats in samples
+/// \param ts The timestamp of the first sample, from get_packet_ts
+void sigmf_recorder_write(struct sigmf_recorder *recorder, const float *samples, size_t count,
+                          const struct timespec *ts);
+
+#endif // WAVEFORM_EXAMPLE_SIGMF_H
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file simd.h
+/// @brief Short vectors for the DSP stages
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+/// The stages that work on whole packets do so four values at a time, and the Viterbi decoder eight, with the
+/// compiler's generic vectors, which become SSE on x86 and NEON on the radio's ARM core without any intrinsics of
+/// either.  Loads and stores go through memcpy so that no buffer has to be aligned; the compiler makes them single
+/// unaligned vector moves.  Vectors are kept to 16 bytes or less, which both have registers for.
+
+#ifndef WAVEFORM_EXAMPLE_SIMD_H
+#define WAVEFORM_EXAMPLE_SIMD_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdint.h>
+#include <string.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The values in a vector
+#define SIMD_LANES 4
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Four floats
+typedef float simd_v4f __attribute__((vector_size(16)));
+
+/// \brief Four 32 bit integers, which is also what comparing or shuffling four floats takes
+typedef int32_t simd_v4i __attribute__((vector_size(16)));
+
+/// \brief Four 16 bit integers, such as Q15 values
+typedef int16_t simd_v4i16 __attribute__((vector_size(8)));
+
+/// \brief Eight unsigned 16 bit integers, such as path metrics
+typedef uint16_t simd_v8u16 __attribute__((vector_size(16)));
+
+/// \brief Eight 16 bit integers, which is what comparing eight unsigned ones gives
+typedef int16_t simd_v8i16 __attribute__((vector_size(16)));
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Load four floats, aligned or not
+static inline simd_v4f simd_load(const float *p) {
+    simd_v4f v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/// \brief Store four floats, aligned or not
+static inline void simd_store(float *p, const simd_v4f v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/// \brief Load four 16 bit integers, aligned or not
+static inline simd_v4i16 simd_load_i16(const int16_t *p) {
+    simd_v4i16 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/// \brief Store four 16 bit integers, aligned or not
+static inline void simd_store_i16(int16_t *p, const simd_v4i16 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+#endif // WAVEFORM_EXAMPLE_SIMD_H
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file slice_state.c
+/// @brief Incrementally updated cache of the radio's slice status
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "kwargs.h"
+#include "perfect_hash.h"
+#include "slice_fields_hash.h"
+#include "slice_state.h"
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+// A row of the field table, in the same order as slice_state.def
+struct slice_field_descriptor {
+    const char *key;
+    enum slice_field_parser parser;
+};
+
+// ****************************************
+// Static Variables
+// ****************************************
+static const struct slice_field_descriptor slice_fields[SLICE_FIELD_COUNT] = {
+#define SLICE_FIELD(key, name, parser) {#key, SLICE_PARSE_##parser},
+#include "slice_state.def"
+#undef SLICE_FIELD
+};
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Look up a status keyword.
+/// \param kwarg The keyword argument whose key to look up
+/// \return The field or -1 if we don't track this keyword
+static int slice_field_lookup(const struct kwarg *kwarg) {
+    const int index = slice_fields_hash_slots[perfect_hash_slot(SLICE_FIELDS_HASH_SEED, SLICE_FIELDS_HASH_BITS,
+                                                                kwarg->key, kwarg->key_len)];
+    if (index < 0 || !kwarg_is(kwarg, slice_fields[index].key))
+        return -1;
+
+    return index;
+}
+
+/// \brief Parse a frequency in MHz into integer Hz without going through floating point, so that equal frequencies
+/// always compare equal and no change is reported for a frequency that hasn't moved.
+/// \param text The frequency, e.g. "14.074000"
+/// \param hz The frequency in Hz
+/// \return true if the frequency was valid
+static bool slice_parse_frequency(const char *text, int64_t *hz) {
+    int64_t whole = 0;
+    int64_t frac = 0;
+    int frac_digits = 0;
+    const char *p = text;
+
+    if (*p < '0' || *p > '9')
+        return false;
+
+    for (; *p >= '0' && *p <= '9'; ++p)
+        whole = whole * 10 + (*p - '0');
+
+    if (*p == '.') {
+        for (++p; *p >= '0' && *p <= '9'; ++p) {
+            if (frac_digits < 6) {
+                frac = frac * 10 + (*p - '0');
+                ++frac_digits;
+            }
+        }
+    }
+
+    if (*p != '\0')
+        return false;
+
+    for (; frac_digits < 6; ++frac_digits)
+        frac *= 10;
+
+    *hz = whole * 1000000 + frac;
+    return true;
+}
+
+/// \brief Parse the text of a field into its stored value.
+/// \param parser How to parse the text
+/// \param text The NUL terminated value text
+/// \param value The parsed value
+/// \return true if the text was valid
+static bool slice_parse_value(const enum slice_field_parser parser, const char *text, int64_t *value) {
+    char *end;
+
+    switch (parser) {
+        case SLICE_PARSE_FREQUENCY:
+            return slice_parse_frequency(text, value);
+        case SLICE_PARSE_MODE: {
+            const size_t len = strlen(text);
+            if (len > sizeof(*value))
+                return false;
+            *value = 0;
+            memcpy(value, text, len);
+            return true;
+        }
+        case SLICE_PARSE_INT:
+            errno = 0;
+            *value = strtoll(text, &end, 10);
+            return errno == 0 && *end == '\0' && end != text;
+        case SLICE_PARSE_BOOL:
+            if ((text[0] != '0' && text[0] != '1') || text[1] != '\0')
+                return false;
+            *value = text[0] - '0';
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void slice_state_init(struct slice_state_table *table, const slice_state_cb_t notify, void *arg) {
+    for (unsigned int slice = 0; slice < SLICE_STATE_MAX_SLICES; ++slice) {
+        for (unsigned int field = 0; field < SLICE_FIELD_COUNT; ++field)
+            atomic_init(&table->values[slice][field], 0);
+        atomic_init(&table->known[slice], 0);
+    }
+
+    table->notify = notify;
+    table->notify_arg = arg;
+}
+
+int slice_state_status_cb(struct waveform_t *waveform __attribute__((unused)), const unsigned int argc, char *argv[],
+                          void *arg) {
+    struct slice_state_table *table = arg;
+
+    if (argc < 2)
+        return -1;
+
+    char *end;
+    const unsigned long slice = strtoul(argv[1], &end, 10);
+    if (*end != '\0' || end == argv[1] || slice >= SLICE_STATE_MAX_SLICES)
+        return -1;
+
+    // Walk the keywords once.  Anything we don't track is skipped after a single hash, and fields whose value hasn't
+    // changed are neither stored nor reported.
+    uint32_t changed = 0;
+    uint32_t known = atomic_load_explicit(&table->known[slice], memory_order_relaxed);
+    for (unsigned int i = 2; i < argc; ++i) {
+        struct kwarg kwarg;
+        if (!kwarg_split(argv[i], &kwarg))
+            continue;
+
+        const int field = slice_field_lookup(&kwarg);
+        if (field < 0)
+            continue;
+
+        int64_t value;
+        if (!slice_parse_value(slice_fields[field].parser, kwarg.value, &value))
+            continue;
+
+        const bool was_known = (known & SLICE_FIELD_BIT(field)) != 0;
+        if (was_known && atomic_load_explicit(&table->values[slice][field], memory_order_relaxed) == value)
+            continue;
+
+        atomic_store_explicit(&table->values[slice][field], value, memory_order_relaxed);
+        known |= SLICE_FIELD_BIT(field);
+        changed |= SLICE_FIELD_BIT(field);
+    }
+
+    if (changed == 0)
+        return 0;
+
+    atomic_store_explicit(&table->known[slice], known, memory_order_release);
+    if (table->notify != NULL)
+        table->notify(table, (unsigned int) slice, changed, table->notify_arg);
+
+    return 0;
+}
+
+void slice_state_mode(const struct slice_state_table *table, const unsigned int slice, char mode[9]) {
+    const int64_t value = slice_state_get(table, slice, SLICE_FIELD_MODE);
+    memcpy(mode, &value, sizeof(value));
+    mode[8] = '\0';
+}
+
+const char *slice_state_field_name(const enum slice_field field) {
+    return field < SLICE_FIELD_COUNT ? slice_fields[field].key : NULL;
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file slice_state.h
+/// @brief Incrementally updated cache of the radio's slice status
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_SLICE_STATE_H
+#define WAVEFORM_EXAMPLE_SLICE_STATE_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdint.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The number of slices tracked.  The largest radios have eight.
+#define SLICE_STATE_MAX_SLICES 8
+
+/// \brief The changed-field bit for a field in the notification mask
+#define SLICE_FIELD_BIT(field) (1U << (field))
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The fields tracked for each slice, one per entry in slice_state.def
+enum slice_field {
+#define SLICE_FIELD(key, name, parser) SLICE_FIELD_##name,
+#include "slice_state.def"
+#undef SLICE_FIELD
+    SLICE_FIELD_COUNT
+};
+
+/// \brief How the text of each field is turned into its stored value
+enum slice_field_parser {
+    SLICE_PARSE_FREQUENCY, ///< MHz with up to six decimals, stored as integer Hz
+    SLICE_PARSE_MODE,      ///< Mode name of up to eight characters, stored packed into the value
+    SLICE_PARSE_INT,       ///< Signed decimal integer
+    SLICE_PARSE_BOOL       ///< 0 or 1
+};
+
+struct slice_state_table;
+
+/// \brief Called after a status message has been applied, only if at least one field actually changed.
+/// \param table The table that was updated
+/// \param slice The slice whose fields changed
+/// \param changed A mask of SLICE_FIELD_BIT() for the fields that changed
+/// \param arg The argument given to slice_state_init
+typedef void (*slice_state_cb_t)(const struct slice_state_table *table, unsigned int slice, uint32_t changed,
+                                 void *arg);
+
+/// \brief The cached state of every slice.  The status callback is the only writer; any thread may read.  Each field
+/// is individually atomic so a read is a single load, but two fields read one after the other may come from different
+/// status messages.
+struct slice_state_table {
+    _Atomic int64_t values[SLICE_STATE_MAX_SLICES][SLICE_FIELD_COUNT];
+    _Atomic uint32_t known[SLICE_STATE_MAX_SLICES];
+    slice_state_cb_t notify;
+    void *notify_arg;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a slice state table.
+/// \param table The table to initialize
+/// \param notify Callback for changed fields, or NULL
+/// \param arg Argument passed to the callback
+void slice_state_init(struct slice_state_table *table, slice_state_cb_t notify, void *arg);
+
+/// \brief The "slice" status callback.  Register this with waveform_register_status_cb with the table as its argument.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the status
+/// \param argv The arguments in the status, e.g. "slice" "0" "RF_frequency=14.074000" "mode=DIGU" ...
+/// \param arg The struct slice_state_table to update
+/// \return 0 for success otherwise a negative value on error
+int slice_state_status_cb(struct waveform_t *waveform, unsigned int argc, char *argv[], void *arg);
+
+/// \brief Read a field of a slice.
+/// \param table The table to read from
+/// \param slice The slice number
+/// \param field The field to read
+/// \return The value, or 0 if the radio has not told us about this field yet
+static inline int64_t slice_state_get(const struct slice_state_table *table, const unsigned int slice,
+                                      const enum slice_field field) {
+    return atomic_load_explicit(&((struct slice_state_table *) table)->values[slice][field], memory_order_relaxed);
+}
+
+/// \brief Check whether the radio has reported a field of a slice yet.
+/// \param table The table to read from
+/// \param slice The slice number
+/// \param field The field to check
+/// \return Non-zero if the field has been reported
+static inline int slice_state_known(const struct slice_state_table *table, const unsigned int slice,
+                                    const enum slice_field field) {
+    return (atomic_load_explicit(&((struct slice_state_table *) table)->known[slice], memory_order_relaxed) &
+            SLICE_FIELD_BIT(field)) != 0;
+}
+
+/// \brief Get the mode of a slice as a string.
+/// \param table The table to read from
+/// \param slice The slice number
+/// \param mode A buffer of at least nine characters to receive the NUL terminated mode name
+void slice_state_mode(const struct slice_state_table *table, unsigned int slice, char mode[9]);
+
+/// \brief Get the status keyword of a field
+/// \param field The field
+/// \return The keyword as it appears in the radio's status, e.g. "RF_frequency"
+const char *slice_state_field_name(enum slice_field field);
+
+#endif // WAVEFORM_EXAMPLE_SLICE_STATE_H
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file subscriptions.c
+/// @brief Declarative status subscriptions with early filtering and per-subscription message rates
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "subscriptions.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000ULL
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read the monotonic clock in nanoseconds
+/// \return The current value of CLOCK_MONOTONIC
+static uint64_t subscriptions_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * NS_PER_SEC + (uint64_t) now.tv_nsec;
+}
+
+/// \brief The status callback registered for every interest.  Counts the message, applies the filter and hands it on
+/// to the interest's handler.  Status callbacks run one at a time on the library's regular workqueue, so the rate
+/// window is only ever touched by one thread.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param argc The number of arguments in the status
+/// \param argv The arguments in the status
+/// \param arg The struct subscription_entry for this interest
+/// \return The handler's return value, or 0 if the message was dropped
+static int subscriptions_dispatch(struct waveform_t *waveform, const unsigned int argc, char *argv[], void *arg) {
+    struct subscription_entry *entry = arg;
+    const struct subscription_interest *interest = entry->interest;
+
+    atomic_fetch_add_explicit(&entry->received, 1, memory_order_relaxed);
+
+    // Close out the rate window once a second.  This costs one clock read per message, which is far cheaper than
+    // anything the handler is going to do with it.
+    const uint64_t now = subscriptions_now_ns();
+    ++entry->window_count;
+    if (now - entry->window_start_ns >= NS_PER_SEC) {
+        const uint32_t rate = (uint32_t) ((entry->window_count * NS_PER_SEC) / (now - entry->window_start_ns));
+        atomic_store_explicit(&entry->rate, rate, memory_order_relaxed);
+        if (interest->max_rate != 0 && rate > interest->max_rate) {
+            fprintf(stderr, "Subscription %s is flooding: %u messages/s\n", interest->status, rate);
+        }
+        entry->window_start_ns = now;
+        entry->window_count = 0;
+    }
+
+    if (interest->filter != NULL && !interest->filter(argc, argv)) {
+        atomic_fetch_add_explicit(&entry->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    return interest->handler(waveform, argc, argv, NULL);
+}
+
+/// \brief Response callback for the subscribe commands.  We only need to hear about failures.
+/// \param waveform A pointer to the opaque waveform structure returned by waveform_create
+/// \param code The numeric error code returned from the command.  0 is success, anything else is a failure
+/// \param message The descriptive message returned from the radio
+/// \param arg The struct subscription_entry the command was sent for
+static void subscriptions_response(struct waveform_t *waveform __attribute__((unused)), const unsigned int code,
+                                   const char *message, void *arg) {
+    const struct subscription_entry *entry = arg;
+
+    if (code != 0) {
+        fprintf(stderr, "Subscribing with \"%s\" failed with code %08x: %s\n", entry->interest->command, code,
+                message);
+    }
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+int subscriptions_init(struct subscription_manager *manager, const struct subscription_interest *interests,
+                       const size_t count) {
+    if (count > SUBSCRIPTIONS_MAX)
+        return -1;
+
+    memset(manager, 0, sizeof(*manager));
+    manager->count = count;
+
+    const uint64_t now = subscriptions_now_ns();
+    for (size_t i = 0; i < count; ++i) {
+        struct subscription_entry *entry = &manager->entries[i];
+        entry->interest = &interests[i];
+        atomic_init(&entry->received, 0);
+        atomic_init(&entry->dropped, 0);
+        atomic_init(&entry->rate, 0);
+        entry->window_start_ns = now;
+    }
+
+    return 0;
+}
+
+int subscriptions_register(struct subscription_manager *manager, struct waveform_t *waveform) {
+    int ret = 0;
+
+    for (size_t i = 0; i < manager->count; ++i) {
+        struct subscription_entry *entry = &manager->entries[i];
+        if (waveform_register_status_cb(waveform, entry->interest->status, subscriptions_dispatch, entry) == -1) {
+            fprintf(stderr, "Failed to register status callback for %s\n", entry->interest->status);
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+void subscriptions_send(struct subscription_manager *manager, struct waveform_t *waveform) {
+    for (size_t i = 0; i < manager->count; ++i) {
+        struct subscription_entry *entry = &manager->entries[i];
+        if (entry->interest->command != NULL)
+            waveform_send_api_command_cb(waveform, subscriptions_response, entry, "%s", entry->interest->command);
+    }
+}
+
+void subscriptions_dump(const struct subscription_manager *manager, FILE *out) {
+    for (size_t i = 0; i < manager->count; ++i) {
+        struct subscription_entry *entry = (struct subscription_entry *) &manager->entries[i];
+        fprintf(out, "%-12s received=%" PRIu64 " dropped=%" PRIu64 " rate=%u/s\n", entry->interest->status,
+                atomic_load_explicit(&entry->received, memory_order_relaxed),
+                atomic_load_explicit(&entry->dropped, memory_order_relaxed),
+                atomic_load_explicit(&entry->rate, memory_order_relaxed));
+    }
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file subscriptions.h
+/// @brief Declarative status subscriptions with early filtering and per-subscription message rates
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_SUBSCRIPTIONS_H
+#define WAVEFORM_EXAMPLE_SUBSCRIPTIONS_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief The most subscriptions a single manager handles
+#define SUBSCRIPTIONS_MAX 8
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief Decide whether a status message is of interest.  Runs before the handler and before anything is formatted,
+/// so it should look at as little as possible.
+/// \param argc The number of arguments in the status
+/// \param argv The arguments in the status
+/// \return true to deliver the message to the handler, false to drop it
+typedef bool (*subscription_filter_t)(unsigned int argc, char *argv[]);
+
+/// \brief A status the waveform is interested in
+struct subscription_interest {
+    const char *status;            ///< The status name to register for, e.g. "slice"
+    const char *command;           ///< The subscribe command to send, e.g. "sub slice all"
+    subscription_filter_t filter;  ///< Optional filter, NULL to deliver everything
+    waveform_cmd_cb_t handler;     ///< Called for each delivered message with a NULL argument
+    uint32_t max_rate;             ///< Messages per second above which we warn about flooding, 0 for no limit
+};
+
+/// \brief Per-subscription state and counters
+struct subscription_entry {
+    const struct subscription_interest *interest;
+    _Atomic uint64_t received;
+    _Atomic uint64_t dropped;
+    _Atomic uint32_t rate;
+    uint64_t window_start_ns;
+    uint32_t window_count;
+};
+
+/// \brief The set of subscriptions for one waveform
+struct subscription_manager {
+    struct subscription_entry entries[SUBSCRIPTIONS_MAX];
+    size_t count;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Initialize a manager with a list of interests.
+/// \param manager The manager to initialize
+/// \param interests The interests.  Must stay valid for the life of the manager.
+/// \param count The number of interests; at most SUBSCRIPTIONS_MAX
+/// \return 0 for success otherwise a negative value if there are too many interests
+int subscriptions_init(struct subscription_manager *manager, const struct subscription_interest *interests,
+                       size_t count);
+
+/// \brief Register a status callback for every interest.  Must be called before waveform_radio_start.
+/// \param manager The manager
+/// \param waveform The waveform to register with
+/// \return 0 for success otherwise a negative value if any registration failed
+int subscriptions_register(struct subscription_manager *manager, struct waveform_t *waveform);
+
+/// \brief Send the subscribe command for every interest.  Must be called after waveform_radio_start, once per
+/// connection.
+/// \param manager The manager
+/// \param waveform The waveform to send the commands through
+void subscriptions_send(struct subscription_manager *manager, struct waveform_t *waveform);
+
+/// \brief Print the message counts and rates of every subscription.
+/// \param manager The manager
+/// \param out Where to print
+void subscriptions_dump(const struct subscription_manager *manager, FILE *out);
+
+#endif // WAVEFORM_EXAMPLE_SUBSCRIPTIONS_H
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file telemetry.c
+/// @brief Operational meters describing the waveform's own load
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+#include "dsp.h"
+#include "telemetry.h"
+
+// ****************************************
+// Macros
+// ****************************************
+#define NS_PER_SEC 1000000000LL
+
+// VITA-49 packet counts are four bits
+#define TELEMETRY_COUNT_MASK 0x0f
+
+// ****************************************
+// Static Variables
+// ****************************************
+
+// CPU time is per thread, so the starting point for the data callback thread's share is kept per thread as well.  If
+// the library moves us to another thread the first window there just reads zero.
+static __thread int64_t telemetry_thread_cpu_ns;
+static __thread int64_t telemetry_thread_wall_ns;
+
+// ****************************************
+// Static Functions
+// ****************************************
+
+/// \brief Read a CPU time clock in nanoseconds
+/// \param clock CLOCK_PROCESS_CPUTIME_ID or CLOCK_THREAD_CPUTIME_ID
+/// \return The CPU time used
+static int64_t telemetry_cpu_ns(const clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (int64_t) now.tv_sec * NS_PER_SEC + now.tv_nsec;
+}
+
+/// \brief Finish a window: work out the shares and start the next one.  This is where the system calls are, twice a
+/// second.
+/// \param telemetry The measurements
+/// \param now_ns The current time
+static void telemetry_close_window(struct telemetry *telemetry, const int64_t now_ns) {
+    static long cpus;
+    if (cpus == 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cpus < 1)
+            cpus = 1;
+    }
+
+    const int64_t wall_ns = now_ns - telemetry->window_start_ns;
+    const int64_t process_cpu_ns = telemetry_cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+    telemetry->cpu = 100.0F * (float) (process_cpu_ns - telemetry->process_cpu_start_ns) / (float) wall_ns /
+                     (float) cpus;
+    telemetry->process_cpu_start_ns = process_cpu_ns;
+
+    const int64_t thread_cpu_ns = telemetry_cpu_ns(CLOCK_THREAD_CPUTIME_ID);
+    telemetry->dsp_cpu = telemetry_thread_wall_ns == 0 ? 0.0F
+                         : 100.0F * (float) (thread_cpu_ns - telemetry_thread_cpu_ns) /
+                           (float) (now_ns - telemetry_thread_wall_ns);
+    telemetry_thread_cpu_ns = thread_cpu_ns;
+    telemetry_thread_wall_ns = now_ns;
+
+    // Both streams flow while transmitting, each with its own callback, so measure against whichever carried more.
+    uint64_t samples = 0;
+    for (int i = 0; i < TELEMETRY_STREAMS; ++i) {
+        if (telemetry->stream_samples[i] > samples)
+            samples = telemetry->stream_samples[i];
+        telemetry->stream_samples[i] = 0;
+    }
+    const double stream_ns = telemetry->sample_rate == 0 ? 0.0
+                             : (double) samples / DSP_FLOATS_PER_SAMPLE * NS_PER_SEC / telemetry->sample_rate;
+    telemetry->duty = stream_ns > 0.0 ? (float) (100.0 * (double) telemetry->busy_ns / stream_ns) : 0.0F;
+    telemetry->busy_ns = 0;
+
+    telemetry->window_start_ns = now_ns;
+}
+
+// ****************************************
+// Global Functions
+// ****************************************
+void telemetry_init(struct telemetry *telemetry, const uint32_t sample_rate) {
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->sample_rate = sample_rate;
+    telemetry->window_start_ns = telemetry_now_ns();
+    telemetry->process_cpu_start_ns = telemetry_cpu_ns(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+bool telemetry_packet(struct telemetry *telemetry, const enum telemetry_stream stream,
+                      const struct waveform_vita_packet *packet, const int64_t start_ns, const int64_t now_ns) {
+    telemetry->busy_ns += now_ns - start_ns;
+    telemetry->stream_samples[stream] += get_packet_len(packet);
+
+    // Every packet bumps the stream's count, so a jump means the ones in between never reached us.
+    const uint8_t count = get_packet_count(packet) & TELEMETRY_COUNT_MASK;
+    if (telemetry->seen[stream])
+        telemetry->drops += (uint8_t) (count - telemetry->last_count[stream] - 1) & TELEMETRY_COUNT_MASK;
+    telemetry->last_count[stream] = count;
+    telemetry->seen[stream] = true;
+
+    if (now_ns - telemetry->window_start_ns < TELEMETRY_WINDOW_NS)
+        return false;
+
+    telemetry_close_window(telemetry, now_ns);
+    return true;
+}
+
+void telemetry_publish(const struct telemetry *telemetry, struct waveform_t *waveform,
+                       const unsigned int api_queue_depth, const unsigned int scheduler_depth) {
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_CPU, telemetry->cpu);
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_DSP_CPU, telemetry->dsp_cpu);
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_DUTY, telemetry->duty);
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_API_QUEUE, (float) api_queue_depth);
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_SCHED_QUEUE, (float) scheduler_depth);
+    waveform_meter_set_float_value(waveform, TELEMETRY_METER_DROPS, (float) telemetry->drops);
+}
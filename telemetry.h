@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: LGPL-3.0-or-later
+/// @file telemetry.h
+/// @brief Operational meters describing the waveform's own load
+///
+/// @copyright Copyright (c) 2026 FlexRadio Systems
+///
+/// This program is free software: you can redistribute it and/or modify
+/// it under the terms of the GNU Lesser General Public License as published by
+/// the Free Software Foundation, version 3.
+///
+/// This program is distributed in the hope that it will be useful, but
+/// WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+/// Lesser General Public License for more details.
+///
+/// You should have received a copy of the GNU Lesser General Public License
+/// along with this program. If not, see <http://www.gnu.org/licenses/>.
+///
+
+#ifndef WAVEFORM_EXAMPLE_TELEMETRY_H
+#define WAVEFORM_EXAMPLE_TELEMETRY_H
+
+// ****************************************
+// System Includes
+// ****************************************
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// ****************************************
+// Project Includes
+// ****************************************
+#include <waveform/waveform_api.h>
+
+// ****************************************
+// Macros
+// ****************************************
+
+/// \brief How often the meters are updated, in nanoseconds
+#define TELEMETRY_WINDOW_NS 500000000LL
+
+// The meter names, for the meter table in main.c.  CPU and duty cycle are in PERCENT; the rest are plain counts.
+#define TELEMETRY_METER_CPU "junk-cpu"              ///< The whole process, as a share of all CPUs
+#define TELEMETRY_METER_DSP_CPU "junk-dsp-cpu"      ///< The data callback thread, as a share of one CPU
+#define TELEMETRY_METER_DUTY "junk-duty"            ///< Time in the data callbacks as a share of the packets' duration
+#define TELEMETRY_METER_API_QUEUE "junk-api-queue"  ///< Radio commands waiting or awaiting a response
+#define TELEMETRY_METER_SCHED_QUEUE "junk-sched-queue" ///< Timed commands waiting to be handed to the radio
+#define TELEMETRY_METER_DROPS "junk-drops"          ///< Packets missing from the incoming streams since we connected
+
+// ****************************************
+// Structs, Enums, typedefs
+// ****************************************
+
+/// \brief The incoming streams, each with its own packet counter
+enum telemetry_stream {
+    TELEMETRY_RX,
+    TELEMETRY_TX,
+    TELEMETRY_STREAMS
+};
+
+/// \brief The measurements.  Only ever touched by the data callbacks, which the library runs one at a time.
+struct telemetry {
+    uint32_t sample_rate;
+    int64_t window_start_ns;
+    int64_t process_cpu_start_ns;
+    int64_t busy_ns;                            ///< Time spent in the data callbacks this window
+    uint64_t stream_samples[TELEMETRY_STREAMS]; ///< Floats delivered on each stream this window
+    uint8_t last_count[TELEMETRY_STREAMS];
+    bool seen[TELEMETRY_STREAMS];
+    uint64_t drops;
+
+    // The values from the last complete window
+    float cpu;
+    float dsp_cpu;
+    float duty;
+};
+
+// ****************************************
+// Global Functions
+// ****************************************
+
+/// \brief Start measuring.
+/// \param telemetry The measurements to initialize
+/// \param sample_rate The stream sample rate in Hz
+void telemetry_init(struct telemetry *telemetry, uint32_t sample_rate);
+
+/// \brief Read the monotonic clock, for timing a data callback.  This is a vDSO call, not a system call.
+/// \return The current value of CLOCK_MONOTONIC in nanoseconds
+static inline int64_t telemetry_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/// \brief Account for a packet once its data callback is done with it.
+/// \param telemetry The measurements
+/// \param stream Which stream the packet came in on
+/// \param packet The packet
+/// \param start_ns telemetry_now_ns from when the callback started
+/// \param now_ns telemetry_now_ns from when it finished
+/// \return true if a window has just finished and the meters should be published
+bool telemetry_packet(struct telemetry *telemetry, enum telemetry_stream stream,
+                      const struct waveform_vita_packet *packet, int64_t start_ns, int64_t now_ns);
+
+/// \brief Set the meters from the window that has just finished.  The caller sends them.
+/// \param telemetry The measurements
+/// \param waveform The waveform whose meters to set
+/// \param api_queue_depth Radio commands waiting or awaiting a response
+/// \param scheduler_depth Timed commands waiting to be handed to the radio
+void telemetry_publish(const struct telemetry *telemetry, struct waveform_t *waveform, unsigned int api_queue_depth,
+                       unsigned int scheduler_depth);
+
+#endif // WAVEFORM_EXAMPLE_TELEMETRY_H
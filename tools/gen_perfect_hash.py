@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: LGPL-3.0-or-later
+#
+# Generate a perfect hash for the keys of an X-macro list.
+#
+# Copyright (c) 2026 FlexRadio Systems
+#
+# Every line of the input of the form MACRO(name, ...) contributes the key "name", numbered in the order it appears.
+# We search for an FNV-1a seed for which the top bits of the hash are distinct for every key and write a header with
+# that seed and a slot table mapping each hash slot to the key's index (or -1).  perfect_hash_slot() in
+# perfect_hash.h must hash exactly as fnv1a() below does.
+
+import argparse
+import os
+import re
+import sys
+
+
+def fnv1a(seed, key):
+    h = seed
+    for byte in key.encode('ascii'):
+        h ^= byte
+        h = (h * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate a perfect hash for the keys of an X-macro list')
+    parser.add_argument('--input', required=True, help='X-macro list to read the keys from')
+    parser.add_argument('--macro', required=True, help='Name of the macro whose first argument is the key')
+    parser.add_argument('--prefix', required=True, help='Prefix for the generated identifiers')
+    parser.add_argument('--output', required=True, help='Header file to write')
+    args = parser.parse_args()
+
+    pattern = re.compile(r'^\s*' + re.escape(args.macro) + r'\(\s*(\w+)\s*,')
+    with open(args.input) as f:
+        keys = [m.group(1) for m in (pattern.match(line) for line in f) if m]
+
+    if not keys:
+        sys.exit(f'{args.input}: no {args.macro}() entries found')
+    if len(set(keys)) != len(keys):
+        sys.exit(f'{args.input}: duplicate {args.macro}() entries')
+
+    # Load factor of at most one half keeps the seed search short and the table tiny.
+    bits = max(1, (2 * len(keys) - 1).bit_length())
+    size = 1 << bits
+
+    for seed in range(0x811C9DC5, 0x811C9DC5 + 1000000):
+        slots = [-1] * size
+        for index, key in enumerate(keys):
+            slot = fnv1a(seed, key) >> (32 - bits)
+            if slots[slot] != -1:
+                break
+            slots[slot] = index
+        else:
+            break
+    else:
+        sys.exit(f'{args.input}: no perfect hash seed found')
+
+    guard = f'WAVEFORM_EXAMPLE_{args.prefix.upper()}_HASH_H'
+    upper = args.prefix.upper()
+    with open(args.output, 'w') as out:
+        out.write(f'// Generated by {os.path.basename(sys.argv[0])} from {os.path.basename(args.input)}.  Do not edit.\n')
+        out.write(f'#ifndef {guard}\n#define {guard}\n\n#include <stdint.h>\n\n')
+        out.write(f'#define {upper}_HASH_SEED 0x{seed:08X}u\n')
+        out.write(f'#define {upper}_HASH_BITS {bits}\n\n')
+        out.write(f'static const int8_t {args.prefix}_hash_slots[{size}] = {{\n')
+        out.write(''.join(f'    {s}, // {keys[s] if s >= 0 else "-"}\n' for s in slots))
+        out.write('};\n\n')
+        out.write(f'#endif // {guard}\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: LGPL-3.0-or-later
+#
+# Generate the DSP and FEC tables as static const data.
+#
+# Copyright (c) 2026 FlexRadio Systems
+#
+# Every table the data path reads is worked out here at build time rather than when the waveform starts or goes
+# ACTIVE: the test tone at each sample rate, in float and in Q15, the FSK modulator's sine, the Q15 shift's sine, the
+# Hilbert transformer's windowed taps in float and in Q14, the OFDM FFT's twiddles and bit reversal for every size it
+# might plan, and the FEC codecs' CRC, Galois field and Viterbi tables.  The sizes come from the #defines in the
+# headers named on the command line, so the headers stay the one place they are set.  Each value is rounded to float
+# exactly as the C code that used to make it would have, so nothing downstream changes.
+
+import argparse
+import math
+import os
+import re
+import struct
+import sys
+
+
+def read_defines(paths):
+    """The #defines in the headers whose values are plain numbers."""
+    pattern = re.compile(r'^\s*#define\s+(\w+)\s+(-?(?:0[xX][0-9a-fA-F]+|[0-9.]+))[uU]?\s*(?://.*)?$')
+    defines = {}
+    for path in paths:
+        with open(path) as f:
+            for line in f:
+                m = pattern.match(line)
+                if m:
+                    value = m.group(2)
+                    is_float = '.' in value and 'x' not in value.lower()
+                    defines[m.group(1)] = float(value) if is_float else int(value, 0)
+    return defines
+
+
+def f32(x):
+    """x rounded to the nearest float."""
+    return struct.unpack('f', struct.pack('f', x))[0]
+
+
+def literal(x):
+    """A float literal that reads back as exactly f32(x)."""
+    text = f'{f32(x):.9g}'
+    if 'e' not in text and '.' not in text and 'inf' not in text:
+        text += '.0'
+    return text + 'F'
+
+
+def q15(x):
+    """f32(x) in Q15, rounded to nearest even and saturated as lrintf would."""
+    return max(-32768, min(32767, round(f32(x) * 32768.0)))
+
+
+def q14(x):
+    """f32(x) in Q14, which holds from -2 up to just under 2, rounded and saturated as q15."""
+    return max(-32768, min(32767, round(f32(x) * 16384.0)))
+
+
+def rows(values, per_line):
+    """Comma separated values, per_line to a line, indented for an initializer."""
+    return ''.join('    ' + ', '.join(values[i:i + per_line]) + ',\n' for i in range(0, len(values), per_line))
+
+
+def indent(text):
+    """text indented one level more, for the rows of an initializer nested in another."""
+    return ''.join('    ' + line for line in text.splitlines(True))
+
+
+def fec_tables(d, header, source):
+    """Append the FEC codecs' tables, as fec.c used to make them when the waveform started, to header and source."""
+    slices = d['FEC_CRC_SLICES']
+    crc = [[0] * 256 for _ in range(slices)]
+    for i in range(256):
+        c = i
+        for _ in range(8):
+            c = c >> 1 ^ d['FEC_CRC_POLY'] if c & 1 else c >> 1
+        crc[0][i] = c
+    for s in range(1, slices):
+        for i in range(256):
+            c = crc[s - 1][i]
+            crc[s][i] = c >> 8 ^ crc[0][c & 0xff]
+    header.append('\n// The CRC-32C of each byte, and of each byte followed by one to FEC_CRC_SLICES - 1 zero bytes,\n')
+    header.append('// for taking FEC_CRC_SLICES bytes at a time\n')
+    header.append(f'extern const uint32_t tables_crc32c[{slices}][256];\n')
+    source.append(f'const uint32_t tables_crc32c[{slices}][256] = {{\n')
+    for table in crc:
+        source.append('    {\n' + indent(rows([f'0x{c:08X}U' for c in table], 6)))
+        source.append('    },\n')
+    source.append('};\n\n')
+
+    # alpha to the power of each index, twice over so that adding two logarithms never needs reducing, and the
+    # logarithm of each element, with that of zero unused
+    size = d['FEC_GF_SIZE']
+    gf_exp = [0] * (2 * size)
+    gf_log = [0] * size
+    x = 1
+    for i in range(size - 1):
+        gf_exp[i] = gf_exp[i + size - 1] = x
+        gf_log[x] = i
+        x <<= 1
+        if x & size:
+            x ^= d['FEC_GF_POLY']
+
+    def gf_mul(a, b):
+        return gf_exp[gf_log[a] + gf_log[b]] if a and b else 0
+
+    # The Reed-Solomon generator, (x + alpha^1)(x + alpha^2)... multiplied out one root at a time
+    parity = d['FEC_RS_PARITY']
+    generator = [1] + [0] * parity
+    for root in range(1, parity + 1):
+        for j in range(root, 0, -1):
+            generator[j] = generator[j - 1] ^ gf_mul(generator[j], gf_exp[root % (size - 1)])
+        generator[0] = gf_mul(generator[0], gf_exp[root % (size - 1)])
+    root_mul = [[gf_mul(i, gf_exp[(j + 1) % (size - 1)]) for i in range(size)] for j in range(parity)]
+
+    header.append('\n// GF(2^8): alpha to each power, twice over, and the logarithm of each element\n')
+    header.append(f'extern const uint8_t tables_gf_exp[{2 * size}];\n')
+    header.append(f'extern const uint8_t tables_gf_log[{size}];\n')
+    header.append('\n// The Reed-Solomon generator polynomial, whose roots are alpha^1 to alpha^FEC_RS_PARITY,\n')
+    header.append('// lowest power first, and each element times each of those roots\n')
+    header.append(f'extern const uint8_t tables_rs_generator[{parity + 1}];\n')
+    header.append(f'extern const uint8_t tables_rs_root_mul[{parity}][{size}];\n')
+    source.append(f'const uint8_t tables_gf_exp[{2 * size}] = {{\n')
+    source.append(rows([str(v) for v in gf_exp], 16))
+    source.append('};\n\n')
+    source.append(f'const uint8_t tables_gf_log[{size}] = {{\n')
+    source.append(rows([str(v) for v in gf_log], 16))
+    source.append('};\n\n')
+    source.append(f'const uint8_t tables_rs_generator[{parity + 1}] = {{\n')
+    source.append(rows([str(v) for v in generator], 16))
+    source.append('};\n\n')
+    source.append(f'const uint8_t tables_rs_root_mul[{parity}][{size}] = {{\n')
+    for table in root_mul:
+        source.append('    {\n' + indent(rows([str(v) for v in table], 16)))
+        source.append('    },\n')
+    source.append('};\n\n')
+
+    # State i going to 2i takes in a 0, and the register is then i followed by that 0.  0xff marks a 1, so that XORing
+    # a soft bit with it gives how far that soft bit is from what was sent.
+    lanes = d['FEC_VITERBI_LANES']
+    butterflies = 1 << (d['FEC_CONV_K'] - 2)
+    if butterflies % lanes:
+        sys.exit(f'{butterflies} Viterbi butterflies don\'t fill vectors of {lanes}')
+    header.append('\n// For each butterfly i of the Viterbi decoder, the two bits the encoder sends going from\n')
+    header.append('// state i to state 2i, as 0 or 0xff, in vectors of FEC_VITERBI_LANES\n')
+    header.append(f'extern const simd_v8u16 tables_viterbi_expect[2][{butterflies // lanes}];\n')
+    source.append(f'const simd_v8u16 tables_viterbi_expect[2][{butterflies // lanes}] = {{\n')
+    for poly in (d['FEC_CONV_POLY_A'], d['FEC_CONV_POLY_B']):
+        expect = ['0xff' if bin((i << 1) & poly).count('1') & 1 else '0' for i in range(butterflies)]
+        source.append('    {\n')
+        for v in range(0, butterflies, lanes):
+            source.append('        {' + ', '.join(expect[v:v + lanes]) + '},\n')
+        source.append('    },\n')
+    source.append('};\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate the DSP and FEC tables as static const data')
+    parser.add_argument('--header', action='append', required=True, help='Header to read the sizes from')
+    parser.add_argument('--rates', default='', help='Semicolon separated sample rates to make the tone for')
+    parser.add_argument('--output-header', required=True, help='Header file to write')
+    parser.add_argument('--output-source', required=True, help='Source file to write')
+    args = parser.parse_args()
+
+    d = read_defines(args.header)
+    needed = ['JUNK_SAMPLE_RATE_HZ', 'JUNK_TONE_HZ', 'FSK_SINE_BITS', 'HILBERT_PHASE_TAPS', 'OFDM_MAX_FFT',
+              'FIXED_LANES', 'FIXED_TONE_MAX', 'FIXED_SINE_BITS', 'FEC_CRC_POLY', 'FEC_CRC_SLICES', 'FEC_GF_SIZE',
+              'FEC_GF_POLY', 'FEC_RS_PARITY', 'FEC_CONV_K', 'FEC_CONV_POLY_A', 'FEC_CONV_POLY_B', 'FEC_VITERBI_LANES']
+    missing = [name for name in needed if name not in d]
+    if missing:
+        sys.exit(f'{", ".join(missing)} not found in {", ".join(args.header)}')
+
+    # The waveform's own rate always has a tone, whatever else is asked for.
+    rates = sorted({int(r) for r in args.rates.split(';') if r} | {d['JUNK_SAMPLE_RATE_HZ']})
+    tone_hz = d['JUNK_TONE_HZ']
+    fft_bits = int(math.log2(d['OFDM_MAX_FFT']))
+    if 1 << fft_bits != d['OFDM_MAX_FFT']:
+        sys.exit(f'OFDM_MAX_FFT {d["OFDM_MAX_FFT"]} is not a power of two')
+
+    inputs = ', '.join(os.path.basename(p) for p in args.header)
+    banner = f'// Generated by {os.path.basename(sys.argv[0])} from {inputs}.  Do not edit.\n'
+
+    header = [banner, '#ifndef WAVEFORM_EXAMPLE_TABLES_H\n#define WAVEFORM_EXAMPLE_TABLES_H\n\n',
+              '#include <stdint.h>\n\n#include "ofdm.h"\n#include "simd.h"\n\n',
+              '#define TABLES_PASTE2(a, b) a##b\n#define TABLES_PASTE(a, b) TABLES_PASTE2(a, b)\n\n',
+              '// JUNK_TONE_HZ at a sample rate: whole cycles of it, one value a sample, in float and in Q15\n',
+              '// with the first FIXED_LANES values again on the end.  The Q15 table is only there for rates\n',
+              '// whose tone fits in FIXED_TONE_MAX values.\n',
+              '#define TABLES_TONE(rate) TABLES_PASTE(tables_tone_, rate)\n',
+              '#define TABLES_TONE_Q15(rate) TABLES_PASTE(tables_tone_q15_, rate)\n',
+              '#define TABLES_TONE_LEN(rate) TABLES_PASTE(TABLES_TONE_LEN_, rate)\n\n']
+    source = [banner, '#include "tables.h"\n\n']
+
+    for rate in rates:
+        length = rate // math.gcd(rate, tone_hz)
+        tone = [math.sin(2.0 * math.pi * tone_hz * k / rate) for k in range(length)]
+        header.append(f'#define TABLES_TONE_LEN_{rate} {length}\n')
+        header.append(f'extern const float tables_tone_{rate}[TABLES_TONE_LEN_{rate}];\n')
+        source.append(f'const float tables_tone_{rate}[TABLES_TONE_LEN_{rate}] = {{\n')
+        source.append(rows([literal(x) for x in tone], 4))
+        source.append('};\n\n')
+
+        # struct fixed_tone holds its table at the gain, so it can only take a tone of up to FIXED_TONE_MAX values.
+        # The waveform's own rate is the one the Q15 stages run at, so its tone has to fit; any other rate whose tone
+        # doesn't just goes without a Q15 table.
+        if length > d['FIXED_TONE_MAX']:
+            if rate == d['JUNK_SAMPLE_RATE_HZ']:
+                sys.exit(f'A {tone_hz}Hz tone at {rate}Hz takes {length} values, more than {d["FIXED_TONE_MAX"]}')
+            continue
+        header.append(f'extern const int16_t tables_tone_q15_{rate}[TABLES_TONE_LEN_{rate} + {d["FIXED_LANES"]}];\n')
+        source.append(f'const int16_t tables_tone_q15_{rate}[TABLES_TONE_LEN_{rate} + {d["FIXED_LANES"]}] = {{\n')
+        source.append(rows([str(q15(tone[k % length])) for k in range(length + d['FIXED_LANES'])], 12))
+        source.append('};\n\n')
+
+    sine_len = 1 << d['FSK_SINE_BITS']
+    header.append('\n// One cycle of a sine, 1 << FSK_SINE_BITS values\n')
+    header.append(f'extern const float tables_sine[{sine_len}];\n')
+    source.append(f'const float tables_sine[{sine_len}] = {{\n')
+    source.append(rows([literal(math.sin(2.0 * math.pi * i / sine_len)) for i in range(sine_len)], 4))
+    source.append('};\n\n')
+
+    fixed_sine_len = 1 << d['FIXED_SINE_BITS']
+    header.append('\n// One cycle of a sine in Q15, 1 << FIXED_SINE_BITS values\n')
+    header.append(f'extern const int16_t tables_sine_q15[{fixed_sine_len}];\n')
+    source.append(f'const int16_t tables_sine_q15[{fixed_sine_len}] = {{\n')
+    source.append(rows([str(q15(math.sin(2.0 * math.pi * i / fixed_sine_len))) for i in range(fixed_sine_len)], 12))
+    source.append('};\n\n')
+
+    # The ideal Hilbert transformer is 2 / (pi k) at odd offsets k from the center and zero at even ones, tapered with
+    # a Blackman window.  The oldest sample in a half is the delay ahead of the center, the newest the same behind.
+    phase_taps = d['HILBERT_PHASE_TAPS']
+    delay = (2 * phase_taps - 1) // 2
+    taps = []
+    for i in range(phase_taps):
+        k = delay - 2 * i
+        x = math.pi * k / (delay + 1)
+        window = 0.42 + 0.5 * math.cos(x) + 0.08 * math.cos(2.0 * x)
+        taps.append(2.0 / (math.pi * k) * window)
+    header.append('\n// The Hilbert transformer\'s taps that aren\'t zero, oldest sample first\n')
+    header.append(f'extern const float tables_hilbert_taps[{phase_taps}];\n')
+    source.append(f'const float tables_hilbert_taps[{phase_taps}] = {{\n')
+    source.append(rows([literal(x) for x in taps], 4))
+    source.append('};\n\n')
+
+    # The Q15 transformer sums the products of its Q15 samples and these Q14 taps in a single 32 bit int, so that the
+    # compiler can use the multiply-adds that take 16 bit values in and give 32 bit sums out.  At worst every sample
+    # is full scale with the sign of its tap, which mustn't overflow; with Q15 taps it would.
+    taps_q14 = [q14(x) for x in taps]
+    worst = sum(abs(t) for t in taps_q14) * 32768
+    if worst >= 1 << 31:
+        sys.exit(f'The Q15 Hilbert transformer\'s sum can reach {worst}, which overflows 32 bits')
+    header.append('\n// The same in Q14\n')
+    header.append(f'extern const int16_t tables_hilbert_taps_q14[{phase_taps}];\n')
+    source.append(f'const int16_t tables_hilbert_taps_q14[{phase_taps}] = {{\n')
+    source.append(rows([str(t) for t in taps_q14], 12))
+    source.append('};\n\n')
+
+    # Every FFT size up to OFDM_MAX_FFT, since which one a sample rate gets is up to ofdm_acquire.
+    header.append('\n// For each FFT size n = 1 << bits up to OFDM_MAX_FFT: exp(-2 pi i k / n) for every k below n,\n')
+    header.append('// and where each input goes for the butterflies\n')
+    header.append(f'extern const struct ofdm_complex *const tables_twiddle[{fft_bits + 1}];\n')
+    header.append(f'extern const uint16_t *const tables_bitrev[{fft_bits + 1}];\n')
+    for bits in range(fft_bits + 1):
+        n = 1 << bits
+        twiddle = [f'{{{literal(math.cos(2.0 * math.pi * k / n))}, {literal(-math.sin(2.0 * math.pi * k / n))}}}'
+                   for k in range(n)]
+        bitrev = [str(int(f'{k:0{bits}b}'[::-1], 2) if bits else 0) for k in range(n)]
+        source.append(f'static const struct ofdm_complex tables_twiddle_{n}[{n}] = {{\n')
+        source.append(rows(twiddle, 2))
+        source.append('};\n\n')
+        source.append(f'static const uint16_t tables_bitrev_{n}[{n}] = {{\n')
+        source.append(rows(bitrev, 16))
+        source.append('};\n\n')
+    source.append(f'const struct ofdm_complex *const tables_twiddle[{fft_bits + 1}] = {{\n')
+    source.append(rows([f'tables_twiddle_{1 << bits}' for bits in range(fft_bits + 1)], 4))
+    source.append('};\n\n')
+    source.append(f'const uint16_t *const tables_bitrev[{fft_bits + 1}] = {{\n')
+    source.append(rows([f'tables_bitrev_{1 << bits}' for bits in range(fft_bits + 1)], 4))
+    source.append('};\n\n')
+
+    fec_tables(d, header, source)
+
+    header.append('\n#endif // WAVEFORM_EXAMPLE_TABLES_H\n')
+
+    with open(args.output_header, 'w') as out:
+        out.write(''.join(header))
+    with open(args.output_source, 'w') as out:
+        out.write(''.join(source))
+
+
+if __name__ == '__main__':
+    main()